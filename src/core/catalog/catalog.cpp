@@ -0,0 +1,695 @@
+#include "regdb/core/catalog.hpp"
+#include "regdb/core/config.hpp"
+#include "regdb/core/engine/cache.hpp"
+#include "regdb/core/engine/prune.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace regdb {
+
+namespace {
+
+std::vector<float> BlobFloats(const duckdb::Value& value) {
+    const auto& bytes = duckdb::StringValue::Get(value);
+    std::vector<float> values(bytes.size() / sizeof(float));
+    std::memcpy(values.data(), bytes.data(), values.size() * sizeof(float));
+    return values;
+}
+
+std::string QuoteIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (auto c : name) {
+        quoted += c;
+        if (c == '"') {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// 把读取查询的结果转换为 float32 特征行和标签: 有预处理时每个输入列按其变换顺序遍历一次,
+// 否则所有列直接 CAST 为 FLOAT, 前 in_features 列为特征, 最后一列为标签
+class ChunkConverter {
+public:
+    ChunkConverter(std::string table_name, int64_t in_features, const Preprocessor* preprocessor)
+        : table_name_(std::move(table_name)), in_features_(in_features),
+          preprocessor_(preprocessor ? std::make_shared<const Preprocessor>(*preprocessor) : nullptr) {}
+
+    std::string Query(const std::string& filter = "") const {
+        std::string select = "CAST(COLUMNS(*) AS FLOAT)";
+        if (preprocessor_) {
+            select.clear();
+            for (const auto& column : preprocessor_->Columns()) {
+                select += duckdb_fmt::format("CAST({} AS {}), ", QuoteIdentifier(column.name),
+                                             column.Numeric() ? "FLOAT" : "VARCHAR");
+            }
+            select += duckdb_fmt::format("CAST({} AS FLOAT)", QuoteIdentifier(preprocessor_->Label()));
+        }
+        return duckdb_fmt::format("SELECT {} FROM {}{};", select, table_name_, filter.empty() ? "" : " WHERE " + filter);
+    }
+
+    // 缓存 key 的一部分, 包含拟合的统计量
+    std::string Describe() const {
+        return Query() + (preprocessor_ ? preprocessor_->ToJson().dump() : "");
+    }
+
+    void Check(duckdb::QueryResult& result) const {
+        if (!preprocessor_ && static_cast<int64_t>(result.ColumnCount()) != in_features_ + 1) {
+            throw std::runtime_error(duckdb_fmt::format("Table '{}' must have {} feature columns followed by one label column.",
+                                                        table_name_, in_features_));
+        }
+    }
+
+    void Convert(duckdb::DataChunk& chunk, float* features, float* labels) const {
+        chunk.Flatten();
+        const auto rows = static_cast<int64_t>(chunk.size());
+        const auto inputs = static_cast<int64_t>(chunk.ColumnCount()) - 1;
+        CopyLabels(chunk.data[inputs], rows, labels);
+        if (!preprocessor_) {
+            for (int64_t col = 0; col < inputs; ++col) {
+                auto& vector = chunk.data[col];
+                auto& validity = duckdb::FlatVector::Validity(vector);
+                const auto values = duckdb::FlatVector::GetData<float>(vector);
+                for (int64_t row = 0; row < rows; ++row) {
+                    if (!validity.RowIsValid(row)) {
+                        throw std::runtime_error(duckdb_fmt::format("Table '{}' contains NULL values.", table_name_));
+                    }
+                    features[row * in_features_ + col] = values[row];
+                }
+            }
+            return;
+        }
+
+        std::fill(features, features + rows * in_features_, 0.0f);
+        std::vector<uint8_t> valid(rows);
+        std::vector<std::string_view> strings(rows);
+        for (int64_t col = 0; col < inputs; ++col) {
+            auto& vector = chunk.data[col];
+            auto& validity = duckdb::FlatVector::Validity(vector);
+            const uint8_t* mask = nullptr;
+            if (!validity.AllValid()) {
+                for (int64_t row = 0; row < rows; ++row) {
+                    valid[row] = validity.RowIsValid(row);
+                }
+                mask = valid.data();
+            }
+            if (preprocessor_->Columns()[col].Numeric()) {
+                preprocessor_->TransformNumeric(col, duckdb::FlatVector::GetData<float>(vector), mask, rows, features);
+                continue;
+            }
+            const auto values = duckdb::FlatVector::GetData<duckdb::string_t>(vector);
+            for (int64_t row = 0; row < rows; ++row) {
+                strings[row] = std::string_view(values[row].GetData(), values[row].GetSize());
+            }
+            preprocessor_->TransformCategorical(col, strings.data(), mask, rows, features);
+        }
+    }
+
+private:
+    void CopyLabels(duckdb::Vector& vector, int64_t rows, float* labels) const {
+        auto& validity = duckdb::FlatVector::Validity(vector);
+        const auto values = duckdb::FlatVector::GetData<float>(vector);
+        for (int64_t row = 0; row < rows; ++row) {
+            if (!validity.RowIsValid(row)) {
+                throw std::runtime_error(duckdb_fmt::format("Table '{}' contains NULL labels.", table_name_));
+            }
+            labels[row] = values[row];
+        }
+    }
+
+    std::string table_name_;
+    int64_t in_features_;
+    std::shared_ptr<const Preprocessor> preprocessor_;
+};
+
+// 流式读取基本表. 行位置 [0, Rows()) 按 rowid 顺序编号, 删除留下的 rowid 空洞不占位置, 各块行数均匀.
+// 打开时统计每个 ROWID_BUCKET 宽的 rowid 区间的行数, 读取时由位置换算出 rowid 区间, 区间过滤下推到扫描,
+// 每次读取都是一段顺序 I/O, 超出 memory_limit 的部分由 DuckDB 的缓冲区管理换入换出.
+// 全部读取共用一个连接和一个只读事务, 看到同一个快照; 连接不能并发使用, 读取之间互斥
+class TableSource : public BlockSource {
+public:
+    TableSource(const std::string& table_name, int64_t in_features, const Preprocessor* preprocessor)
+        : table_name_(table_name), in_features_(in_features), converter_(table_name, in_features, preprocessor),
+          con_(std::make_unique<duckdb::Connection>(Config::GetLocalConnection())) {
+        con_->BeginTransaction();
+        auto result = con_->Query(duckdb_fmt::format(
+            "SELECT rowid // {} AS bucket, count(*) FROM {} GROUP BY bucket ORDER BY bucket;", ROWID_BUCKET,
+            table_name_));
+        if (result->HasError()) {
+            throw std::runtime_error(duckdb_fmt::format("Table '{}' does not fit in memory and must be a base table to be streamed: {}",
+                                                        table_name_, result->GetError()));
+        }
+        // starts_[i] 为 rowid 区间 [i * ROWID_BUCKET, (i + 1) * ROWID_BUCKET) 之前的行数, 空区间不出现在结果中
+        starts_.push_back(0);
+        for (duckdb::idx_t row = 0; row < result->RowCount(); ++row) {
+            const auto bucket = result->GetValue(0, row).GetValue<int64_t>();
+            const auto count = result->GetValue(1, row).GetValue<int64_t>();
+            starts_.resize(bucket + 1, starts_.back());
+            starts_.push_back(starts_.back() + count);
+        }
+    }
+
+    int64_t Rows() const override { return starts_.back(); }
+    int64_t Cols() const override { return in_features_; }
+
+    int64_t Read(int64_t begin, int64_t count, float* x, float* y) override {
+        count = std::min(count, Rows() - begin);
+        if (count <= 0) {
+            return 0;
+        }
+        // 包含位置 begin 和 begin + count - 1 的 rowid 区间, 跳过 first 区间中 begin 之前的行
+        const auto first = std::upper_bound(starts_.begin(), starts_.end(), begin) - starts_.begin() - 1;
+        const auto last = std::lower_bound(starts_.begin(), starts_.end(), begin + count) - starts_.begin();
+        // 关闭 preserve_insertion_order 时扫描不保证顺序, 按 rowid 排序后 OFFSET 才对应固定的行
+        const auto range = duckdb_fmt::format("rowid >= {} AND rowid < {} ORDER BY rowid LIMIT {} OFFSET {}",
+                                               first * ROWID_BUCKET, last * ROWID_BUCKET, count,
+                                               begin - starts_[first]);
+        std::lock_guard<std::mutex> guard(lock_);
+        auto result = con_->Query(converter_.Query(range));
+        if (result->HasError()) {
+            throw std::runtime_error(result->GetError());
+        }
+        converter_.Check(*result);
+        int64_t rows = 0;
+        while (auto chunk = result->Fetch()) {
+            if (chunk->size() == 0) {
+                break;
+            }
+            const auto size = static_cast<int64_t>(chunk->size());
+            if (rows + size > count) {
+                throw std::runtime_error(duckdb_fmt::format("Table '{}' changed while it was being read.", table_name_));
+            }
+            converter_.Convert(*chunk, x + rows * in_features_, y + rows);
+            rows += size;
+        }
+        return rows;
+    }
+
+private:
+    static constexpr int64_t ROWID_BUCKET = 2048;
+
+    std::string table_name_;
+    int64_t in_features_;
+    ChunkConverter converter_;
+    std::mutex lock_;
+    std::unique_ptr<duckdb::Connection> con_;
+    std::vector<int64_t> starts_;
+};
+
+// 写入一份权重: 权重表一行, 张量表每个张量一行. previous 为空时先删除该 (model, key) 的全部张量再写入,
+// 否则只写与 previous 字节不同的张量
+class WeightsWriter {
+public:
+    explicit WeightsWriter(duckdb::Connection& con)
+        : header_(Prepare(con, duckdb_fmt::format(
+              " INSERT OR REPLACE INTO {}.{} "
+              " (model_name, weights_key, model_type, model_args, reg_args, preprocess, rows, train_loss, "
+              " adam_steps, last_rowid, updated_at) "
+              " VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, CURRENT_TIMESTAMP); ",
+              Config::get_schema_name(), Config::get_weights_table_name()))),
+          clear_(Prepare(con, duckdb_fmt::format(
+              " DELETE FROM {}.{} WHERE model_name = $1 AND weights_key = $2; ",
+              Config::get_schema_name(), Config::get_tensors_table_name()))),
+          clear_derived_(Prepare(con, duckdb_fmt::format(
+              " DELETE FROM {}.{} WHERE model_name = $1 AND weights_key = $2 "
+              " AND kind NOT IN ('param', 'buffer', 'adam_m', 'adam_v'); ",
+              Config::get_schema_name(), Config::get_tensors_table_name()))),
+          tensor_(Prepare(con, duckdb_fmt::format(
+              " INSERT OR REPLACE INTO {}.{} (model_name, weights_key, tensor, kind, data) "
+              " VALUES ($1, $2, $3, $4, $5); ",
+              Config::get_schema_name(), Config::get_tensors_table_name()))) {}
+
+    int64_t Write(const ModelWeights& entry, const ModelWeights* previous) {
+        duckdb::vector<duckdb::Value> header = {
+            duckdb::Value(entry.model_name), duckdb::Value(entry.key), duckdb::Value(entry.spec.model_type),
+            duckdb::Value(entry.spec.ToJson().dump()), duckdb::Value(entry.config.ToJson().dump()),
+            entry.preprocess.is_null() ? duckdb::Value() : duckdb::Value(entry.preprocess.dump()),
+            duckdb::Value::BIGINT(entry.rows), duckdb::Value::DOUBLE(entry.train_loss),
+            duckdb::Value::BIGINT(entry.adam_steps), duckdb::Value::BIGINT(entry.last_rowid)
+        };
+        Execute(*header_, header);
+
+        std::unordered_map<std::string, WeightTensor> stored;
+        if (previous) {
+            for (const auto& tensor : previous->Tensors()) {
+                stored.emplace(tensor.kind + ":" + tensor.name, tensor);
+            }
+        } else {
+            duckdb::vector<duckdb::Value> key = {duckdb::Value(entry.model_name), duckdb::Value(entry.key)};
+            Execute(*clear_, key);
+        }
+        int64_t written = 0;
+        bool params_changed = false;
+        for (const auto& tensor : entry.Tensors()) {
+            const auto found = stored.find(tensor.kind + ":" + tensor.name);
+            if (found != stored.end() && found->second.size == tensor.size &&
+                std::memcmp(found->second.data, tensor.data, tensor.size * sizeof(float)) == 0) {
+                continue;
+            }
+            WriteTensor(entry, tensor.name, tensor.kind, tensor.data, tensor.size * sizeof(float));
+            params_changed = params_changed || tensor.kind == "param" || tensor.kind == "buffer";
+            ++written;
+        }
+
+        // 量化和块稀疏张量由参数派生: 参数变化而派生张量原样沿用 previous 时已经过期, 删除且不再写入;
+        // 调用方重新生成了派生张量 (如剪枝) 或参数未变而派生张量不同时整体替换
+        const bool same = previous && SameDerived(entry.quantized, previous->quantized) &&
+                          SameDerived(entry.sparse, previous->sparse);
+        const bool stale = params_changed && same;
+        if (previous && !params_changed && same) {
+            return written;
+        }
+        if (previous) {
+            duckdb::vector<duckdb::Value> key = {duckdb::Value(entry.model_name), duckdb::Value(entry.key)};
+            Execute(*clear_derived_, key);
+        }
+        if (!stale) {
+            for (const auto* derived : {&entry.quantized, &entry.sparse}) {
+                for (const auto& tensor : *derived) {
+                    WriteTensor(entry, tensor.name, tensor.kind, tensor.data.data(), tensor.data.size());
+                    ++written;
+                }
+            }
+        }
+        return written;
+    }
+
+private:
+    void WriteTensor(const ModelWeights& entry, const std::string& name, const std::string& kind, const void* data,
+                     size_t bytes) {
+        duckdb::vector<duckdb::Value> values = {
+            duckdb::Value(entry.model_name), duckdb::Value(entry.key), duckdb::Value(name), duckdb::Value(kind),
+            duckdb::Value::BLOB(reinterpret_cast<duckdb::const_data_ptr_t>(data), bytes)
+        };
+        Execute(*tensor_, values);
+    }
+
+    static bool SameDerived(const std::vector<QuantizedTensor>& tensors, const std::vector<QuantizedTensor>& previous) {
+        if (tensors.size() != previous.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            const auto& a = tensors[i];
+            const auto& b = previous[i];
+            if (a.name != b.name || a.kind != b.kind || a.data != b.data) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static duckdb::unique_ptr<duckdb::PreparedStatement> Prepare(duckdb::Connection& con, const std::string& query) {
+        auto statement = con.Prepare(query);
+        if (statement->HasError()) {
+            throw std::runtime_error(statement->GetError());
+        }
+        return statement;
+    }
+
+    static void Execute(duckdb::PreparedStatement& statement, duckdb::vector<duckdb::Value>& values) {
+        auto result = statement.Execute(values, false);
+        if (result->HasError()) {
+            throw std::runtime_error(result->GetError());
+        }
+    }
+
+    duckdb::unique_ptr<duckdb::PreparedStatement> header_;
+    duckdb::unique_ptr<duckdb::PreparedStatement> clear_;
+    duckdb::unique_ptr<duckdb::PreparedStatement> clear_derived_;
+    duckdb::unique_ptr<duckdb::PreparedStatement> tensor_;
+};
+
+} // namespace
+
+// 读取模型结构
+ModelSpec Catalog::GetModelSpec(const std::string& model_name) {
+    auto con = Config::GetLocalConnection();
+    auto result = con.Query(duckdb_fmt::format(" SELECT model_type, model_args::VARCHAR, 'local' AS scope "
+                                               " FROM regdb_config.REGDB_MODEL_ARCH_TABLE "
+                                               " WHERE model_name = '{}' "
+                                               " UNION ALL "
+                                               " SELECT model_type, model_args::VARCHAR, 'global' AS scope "
+                                               " FROM regdb_storage.regdb_config.REGDB_MODEL_ARCH_TABLE "
+                                               " WHERE model_name = '{}' "
+                                               " ORDER BY scope DESC;",
+                                               model_name, model_name));
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    if (result->RowCount() == 0) {
+        throw std::runtime_error(duckdb_fmt::format("Model '{}' does not exist.", model_name));
+    }
+    auto model_type = result->GetValue(0, 0).ToString();
+    auto model_args = nlohmann::json::parse(result->GetValue(1, 0).ToString());
+    return ModelSpec::FromJson(model_type, model_args);
+}
+
+// 读取正则化空间参数
+nlohmann::json Catalog::GetRegArgs(const std::string& reg_space) {
+    auto con = Config::GetLocalConnection();
+    auto result = con.Query(duckdb_fmt::format(" SELECT reg_args::VARCHAR, 'local' AS scope "
+                                               " FROM regdb_config.REGDB_REG_SPACE_TABLE "
+                                               " WHERE reg_space = '{}' "
+                                               " UNION ALL "
+                                               " SELECT reg_args::VARCHAR, 'global' AS scope "
+                                               " FROM regdb_storage.regdb_config.REGDB_REG_SPACE_TABLE "
+                                               " WHERE reg_space = '{}' "
+                                               " ORDER BY scope DESC;",
+                                               reg_space, reg_space));
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    if (result->RowCount() == 0) {
+        throw std::runtime_error(duckdb_fmt::format("RegSpace '{}' does not exist.", reg_space));
+    }
+    return nlohmann::json::parse(result->GetValue(0, 0).ToString());
+}
+
+// 读取训练数据
+Dataset Catalog::LoadDataset(const std::string& table_name, int64_t in_features, const Preprocessor* preprocessor,
+                             MemoryCategory category) {
+    const ChunkConverter converter(table_name, in_features, preprocessor);
+    auto con = Config::GetLocalConnection();
+    auto result = con.Query(converter.Query());
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    converter.Check(*result);
+
+    Dataset data;
+    data.cols = in_features;
+    data.features = Buffer<float>(category);
+    data.labels = Buffer<float>(category);
+    data.features.reserve(result->RowCount() * in_features);
+    data.labels.reserve(result->RowCount());
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        const auto rows = static_cast<int64_t>(chunk->size());
+        const auto offset = data.rows;
+        data.rows += rows;
+        data.features.resize(data.rows * in_features);
+        data.labels.resize(data.rows);
+        converter.Convert(*chunk, data.features.data() + offset * in_features, data.labels.data() + offset);
+    }
+    return data;
+}
+
+// 经缓存读取训练数据, 缓存 key 包含数据库实例、特征列数、读取查询和预处理
+std::shared_ptr<const Dataset> Catalog::GetDataset(const std::string& table_name, int64_t in_features,
+                                                   const Preprocessor* preprocessor) {
+    const ChunkConverter converter(table_name, in_features, preprocessor);
+    const auto source = duckdb_fmt::format("{}|{}|{}", static_cast<const void*>(Config::local_db), in_features,
+                                           converter.Describe());
+    const auto key = static_cast<uint64_t>(std::hash<std::string>()(source));
+    return DatasetCache::Instance().Get(key, TableVersion(table_name), [&]() {
+        return LoadDataset(table_name, in_features, preprocessor, MemoryCategory::CACHE);
+    });
+}
+
+// 拟合预处理: 数值统计量和类别数在一次聚合中计算, one-hot 类别表在第二次聚合中收集, 都由 DuckDB 并行执行
+Preprocessor Catalog::FitPreprocessor(const std::string& table_name, const ModelSpec& spec) {
+    auto con = Config::GetLocalConnection();
+    auto schema = con.Query(duckdb_fmt::format("SELECT * FROM {} LIMIT 0;", table_name));
+    if (schema->HasError()) {
+        throw std::runtime_error(schema->GetError());
+    }
+    if (schema->ColumnCount() < 2) {
+        throw std::runtime_error(duckdb_fmt::format("Table '{}' needs feature columns followed by one label column.",
+                                                    table_name));
+    }
+    const auto inputs = static_cast<int64_t>(schema->ColumnCount()) - 1;
+    std::vector<ColumnTransform> columns(inputs);
+    std::vector<bool> automatic(inputs, false);
+    std::vector<std::string> aggregates;
+    for (int64_t col = 0; col < inputs; ++col) {
+        auto& column = columns[col];
+        column.name = schema->names[col];
+        const auto& type = schema->types[col];
+        const auto numeric = type.IsNumeric() || type.id() == duckdb::LogicalTypeId::BOOLEAN;
+        const auto requested = spec.preprocess.value(column.name, std::string());
+        if (requested.empty()) {
+            column.transform = numeric ? FeatureTransform::ZSCORE : FeatureTransform::ONEHOT;
+            automatic[col] = !numeric;
+        } else {
+            column.transform = FeatureTransformFromString(requested);
+            if (column.Numeric() && !numeric) {
+                throw std::runtime_error(duckdb_fmt::format("Column '{}' is not numeric and cannot use {}.",
+                                                            column.name, requested));
+            }
+        }
+        const auto quoted = QuoteIdentifier(column.name);
+        if (column.transform == FeatureTransform::ZSCORE) {
+            aggregates.push_back(duckdb_fmt::format("avg(CAST({0} AS DOUBLE)), stddev_pop(CAST({0} AS DOUBLE))", quoted));
+        } else if (column.transform == FeatureTransform::MINMAX) {
+            aggregates.push_back(duckdb_fmt::format("min(CAST({0} AS DOUBLE)), max(CAST({0} AS DOUBLE))", quoted));
+        } else if (automatic[col]) {
+            aggregates.push_back(duckdb_fmt::format("approx_count_distinct({})", quoted));
+        }
+    }
+
+    auto join = [](const std::vector<std::string>& items) {
+        std::string joined;
+        for (const auto& item : items) {
+            joined += (joined.empty() ? "" : ", ") + item;
+        }
+        return joined;
+    };
+    if (!aggregates.empty()) {
+        auto stats = con.Query(duckdb_fmt::format("SELECT {} FROM {};", join(aggregates), table_name));
+        if (stats->HasError()) {
+            throw std::runtime_error(stats->GetError());
+        }
+        duckdb::idx_t index = 0;
+        auto next = [&]() { return stats->GetValue(index++, 0); };
+        for (int64_t col = 0; col < inputs; ++col) {
+            auto& column = columns[col];
+            if (column.Numeric()) {
+                const auto first = next();
+                const auto second = next();
+                // 空表或常数列保持原值
+                if (first.IsNull() || second.IsNull()) {
+                    continue;
+                }
+                const auto a = first.GetValue<double>();
+                const auto b = second.GetValue<double>();
+                const auto range = column.transform == FeatureTransform::ZSCORE ? b : b - a;
+                column.shift = static_cast<float>(a);
+                column.scale = range > 0.0 ? static_cast<float>(1.0 / range) : 1.0f;
+            } else if (automatic[col] && next().GetValue<int64_t>() > Preprocessor::ONEHOT_LIMIT) {
+                column.transform = FeatureTransform::HASH;
+            }
+        }
+    }
+
+    std::vector<std::string> lists;
+    for (const auto& column : columns) {
+        if (column.transform == FeatureTransform::ONEHOT) {
+            const auto quoted = QuoteIdentifier(column.name);
+            lists.push_back(duckdb_fmt::format("list_sort(list(DISTINCT CAST({0} AS VARCHAR)) FILTER (WHERE {0} IS NOT NULL))",
+                                               quoted));
+        }
+    }
+    if (!lists.empty()) {
+        auto categories = con.Query(duckdb_fmt::format("SELECT {} FROM {};", join(lists), table_name));
+        if (categories->HasError()) {
+            throw std::runtime_error(categories->GetError());
+        }
+        duckdb::idx_t index = 0;
+        for (auto& column : columns) {
+            if (column.transform != FeatureTransform::ONEHOT) {
+                continue;
+            }
+            const auto value = categories->GetValue(index++, 0);
+            if (value.IsNull()) {
+                continue;
+            }
+            for (const auto& child : duckdb::ListValue::GetChildren(value)) {
+                column.categories.push_back(child.ToString());
+            }
+        }
+    }
+    return Preprocessor(std::move(columns), schema->names.back(), spec.in_features);
+}
+
+// 追加和删除会改变行数或最大 rowid; 视图没有 rowid, 只比较行数
+std::string Catalog::TableVersion(const std::string& table_name) {
+    auto con = Config::GetLocalConnection();
+    auto result = con.Query(duckdb_fmt::format("SELECT count(*), max(rowid) FROM {};", table_name));
+    if (result->HasError()) {
+        return std::to_string(CountRows(table_name));
+    }
+    return duckdb_fmt::format("{}:{}", result->GetValue(0, 0).ToString(), result->GetValue(1, 0).ToString());
+}
+
+// 表的行数
+int64_t Catalog::CountRows(const std::string& table_name) {
+    auto con = Config::GetLocalConnection();
+    auto result = con.Query(duckdb_fmt::format("SELECT count(*) FROM {};", table_name));
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    return result->GetValue(0, 0).GetValue<int64_t>();
+}
+
+// 流式读取训练数据, 行位置按 rowid 顺序连续编号
+std::unique_ptr<BlockSource> Catalog::OpenTable(const std::string& table_name, int64_t in_features,
+                                                const Preprocessor* preprocessor) {
+    return std::make_unique<TableSource>(table_name, in_features, preprocessor);
+}
+
+// 使用独立连接和一个事务; train_mlp 暂存的权重在查询所在事务提交时经这里写入
+void Catalog::SaveWeights(const std::vector<ModelWeights>& weights) {
+    if (weights.empty()) {
+        return;
+    }
+    auto con = Config::GetLocalConnection();
+    con.BeginTransaction();
+    try {
+        WeightsWriter writer(con);
+        for (const auto& entry : weights) {
+            writer.Write(entry, nullptr);
+        }
+    } catch (...) {
+        con.Rollback();
+        throw;
+    }
+    con.Commit();
+}
+
+// 与 previous 逐个张量比较字节, 只写回变化的张量, 返回写入的张量数
+int64_t Catalog::UpdateWeights(const ModelWeights& weights, const ModelWeights& previous) {
+    auto con = Config::GetLocalConnection();
+    con.BeginTransaction();
+    int64_t written = 0;
+    try {
+        WeightsWriter writer(con);
+        written = writer.Write(weights, &previous);
+    } catch (...) {
+        con.Rollback();
+        throw;
+    }
+    con.Commit();
+    return written;
+}
+
+bool Catalog::FindWeights(const std::string& model_name, const std::string& key, ModelWeights& weights) {
+    auto con = Config::GetLocalConnection();
+    auto header = con.Prepare(duckdb_fmt::format(
+        " SELECT model_type, model_args::VARCHAR, reg_args::VARCHAR, preprocess::VARCHAR, rows, train_loss, "
+        " adam_steps, last_rowid "
+        " FROM {}.{} WHERE model_name = $1 AND weights_key = $2; ",
+        Config::get_schema_name(), Config::get_weights_table_name()));
+    if (header->HasError()) {
+        throw std::runtime_error(header->GetError());
+    }
+    duckdb::vector<duckdb::Value> values = {duckdb::Value(model_name), duckdb::Value(key)};
+    auto result = header->Execute(values, false);
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    auto& rows = result->Cast<duckdb::MaterializedQueryResult>();
+    if (rows.RowCount() == 0) {
+        return false;
+    }
+    weights = ModelWeights();
+    weights.model_name = model_name;
+    weights.key = key;
+    weights.spec = ModelSpec::FromJson(rows.GetValue(0, 0).ToString(), nlohmann::json::parse(rows.GetValue(1, 0).ToString()));
+    weights.config = RegConfig::FromJson(nlohmann::json::parse(rows.GetValue(2, 0).ToString()));
+    if (!rows.GetValue(3, 0).IsNull()) {
+        weights.preprocess = nlohmann::json::parse(rows.GetValue(3, 0).ToString());
+    }
+    weights.rows = rows.GetValue(4, 0).GetValue<int64_t>();
+    weights.train_loss = rows.GetValue(5, 0).IsNull() ? 0.0 : rows.GetValue(5, 0).GetValue<double>();
+    weights.adam_steps = rows.GetValue(6, 0).GetValue<int64_t>();
+    weights.last_rowid = rows.GetValue(7, 0).GetValue<int64_t>();
+
+    auto tensors = con.Prepare(duckdb_fmt::format(
+        " SELECT tensor, kind, data FROM {}.{} WHERE model_name = $1 AND weights_key = $2; ",
+        Config::get_schema_name(), Config::get_tensors_table_name()));
+    if (tensors->HasError()) {
+        throw std::runtime_error(tensors->GetError());
+    }
+    auto data = tensors->Execute(values, false);
+    if (data->HasError()) {
+        throw std::runtime_error(data->GetError());
+    }
+    auto& tensor_rows = data->Cast<duckdb::MaterializedQueryResult>();
+    bool with_optimizer = false;
+    for (duckdb::idx_t row = 0; row < tensor_rows.RowCount(); ++row) {
+        with_optimizer = with_optimizer || tensor_rows.GetValue(1, row).ToString() == "adam_m";
+    }
+    weights.Allocate(with_optimizer);
+    for (duckdb::idx_t row = 0; row < tensor_rows.RowCount(); ++row) {
+        const auto name = tensor_rows.GetValue(0, row).ToString();
+        const auto kind = tensor_rows.GetValue(1, row).ToString();
+        if (IsQuantizedKind(kind) || IsSparseKind(kind)) {
+            const auto& bytes = duckdb::StringValue::Get(tensor_rows.GetValue(2, row));
+            auto& derived = IsSparseKind(kind) ? weights.sparse : weights.quantized;
+            derived.push_back({name, kind, std::vector<uint8_t>(bytes.begin(), bytes.end())});
+            continue;
+        }
+        const auto floats = BlobFloats(tensor_rows.GetValue(2, row));
+        weights.LoadTensor(name, kind, floats.data(), static_cast<int64_t>(floats.size()));
+    }
+    return true;
+}
+
+ModelWeights Catalog::GetWeights(const std::string& model_name, const std::string& key) {
+    ModelWeights weights;
+    if (!FindWeights(model_name, key, weights)) {
+        throw std::runtime_error(key.empty()
+                                 ? duckdb_fmt::format("Model '{}' has no trained weights.", model_name)
+                                 : duckdb_fmt::format("Model '{}' has no trained weights for key '{}'.", model_name, key));
+    }
+    return weights;
+}
+
+// 最大 rowid, 空表为 -1; 视图没有 rowid
+int64_t Catalog::MaxRowid(const std::string& table_name) {
+    auto con = Config::GetLocalConnection();
+    auto result = con.Query(duckdb_fmt::format("SELECT coalesce(max(rowid), -1) FROM {};", table_name));
+    if (result->HasError()) {
+        throw std::runtime_error(duckdb_fmt::format("Table '{}' must be a base table: {}", table_name, result->GetError()));
+    }
+    return result->GetValue(0, 0).GetValue<int64_t>();
+}
+
+// 按 filter 流式读取, 每个 chunk 转换后回调一次, 内存只占一个 chunk, 返回读取的行数
+int64_t Catalog::ScanRows(const std::string& table_name, int64_t in_features, const Preprocessor* preprocessor,
+                          const std::string& filter,
+                          const std::function<void(const float* x, const float* y, int64_t rows)>& consume) {
+    const ChunkConverter converter(table_name, in_features, preprocessor);
+    auto con = Config::GetLocalConnection();
+    auto result = con.SendQuery(converter.Query(filter));
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    converter.Check(*result);
+    std::vector<float> x;
+    std::vector<float> y;
+    int64_t total = 0;
+    while (auto chunk = result->Fetch()) {
+        if (chunk->size() == 0) {
+            break;
+        }
+        const auto rows = static_cast<int64_t>(chunk->size());
+        x.resize(rows * in_features);
+        y.resize(rows);
+        converter.Convert(*chunk, x.data(), y.data());
+        consume(x.data(), y.data(), rows);
+        total += rows;
+    }
+    return total;
+}
+
+} // namespace regdb
@@ -1,5 +1,11 @@
 #include "regdb/core/config.hpp"
 #include "filesystem.hpp"
+#include "regdb/core/engine/parallel.hpp"
+#include "regdb/core/memory.hpp"
+#include "duckdb/parallel/task.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include <functional>
+#include <mutex>
 #include <fmt/format.h>
 
 namespace regdb {
@@ -25,6 +31,10 @@ std::filesystem::path Config::get_global_storage_path() {
     return std::filesystem::path(homeDir) / ".duckdb" / "regdb_storage" / "regdb.db";
 }
 
+std::filesystem::path Config::get_checkpoint_path() {
+    return get_global_storage_path().parent_path() / "checkpoints";
+}
+
 // 获取连接
 duckdb::Connection Config::GetLocalConnection(duckdb::DatabaseInstance* db) {
     if (db) {
@@ -88,9 +98,57 @@ void Config::ConfigureTables(duckdb::Connection& con, const ConfigType type) {
     ConfigSchema(con, schema);
     ConfigModelArchTable(con, schema, type);
     ConfigRegSpaceTable(con, schema, type);
+    ConfigWeightsTable(con, schema);
     con.Commit();
 }
 
+namespace {
+
+// regdb 线程池的一个线程, 作为任务占住 DuckDB 的一个 worker, 池让它退出时任务结束, worker 回到调度器
+class PoolThreadTask : public duckdb::Task {
+public:
+    explicit PoolThreadTask(std::function<void()> loop) : loop_(std::move(loop)) {}
+
+    duckdb::TaskExecutionResult Execute(duckdb::TaskExecutionMode) override {
+        loop_();
+        return duckdb::TaskExecutionResult::TASK_FINISHED;
+    }
+
+private:
+    std::function<void()> loop_;
+};
+
+} // namespace
+
+// 搜索和训练的线程池上限跟随每次执行时的 SET threads. 池的线程作为任务运行在当前实例的 TaskScheduler 上,
+// 与其他查询共用 DuckDB 的 worker, 执行查询的线程加上借到的 worker 不超过 threads
+int64_t Config::ConfigureThreads(duckdb::ClientContext& context) {
+    auto& scheduler = duckdb::TaskScheduler::GetScheduler(context);
+    const auto threads = static_cast<int64_t>(scheduler.NumberOfThreads());
+    auto& pool = ThreadPool::Instance();
+    pool.Resize(threads);
+    // 池是进程级的, 接到最近一次使用它的实例; 实例关闭后不再启动新线程, 借不到线程时退回单线程
+    static std::mutex attach_lock;
+    static duckdb::weak_ptr<duckdb::DatabaseInstance> attached;
+    auto& db = duckdb::DatabaseInstance::GetDatabase(context);
+    std::lock_guard<std::mutex> guard(attach_lock);
+    if (attached.lock().get() != &db) {
+        attached = db.shared_from_this();
+        pool.Attach([instance = attached](std::function<void()> loop) {
+            auto db = instance.lock();
+            if (!db) {
+                return false;
+            }
+            // 令牌销毁后已入队的任务仍会被执行
+            auto& scheduler = duckdb::TaskScheduler::GetScheduler(*db);
+            auto producer = scheduler.CreateProducer();
+            scheduler.ScheduleTask(*producer, duckdb::make_shared_ptr<PoolThreadTask>(std::move(loop)));
+            return true;
+        });
+    }
+    return threads;
+}
+
 std::string Config::get_modelarch_table_name() {
     return "REGDB_MODEL_ARCH_TABLE";
 }
@@ -99,6 +157,14 @@ std::string Config::get_regspace_table_name() {
     return "REGDB_REG_SPACE_TABLE";
 }
 
+std::string Config::get_weights_table_name() {
+    return "REGDB_MODEL_WEIGHTS_TABLE";
+}
+
+std::string Config::get_tensors_table_name() {
+    return "REGDB_MODEL_TENSORS_TABLE";
+}
+
 void Config::ConfigModelArchTable(duckdb::Connection& con, std::string& schema_name, const ConfigType type) {
     const std::string table_name = Config::get_modelarch_table_name();
     // 查询表是否存在
@@ -157,11 +223,63 @@ void Config::ConfigRegSpaceTable(duckdb::Connection& con, std::string& schema_na
     }
 }
 
+// 训练得到的权重, 同一模型按 weights_key 区分多份 (例如 GROUP BY 每个分组一份).
+// 权重表每份一行, 记录结构和训练进度; 张量按参数名和种类 (param/buffer/adam_m/adam_v) 每个一行存在张量表中,
+// 以 float32 原始字节存储, PARTIAL FIT 只写回变化的张量
+void Config::ConfigWeightsTable(duckdb::Connection& con, std::string& schema_name) {
+    const std::string table_name = Config::get_weights_table_name();
+    auto result = con.Query(duckdb_fmt::format(" SELECT table_name "
+                                               " FROM information_schema.tables "
+                                               " WHERE table_schema = '{}' "
+                                               " AND table_name = '{}'; ",
+                                               schema_name, table_name));
+    if (result->RowCount() == 0) {
+        con.Query(duckdb_fmt::format(" INSTALL JSON; "
+                                     " LOAD JSON; "
+                                     " CREATE TABLE {}.{} ( "
+                                     " model_name VARCHAR NOT NULL, "
+                                     " weights_key VARCHAR NOT NULL, "
+                                     " model_type VARCHAR NOT NULL, "
+                                     " model_args JSON NOT NULL, "
+                                     " reg_args JSON NOT NULL, "
+                                     " preprocess JSON, "
+                                     " rows BIGINT NOT NULL, "
+                                     " train_loss DOUBLE, "
+                                     " adam_steps BIGINT NOT NULL DEFAULT 0, "
+                                     " last_rowid BIGINT NOT NULL DEFAULT -1, "
+                                     " updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                                     " PRIMARY KEY (model_name, weights_key) "
+                                     " ); ",
+                                     schema_name, table_name));
+    }
+
+    const std::string tensors_name = Config::get_tensors_table_name();
+    result = con.Query(duckdb_fmt::format(" SELECT table_name "
+                                          " FROM information_schema.tables "
+                                          " WHERE table_schema = '{}' "
+                                          " AND table_name = '{}'; ",
+                                          schema_name, tensors_name));
+    if (result->RowCount() == 0) {
+        con.Query(duckdb_fmt::format(" CREATE TABLE {}.{} ( "
+                                     " model_name VARCHAR NOT NULL, "
+                                     " weights_key VARCHAR NOT NULL, "
+                                     " tensor VARCHAR NOT NULL, "
+                                     " kind VARCHAR NOT NULL, "
+                                     " data BLOB NOT NULL, "
+                                     " PRIMARY KEY (model_name, weights_key, tensor, kind) "
+                                     " ); ",
+                                     schema_name, tensors_name));
+    }
+}
+
 // 注册 db
 void Config::Configure(duckdb::ExtensionLoader& loader) {
     Registry::Register(loader);
     auto& db = loader.GetDatabaseInstance();
+    ThreadPool::Instance().Resize(static_cast<int64_t>(duckdb::TaskScheduler::GetScheduler(db).NumberOfThreads()));
     if (const auto db_path = db.config.options.database_path; db_path != get_global_storage_path().string()) {
+        // 引擎内存计入用户实例的 memory_limit
+        BufferManagerMemory::Install(db);
         SetupGlobalStorageLocation();
         ConfigureGlobal();
         ConfigureLocal(db);
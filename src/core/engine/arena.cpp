@@ -0,0 +1,115 @@
+#include "regdb/core/engine/arena.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace regdb {
+
+Arena::Arena(int64_t bytes, MemoryCategory category) : capacity_(bytes) {
+    // 多分配一个对齐单位用于对齐起始地址
+    block_ = Memory::Allocate(category, bytes + ALIGNMENT);
+    Pin();
+}
+
+void Arena::Unpin() {
+    block_->Unpin();
+    base_ = nullptr;
+}
+
+void Arena::Pin() {
+    block_->Pin();
+    auto* data = block_->Data();
+    const auto address = reinterpret_cast<uintptr_t>(data);
+    base_ = data + ((ALIGNMENT - address % ALIGNMENT) % ALIGNMENT);
+}
+
+void Arena::SetCategory(MemoryCategory category) {
+    block_->SetCategory(category);
+}
+
+uint8_t* Arena::Take(int64_t bytes) {
+    if (Measuring()) {
+        used_ += bytes;
+        return nullptr;
+    }
+    if (used_ + bytes > capacity_) {
+        throw std::runtime_error("Arena capacity exceeded.");
+    }
+    auto* data = base_ + used_;
+    used_ += bytes;
+    return data;
+}
+
+ArenaPool::Handle::Handle(Handle&& other) noexcept : pool_(other.pool_), arena_(std::move(other.arena_)) {}
+
+ArenaPool::Handle& ArenaPool::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        if (arena_) {
+            pool_->Release(std::move(arena_));
+        }
+        pool_ = other.pool_;
+        arena_ = std::move(other.arena_);
+    }
+    return *this;
+}
+
+ArenaPool::Handle::~Handle() {
+    if (arena_) {
+        pool_->Release(std::move(arena_));
+    }
+}
+
+ArenaPool& ArenaPool::Instance() {
+    static ArenaPool pool;
+    return pool;
+}
+
+ArenaPool::Handle ArenaPool::Acquire(int64_t bytes, MemoryCategory category) {
+    std::unique_ptr<Arena> reused;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto best = idle_.end();
+        for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+            if ((*it)->Capacity() >= bytes && (best == idle_.end() || (*it)->Capacity() < (*best)->Capacity())) {
+                best = it;
+            }
+        }
+        if (best != idle_.end()) {
+            reused = std::move(*best);
+            idle_.erase(best);
+        }
+    }
+    if (reused) {
+        // Pin 可能需要从临时文件读回, 不在锁内进行
+        reused->Pin();
+        reused->SetCategory(category);
+        reused->Reset();
+        return Handle(this, std::move(reused));
+    }
+    return Handle(this, std::make_unique<Arena>(bytes, category));
+}
+
+void ArenaPool::Release(std::unique_ptr<Arena> arena) {
+    arena->SetCategory(MemoryCategory::POOL);
+    arena->Unpin();
+    std::lock_guard<std::mutex> guard(lock_);
+    if (idle_.size() < MAX_IDLE) {
+        idle_.push_back(std::move(arena));
+    }
+}
+
+void ArenaPool::Clear() {
+    std::lock_guard<std::mutex> guard(lock_);
+    idle_.clear();
+}
+
+int64_t ArenaPool::IdleBytes() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    int64_t bytes = 0;
+    for (const auto& arena : idle_) {
+        bytes += arena->Capacity();
+    }
+    return bytes;
+}
+
+} // namespace regdb
@@ -0,0 +1,251 @@
+#include "regdb/core/engine/augment.hpp"
+#include "regdb/core/engine/random.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace regdb {
+
+namespace {
+
+// 正在生产, 消费端和预取线程都不能使用
+constexpr int64_t SLOT_LOADING = -2;
+constexpr float TWO_PI = 6.28318530717958647692f;
+
+// a' = lambda * a + (1 - lambda) * b, b' = lambda * b + (1 - lambda) * a
+void MixRows(int64_t cols, float lambda, float* __restrict a, float* __restrict b) {
+    const float mu = 1.0f - lambda;
+    for (int64_t j = 0; j < cols; ++j) {
+        const float av = a[j];
+        const float bv = b[j];
+        a[j] = lambda * av + mu * bv;
+        b[j] = lambda * bv + mu * av;
+    }
+}
+
+} // namespace
+
+Augmenter::Augmenter(const RegConfig& config, bool regression)
+    : enabled_(config.use_data_augment), op_(config.augment), strength_(config.augment_strength),
+      regression_(regression) {
+}
+
+uint32_t Augmenter::Seed(uint64_t seed, int64_t epoch, int64_t index) {
+    uint32_t out[Philox::BLOCK];
+    Philox::Block(seed, (static_cast<uint64_t>(epoch) << 32) + static_cast<uint64_t>(index), out);
+    return out[0];
+}
+
+void Augmenter::Apply(int64_t rows, int64_t cols, float* x, float* y, std::mt19937& rng) const {
+    if (!enabled_ || rows <= 0) {
+        return;
+    }
+    const auto key = (static_cast<uint64_t>(rng()) << 32) | rng();
+    switch (op_) {
+    case AugmentOp::MIXUP:
+        Mixup(rows, cols, x, y, rng);
+        break;
+    case AugmentOp::CUTMIX:
+        Cutmix(rows, cols, x, y, key);
+        break;
+    case AugmentOp::NOISE:
+        Noise(rows, cols, x, key);
+        break;
+    }
+}
+
+void Augmenter::Mixup(int64_t rows, int64_t cols, float* x, float* y, std::mt19937& rng) const {
+    // Beta(a, a) 由两个 Gamma(a) 之比得到, 每对一个系数
+    std::gamma_distribution<float> gamma(strength_, 1.0f);
+    for (int64_t i = 0; i < rows / 2; ++i) {
+        const auto partner = rows - 1 - i;
+        const float g1 = gamma(rng);
+        const float g2 = gamma(rng);
+        float lambda = g1 + g2 > 0.0f ? g1 / (g1 + g2) : 1.0f;
+        lambda = std::max(lambda, 1.0f - lambda);
+        MixRows(cols, lambda, x + i * cols, x + partner * cols);
+        if (regression_) {
+            const float a = y[i];
+            const float b = y[partner];
+            y[i] = lambda * a + (1.0f - lambda) * b;
+            y[partner] = lambda * b + (1.0f - lambda) * a;
+        }
+    }
+}
+
+void Augmenter::Cutmix(int64_t rows, int64_t cols, float* x, float* y, uint64_t key) const {
+    // 交换概率不超过一半, 保证自身的特征占多数
+    const float rate = std::min(strength_, 0.5f);
+    const auto threshold = static_cast<uint32_t>(static_cast<double>(rate) * 4294967295.0);
+    const auto row_counters = Philox::Counters(cols);
+    uint32_t random[Philox::BLOCK];
+    for (int64_t i = 0; i < rows / 2; ++i) {
+        const auto partner = rows - 1 - i;
+        float* __restrict a = x + i * cols;
+        float* __restrict b = x + partner * cols;
+        int64_t swapped = 0;
+        for (int64_t j0 = 0; j0 < cols; j0 += Philox::BLOCK) {
+            Philox::Block(key, static_cast<uint64_t>(i * row_counters + j0 / 4), random);
+            const auto n = std::min(Philox::BLOCK, cols - j0);
+            for (int64_t j = 0; j < n; ++j) {
+                const bool swap = random[j] < threshold;
+                const float av = a[j0 + j];
+                const float bv = b[j0 + j];
+                a[j0 + j] = swap ? bv : av;
+                b[j0 + j] = swap ? av : bv;
+                swapped += swap;
+            }
+        }
+        if (regression_ && cols > 0) {
+            const float share = static_cast<float>(swapped) / static_cast<float>(cols);
+            const float ya = y[i];
+            const float yb = y[partner];
+            y[i] = (1.0f - share) * ya + share * yb;
+            y[partner] = (1.0f - share) * yb + share * ya;
+        }
+    }
+}
+
+void Augmenter::Noise(int64_t rows, int64_t cols, float* x, uint64_t key) const {
+    // Box-Muller: 每两个均匀随机数得到两个标准正态
+    const auto count = rows * cols;
+    uint32_t random[Philox::BLOCK];
+    float normal[Philox::BLOCK];
+    constexpr int64_t HALF = Philox::BLOCK / 2;
+    for (int64_t e0 = 0; e0 < count; e0 += Philox::BLOCK) {
+        Philox::Block(key, static_cast<uint64_t>(e0 / 4), random);
+        for (int64_t k = 0; k < HALF; ++k) {
+            // 避开 log(0)
+            const float u1 = (static_cast<float>(random[k] >> 8) + 0.5f) * (1.0f / 16777216.0f);
+            const float u2 = Philox::Uniform(random[HALF + k]);
+            const float radius = strength_ * std::sqrt(-2.0f * std::log(u1));
+            normal[k] = radius * std::cos(TWO_PI * u2);
+            normal[HALF + k] = radius * std::sin(TWO_PI * u2);
+        }
+        const auto n = std::min(Philox::BLOCK, count - e0);
+        float* __restrict xe = x + e0;
+        for (int64_t e = 0; e < n; ++e) {
+            xe[e] += normal[e];
+        }
+    }
+}
+
+BatchPrefetcher::BatchPrefetcher(int64_t batch, int64_t cols, Producer produce) : produce_(std::move(produce)) {
+    for (auto& slot : slots_) {
+        slot.x.resize(batch * cols);
+        slot.y.resize(batch);
+    }
+}
+
+void BatchPrefetcher::Reset(int64_t count) {
+    std::unique_lock<std::mutex> guard(lock_);
+    changed_.wait(guard, [&]() {
+        return slots_[0].index != SLOT_LOADING && slots_[1].index != SLOT_LOADING;
+    });
+    slots_[0].index = -1;
+    slots_[1].index = -1;
+    ++epoch_;
+    count_ = count;
+    next_load_ = 0;
+    current_ = nullptr;
+    current_index_ = -1;
+    changed_.notify_all();
+}
+
+BatchPrefetcher::Slot& BatchPrefetcher::Acquire(int64_t index) {
+    auto& slot = slots_[index % 2];
+    std::unique_lock<std::mutex> guard(lock_);
+    changed_.wait(guard, [&]() {
+        return error_ || slot.index == index || !prefetching_ || next_load_ <= index;
+    });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    if (slot.index == index) {
+        return slot;
+    }
+    // 没有预取线程, 或预取线程尚未认领这个 minibatch: 在训练线程上同步生产
+    changed_.wait(guard, [&]() { return slot.index != SLOT_LOADING; });
+    if (slot.index == index) {
+        return slot;
+    }
+    slot.index = SLOT_LOADING;
+    next_load_ = std::max(next_load_, index + 1);
+    const auto epoch = epoch_;
+    guard.unlock();
+    int64_t rows = 0;
+    try {
+        rows = produce_(epoch, index, slot.x.data(), slot.y.data());
+    } catch (...) {
+        guard.lock();
+        slot.index = -1;
+        changed_.notify_all();
+        throw;
+    }
+    guard.lock();
+    slot.rows = rows;
+    slot.index = index;
+    changed_.notify_all();
+    return slot;
+}
+
+int64_t BatchPrefetcher::Next(const float** x, const float** y) {
+    if (current_) {
+        std::lock_guard<std::mutex> guard(lock_);
+        current_->index = -1;
+        current_ = nullptr;
+        changed_.notify_all();
+    }
+    if (current_index_ + 1 >= count_) {
+        return 0;
+    }
+    current_ = &Acquire(++current_index_);
+    *x = current_->x.data();
+    *y = current_->y.data();
+    return current_->rows;
+}
+
+void BatchPrefetcher::RunPrefetcher() {
+    std::unique_lock<std::mutex> guard(lock_);
+    if (closed_) {
+        return;
+    }
+    prefetching_ = true;
+    changed_.notify_all();
+    while (true) {
+        changed_.wait(guard, [&]() {
+            return closed_ || (next_load_ < count_ && slots_[next_load_ % 2].index == -1);
+        });
+        if (closed_) {
+            break;
+        }
+        const auto index = next_load_++;
+        const auto epoch = epoch_;
+        auto& slot = slots_[index % 2];
+        slot.index = SLOT_LOADING;
+        guard.unlock();
+        int64_t rows = 0;
+        try {
+            rows = produce_(epoch, index, slot.x.data(), slot.y.data());
+        } catch (...) {
+            guard.lock();
+            slot.index = -1;
+            error_ = std::current_exception();
+            break;
+        }
+        guard.lock();
+        slot.rows = rows;
+        slot.index = index;
+        changed_.notify_all();
+    }
+    prefetching_ = false;
+    changed_.notify_all();
+}
+
+void BatchPrefetcher::Close() {
+    std::lock_guard<std::mutex> guard(lock_);
+    closed_ = true;
+    changed_.notify_all();
+}
+
+} // namespace regdb
@@ -0,0 +1,212 @@
+#include "regdb/core/engine/benchmark.hpp"
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/kernels.hpp"
+#include "regdb/core/engine/trainer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+
+namespace regdb {
+
+namespace {
+
+// 合成分类/回归数据, 标签由特征的固定线性组合决定
+Dataset SyntheticDataset(const ModelSpec& spec, int64_t rows, uint64_t seed) {
+    Dataset data;
+    data.rows = rows;
+    data.cols = spec.in_features;
+    data.features.resize(rows * spec.in_features);
+    data.labels.resize(rows);
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    std::normal_distribution<float> normal;
+    for (int64_t i = 0; i < rows; ++i) {
+        float score = 0.0f;
+        for (int64_t j = 0; j < spec.in_features; ++j) {
+            const auto value = normal(rng);
+            data.features[i * spec.in_features + j] = value;
+            score += value * static_cast<float>(j % 3 - 1);
+        }
+        data.labels[i] = spec.out_features == 1 ? score : (score > 0.0f ? 1.0f : 0.0f);
+    }
+    return data;
+}
+
+// 类似 one-hot/哈希之后的宽稀疏输入, 标签由激活列的固定权重之和决定
+Dataset SparseDataset(const ModelSpec& spec, int64_t rows, int64_t active, uint64_t seed) {
+    Dataset data;
+    data.rows = rows;
+    data.cols = spec.in_features;
+    data.features.assign(rows * spec.in_features, 0.0f);
+    data.labels.resize(rows);
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    std::uniform_int_distribution<int64_t> column(0, spec.in_features - 1);
+    for (int64_t i = 0; i < rows; ++i) {
+        float score = 0.0f;
+        for (int64_t k = 0; k < active; ++k) {
+            const auto j = column(rng);
+            data.features[i * spec.in_features + j] = 1.0f;
+            score += static_cast<float>(j % 3) - 1.0f;
+        }
+        data.labels[i] = spec.out_features == 1 ? score : (score > 0.0f ? 1.0f : 0.0f);
+    }
+    return data;
+}
+
+DataSplit AllRows(const Dataset& data) {
+    DataSplit split;
+    split.train.resize(data.rows);
+    for (int64_t i = 0; i < data.rows; ++i) {
+        split.train[i] = i;
+    }
+    return split;
+}
+
+struct Measurement {
+    double steps_per_second = 0.0;
+    double train_loss = 0.0;
+};
+
+// 训练一个 epoch (不做验证)
+Measurement Measure(const ModelSpec& spec, const Dataset& data, const DataSplit& split, const TrainOptions& options) {
+    Mlp model(spec, RegConfig(), options.seed);
+    const Trainer trainer(data, split, options);
+    Deadline deadline(std::chrono::hours(24));
+    StopToken token(deadline);
+    const auto begin = std::chrono::steady_clock::now();
+    const auto result = trainer.Train(model, token);
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+    Measurement measurement;
+    measurement.steps_per_second = static_cast<double>(result.steps) / std::max(seconds.count(), 1e-9);
+    measurement.train_loss = result.train_curve.empty() ? 0.0 : result.train_curve.back();
+    return measurement;
+}
+
+// 先预热一次, 再重复运行至少 seconds 秒, 返回每秒运行次数
+double RunsPerSecond(const std::function<void()>& run, double seconds) {
+    run();
+    const auto begin = std::chrono::steady_clock::now();
+    int64_t runs = 0;
+    std::chrono::duration<double> elapsed(0.0);
+    do {
+        run();
+        ++runs;
+        elapsed = std::chrono::steady_clock::now() - begin;
+    } while (elapsed.count() < seconds);
+    return static_cast<double>(runs) / elapsed.count();
+}
+
+} // namespace
+
+std::vector<BenchmarkRow> Benchmark::DataParallel(const ModelSpec& spec, const std::vector<int64_t>& threads) {
+    const auto data = SyntheticDataset(spec, BATCH_SIZE * STEPS, 42);
+    const auto split = AllRows(data);
+
+    TrainOptions options;
+    options.max_epochs = 1;
+    options.batch_size = BATCH_SIZE;
+
+    std::vector<BenchmarkRow> rows;
+    double baseline = 0.0;
+    for (auto count : threads) {
+        options.threads = count;
+        const auto steps_per_second = Measure(spec, data, split, options).steps_per_second;
+        if (baseline == 0.0) {
+            baseline = steps_per_second;
+        }
+        rows.push_back({"data_parallel", "sync", count, steps_per_second, "steps/s"});
+        rows.push_back({"data_parallel", "sync", count, steps_per_second / baseline, "speedup"});
+    }
+    return rows;
+}
+
+std::vector<BenchmarkRow> Benchmark::Hogwild(const ModelSpec& spec, const std::vector<int64_t>& threads) {
+    auto wide = spec;
+    wide.in_features = std::max(spec.in_features, WIDE_FEATURES);
+    const auto data = SparseDataset(wide, BATCH_SIZE * STEPS, ACTIVE_FEATURES, 42);
+    const auto split = AllRows(data);
+
+    TrainOptions options;
+    options.max_epochs = 1;
+    options.batch_size = BATCH_SIZE;
+
+    std::vector<BenchmarkRow> rows;
+    for (auto count : threads) {
+        for (const bool hogwild : {false, true}) {
+            options.threads = count;
+            options.hogwild = hogwild;
+            const auto measurement = Measure(wide, data, split, options);
+            const std::string variant = hogwild ? "hogwild" : "sync";
+            rows.push_back({"hogwild", variant, count, measurement.steps_per_second, "steps/s"});
+            rows.push_back({"hogwild", variant, count, measurement.train_loss, "train_loss"});
+        }
+    }
+    return rows;
+}
+
+std::vector<BenchmarkRow> Benchmark::ArenaAllocations(const ModelSpec& spec) {
+    const auto data = SyntheticDataset(spec, BATCH_SIZE * 2, 42);
+    const auto split = AllRows(data);
+    TrainOptions options;
+    options.batch_size = BATCH_SIZE;
+
+    // 返回训练一个新 trial 期间的全部堆分配次数, 包括模型、结果曲线和线程局部缓冲
+    auto count = [&](int64_t epochs) {
+        options.max_epochs = epochs;
+        HeapCounter counter;
+        Measure(spec, data, split, options);
+        return counter.Count();
+    };
+    ArenaPool::Instance().Clear();
+    const auto first = count(1);
+    const auto reused = count(1);
+    const auto longer = count(3);
+
+    std::vector<BenchmarkRow> rows;
+    rows.push_back({"arena", "first_trial", 1, static_cast<double>(first), "allocations"});
+    rows.push_back({"arena", "reused_trial", 1, static_cast<double>(reused), "allocations"});
+    rows.push_back({"arena", "per_epoch", 1, static_cast<double>(longer - reused) / 2.0, "allocations"});
+    return rows;
+}
+
+std::vector<BenchmarkRow> Benchmark::LayerWidths(const ModelSpec& spec) {
+    std::vector<int64_t> widths = {64, 128, 256, 512};
+    for (auto width : spec.hidden_features) {
+        if (std::find(widths.begin(), widths.end(), width) == widths.end()) {
+            widths.push_back(width);
+        }
+    }
+
+    std::vector<BenchmarkRow> rows;
+    std::mt19937 rng(42);
+    std::normal_distribution<float> normal;
+    for (auto width : widths) {
+        std::vector<float> x(BATCH_SIZE * width);
+        std::vector<float> weight(width * width);
+        std::vector<float> bias(width);
+        std::vector<float> z(BATCH_SIZE * width);
+        for (auto* values : {&x, &weight, &bias}) {
+            for (auto& value : *values) {
+                value = normal(rng);
+            }
+        }
+        const double flops = 2.0 * static_cast<double>(BATCH_SIZE * width * width);
+        const auto gemm = flops * RunsPerSecond([&] {
+            kernels::LinearGemm(BATCH_SIZE, width, width, x.data(), weight.data(), bias.data(), z.data());
+        }, KERNEL_SECONDS) / 1e9;
+        const auto linear = flops * RunsPerSecond([&] {
+            kernels::Linear(BATCH_SIZE, width, width, x.data(), weight.data(), bias.data(), z.data());
+        }, KERNEL_SECONDS) / 1e9;
+
+        const auto name = std::to_string(width);
+        const auto variant = kernels::IsFixedWidth(width) ? std::string("fixed_") + kernels::DenseKernelIsa()
+                                                          : std::string("fallback");
+        rows.push_back({"layer_width", name + "/gemm", 1, gemm, "GFLOP/s"});
+        rows.push_back({"layer_width", name + "/" + variant, 1, linear, "GFLOP/s"});
+        rows.push_back({"layer_width", name + "/" + variant, 1, linear / gemm, "speedup"});
+    }
+    return rows;
+}
+
+} // namespace regdb
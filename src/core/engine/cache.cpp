@@ -0,0 +1,106 @@
+#include "regdb/core/engine/cache.hpp"
+
+#include <exception>
+#include <utility>
+
+namespace regdb {
+
+namespace {
+
+int64_t DatasetBytes(const Dataset& data) {
+    return static_cast<int64_t>((data.features.size() + data.labels.size()) * sizeof(float));
+}
+
+} // namespace
+
+DatasetCache& DatasetCache::Instance() {
+    static DatasetCache cache;
+    return cache;
+}
+
+std::shared_ptr<const Dataset> DatasetCache::Get(uint64_t key, const std::string& version, const Loader& load) {
+    std::promise<std::shared_ptr<const Dataset>> promise;
+    std::shared_future<std::shared_ptr<const Dataset>> pending;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.version == version) {
+            it->second.last_use = ++clock_;
+            pending = it->second.dataset;
+        } else {
+            // 数据源已变化, 作废旧条目
+            if (it != entries_.end()) {
+                bytes_ -= it->second.bytes;
+                entries_.erase(it);
+            }
+            Entry entry;
+            entry.version = version;
+            entry.dataset = promise.get_future().share();
+            entry.last_use = ++clock_;
+            entries_.emplace(key, std::move(entry));
+        }
+    }
+    if (pending.valid()) {
+        // 等待其他查询的加载完成, 加载失败时重新抛出其异常
+        return pending.get();
+    }
+
+    std::shared_ptr<const Dataset> data;
+    try {
+        data = std::make_shared<const Dataset>(load());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> guard(lock_);
+        auto failed = entries_.find(key);
+        if (failed != entries_.end() && failed->second.version == version && failed->second.bytes == 0) {
+            entries_.erase(failed);
+        }
+        throw;
+    }
+    promise.set_value(data);
+    std::lock_guard<std::mutex> guard(lock_);
+    auto loaded = entries_.find(key);
+    if (loaded != entries_.end() && loaded->second.version == version) {
+        loaded->second.bytes = DatasetBytes(*data);
+        bytes_ += loaded->second.bytes;
+        Evict();
+    }
+    return data;
+}
+
+void DatasetCache::SetCapacity(int64_t bytes) {
+    std::lock_guard<std::mutex> guard(lock_);
+    capacity_ = bytes;
+    Evict();
+}
+
+void DatasetCache::Clear() {
+    std::lock_guard<std::mutex> guard(lock_);
+    // 正在加载的条目也一并丢弃, 加载完成后找不到条目, 结果只返回给等待的查询
+    entries_.clear();
+    bytes_ = 0;
+}
+
+int64_t DatasetCache::Bytes() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return bytes_;
+}
+
+void DatasetCache::Evict() {
+    while (bytes_ > capacity_) {
+        auto victim = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            // 正在加载的条目不参与淘汰
+            if (it->second.bytes > 0 && (victim == entries_.end() || it->second.last_use < victim->second.last_use)) {
+                victim = it;
+            }
+        }
+        if (victim == entries_.end()) {
+            return;
+        }
+        bytes_ -= victim->second.bytes;
+        entries_.erase(victim);
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,296 @@
+#include "regdb/core/engine/checkpoint.hpp"
+#include "regdb/core/engine/parallel.hpp"
+#include "regdb/core/engine/trainer.hpp"
+#include "filesystem.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+namespace {
+
+const char* const MANIFEST = "manifest.json";
+const char* const ARRAY_NAMES[Checkpointer::ARRAYS] = {"params", "buffers", "adam_m", "adam_v", "lookahead_slow",
+                                                       "swa_average"};
+
+// 按 8 字节一步的 FNV-1a, 只用于判断块内容是否变化
+uint64_t HashBlock(const float* data, int64_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    const auto bytes = static_cast<size_t>(size) * sizeof(float);
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= bytes; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, reinterpret_cast<const char*>(data) + offset, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; offset < bytes; ++offset) {
+        hash = (hash ^ static_cast<uint8_t>(reinterpret_cast<const char*>(data)[offset])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string BlockName(int array, int64_t block, uint64_t hash) {
+    std::ostringstream name;
+    name << ARRAY_NAMES[array] << '-' << block << '-' << std::hex << hash << ".bin";
+    return name.str();
+}
+
+// 先写临时文件再改名, 读者只会看到旧文件或完整的新文件
+void WriteFile(const std::filesystem::path& path, const char* data, size_t bytes) {
+    const auto temporary = path.string() + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(data, static_cast<std::streamsize>(bytes));
+        if (!out) {
+            throw std::runtime_error("Failed to write checkpoint file '" + temporary + "'.");
+        }
+    }
+    std::filesystem::rename(temporary, path);
+}
+
+void WriteManifest(const std::filesystem::path& directory, const nlohmann::json& manifest) {
+    const auto text = manifest.dump();
+    WriteFile(directory / MANIFEST, text.data(), text.size());
+}
+
+bool ReadManifest(const std::filesystem::path& directory, nlohmann::json& manifest) {
+    std::ifstream in(directory / MANIFEST);
+    if (!in) {
+        return false;
+    }
+    manifest = nlohmann::json::parse(in, nullptr, false);
+    return !manifest.is_discarded() && manifest.is_object();
+}
+
+// 删除清单不再引用的块文件和残留的临时文件
+void RemoveUnreferenced(const std::filesystem::path& directory, const std::set<std::string>& referenced) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        const auto name = entry.path().filename().string();
+        if (name != MANIFEST && !referenced.count(name)) {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+nlohmann::json ResultManifest(const TrainResult& result) {
+    return {
+        {"finished", true},
+        {"epoch", static_cast<int64_t>(result.val_curve.size()) - 1},
+        {"steps", result.steps},
+        {"stopped_early", result.stopped_early},
+        {"train_curve", result.train_curve},
+        {"val_curve", result.val_curve}
+    };
+}
+
+} // namespace
+
+bool Checkpoint::Load(const std::string& directory, Checkpoint& checkpoint) {
+    nlohmann::json manifest;
+    if (!ReadManifest(directory, manifest)) {
+        return false;
+    }
+    checkpoint = Checkpoint();
+    checkpoint.finished = manifest.value("finished", false);
+    checkpoint.epoch = manifest.value("epoch", int64_t(-1));
+    checkpoint.steps = manifest.value("steps", int64_t(0));
+    checkpoint.stopped_early = manifest.value("stopped_early", false);
+    checkpoint.train_curve = manifest.value("train_curve", std::vector<double>());
+    checkpoint.val_curve = manifest.value("val_curve", std::vector<double>());
+    if (checkpoint.finished) {
+        return true;
+    }
+    checkpoint.adam_steps = manifest.at("adam_steps").get<int64_t>();
+    checkpoint.rng = manifest.at("rng").get<std::string>();
+    checkpoint.swa_samples = manifest.value("swa_samples", int64_t(0));
+    std::vector<float>* arrays[Checkpointer::ARRAYS] = {&checkpoint.params, &checkpoint.buffers, &checkpoint.adam_m,
+                                                        &checkpoint.adam_v, &checkpoint.lookahead_slow,
+                                                        &checkpoint.swa_average};
+    const auto& entries = manifest.at("arrays");
+    for (int array = 0; array < Checkpointer::ARRAYS; ++array) {
+        // 较早的检查点没有权重平均的数组, 恢复时按未保存处理
+        if (!entries.contains(ARRAY_NAMES[array])) {
+            continue;
+        }
+        const auto& entry = entries.at(ARRAY_NAMES[array]);
+        auto& values = *arrays[array];
+        values.resize(entry.at("size").get<size_t>());
+        const auto& blocks = entry.at("blocks");
+        for (size_t block = 0; block < blocks.size(); ++block) {
+            const auto begin = static_cast<int64_t>(block) * Checkpointer::BLOCK_FLOATS;
+            const auto size = std::min<int64_t>(Checkpointer::BLOCK_FLOATS, static_cast<int64_t>(values.size()) - begin);
+            const auto name = blocks[block].get<std::string>();
+            std::ifstream in(std::filesystem::path(directory) / name, std::ios::binary);
+            in.read(reinterpret_cast<char*>(values.data() + begin), static_cast<std::streamsize>(size * sizeof(float)));
+            if (!in || BlockName(array, static_cast<int64_t>(block), HashBlock(values.data() + begin, size)) != name) {
+                throw std::runtime_error("Checkpoint block '" + name + "' in '" + directory + "' is missing or corrupt.");
+            }
+        }
+    }
+    return true;
+}
+
+void Checkpoint::Restore(Mlp& model, Adam& optimizer, WeightAveraging& averaging, std::mt19937& generator) const {
+    if (params.size() != model.Parameters().size() || buffers.size() != model.Buffers().size()) {
+        throw std::runtime_error("Checkpoint does not match the model architecture.");
+    }
+    std::copy(params.begin(), params.end(), model.Parameters().begin());
+    std::copy(buffers.begin(), buffers.end(), model.Buffers().begin());
+    optimizer.LoadState(adam_m, adam_v, adam_steps);
+    averaging.LoadState(model, lookahead_slow, swa_average, swa_samples);
+    std::istringstream state(rng);
+    state >> generator;
+}
+
+TrainResult Checkpoint::Progress() const {
+    TrainResult result;
+    result.train_curve = train_curve;
+    result.val_curve = val_curve;
+    result.steps = steps;
+    result.stopped_early = stopped_early;
+    for (size_t epoch = 0; epoch < val_curve.size(); ++epoch) {
+        if (val_curve[epoch] < result.best_val_loss) {
+            result.best_val_loss = val_curve[epoch];
+            result.best_epoch = static_cast<int64_t>(epoch);
+        }
+    }
+    return result;
+}
+
+Checkpointer::Checkpointer(std::string directory, std::chrono::milliseconds interval)
+    : directory_(std::move(directory)), interval_(interval), last_(std::chrono::steady_clock::now()),
+      files_(ARRAYS) {
+    std::filesystem::create_directories(directory_);
+    // 从已有的清单继续时, 内容没有变化的块不必重写
+    nlohmann::json manifest;
+    if (ReadManifest(directory_, manifest) && manifest.contains("arrays")) {
+        for (int array = 0; array < ARRAYS; ++array) {
+            if (manifest["arrays"].contains(ARRAY_NAMES[array])) {
+                files_[array] = manifest["arrays"][ARRAY_NAMES[array]].value("blocks", std::vector<std::string>());
+            }
+        }
+    }
+}
+
+Checkpointer::~Checkpointer() {
+    Flush();
+}
+
+bool Checkpointer::Due() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return !busy_ && std::chrono::steady_clock::now() - last_ >= interval_;
+}
+
+bool Checkpointer::Offer(const Mlp& model, const Adam& optimizer, const WeightAveraging& averaging,
+                         const std::mt19937& rng, const TrainResult& progress, int64_t epoch) {
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (busy_) {
+            return false;
+        }
+    }
+    // 没有正在写的快照时不会有线程读 back_, 复制不需要持锁; 除第一次以外复用已有容量, 不分配内存
+    back_.epoch = epoch;
+    back_.adam_steps = optimizer.Steps();
+    std::ostringstream state;
+    state << rng;
+    back_.rng = state.str();
+    const auto completed = std::min(progress.train_curve.size(), static_cast<size_t>(epoch + 1));
+    back_.train_curve.assign(progress.train_curve.begin(), progress.train_curve.begin() + completed);
+    back_.val_curve = progress.val_curve;
+    back_.steps = progress.steps;
+    back_.arrays[0].assign(model.Parameters().begin(), model.Parameters().end());
+    back_.arrays[1].assign(model.Buffers().begin(), model.Buffers().end());
+    optimizer.SaveState(back_.arrays[2], back_.arrays[3]);
+    averaging.SaveState(back_.arrays[4], back_.arrays[5], back_.swa_samples);
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::swap(back_, front_);
+        busy_ = true;
+        last_ = std::chrono::steady_clock::now();
+    }
+    // 写入占用 threads 上限内的一个名额; 池已满时在训练线程上写, 不越过上限
+    if (!ThreadPool::Instance().Submit([this]() { WriteFront(); })) {
+        WriteFront();
+    }
+    return true;
+}
+
+void Checkpointer::Flush() {
+    std::unique_lock<std::mutex> guard(lock_);
+    idle_.wait(guard, [this]() { return !busy_; });
+}
+
+void Checkpointer::Finish(const TrainResult& result) {
+    Flush();
+    WriteManifest(directory_, ResultManifest(result));
+    RemoveUnreferenced(directory_, {});
+    for (auto& files : files_) {
+        files.clear();
+    }
+}
+
+void Checkpointer::WriteResult(const std::string& directory, const TrainResult& result) {
+    std::filesystem::create_directories(directory);
+    WriteManifest(directory, ResultManifest(result));
+    RemoveUnreferenced(directory, {});
+}
+
+void Checkpointer::WriteFront() {
+    // 写失败只丢掉这一次检查点, 不影响训练
+    try {
+        Write(front_);
+    } catch (const std::exception&) {
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    busy_ = false;
+    idle_.notify_all();
+}
+
+void Checkpointer::Write(const Snapshot& snapshot) {
+    const std::filesystem::path directory(directory_);
+    nlohmann::json arrays;
+    std::set<std::string> referenced;
+    for (int array = 0; array < ARRAYS; ++array) {
+        const auto& values = snapshot.arrays[array];
+        const auto size = static_cast<int64_t>(values.size());
+        const auto blocks = (size + BLOCK_FLOATS - 1) / BLOCK_FLOATS;
+        auto& files = files_[array];
+        files.resize(blocks);
+        for (int64_t block = 0; block < blocks; ++block) {
+            const auto begin = block * BLOCK_FLOATS;
+            const auto count = std::min(BLOCK_FLOATS, size - begin);
+            const auto name = BlockName(array, block, HashBlock(values.data() + begin, count));
+            if (files[block] != name) {
+                WriteFile(directory / name, reinterpret_cast<const char*>(values.data() + begin),
+                          static_cast<size_t>(count) * sizeof(float));
+                files[block] = name;
+                ++written_blocks_;
+            }
+            referenced.insert(name);
+        }
+        arrays[ARRAY_NAMES[array]] = {{"size", size}, {"blocks", files}};
+    }
+    WriteManifest(directory, {
+        {"finished", false},
+        {"epoch", snapshot.epoch},
+        {"steps", snapshot.steps},
+        {"adam_steps", snapshot.adam_steps},
+        {"rng", snapshot.rng},
+        {"swa_samples", snapshot.swa_samples},
+        {"train_curve", snapshot.train_curve},
+        {"val_curve", snapshot.val_curve},
+        {"arrays", arrays}
+    });
+    RemoveUnreferenced(directory, referenced);
+}
+
+} // namespace regdb
@@ -0,0 +1,57 @@
+#include "regdb/core/engine/dataset.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace regdb {
+
+std::vector<int64_t> ShuffleRows(int64_t rows, uint64_t seed) {
+    std::vector<int64_t> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937_64 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+    return order;
+}
+
+DataSplit SplitHoldout(int64_t rows, double validation_fraction, uint64_t seed) {
+    if (rows < 2) {
+        throw std::runtime_error("Training data needs at least two rows.");
+    }
+    const auto order = ShuffleRows(rows, seed);
+
+    auto validation_rows = static_cast<int64_t>(static_cast<double>(rows) * validation_fraction);
+    validation_rows = std::max<int64_t>(1, std::min(validation_rows, rows - 1));
+
+    DataSplit split;
+    split.validation.assign(order.begin(), order.begin() + validation_rows);
+    split.train.assign(order.begin() + validation_rows, order.end());
+    return split;
+}
+
+DataSplit SplitFold(const std::vector<int64_t>& order, int64_t folds, int64_t fold) {
+    const auto rows = static_cast<int64_t>(order.size());
+    if (folds < 2 || rows < folds) {
+        throw std::runtime_error("k-fold cross validation needs 2 <= folds <= rows.");
+    }
+    const auto begin = rows * fold / folds;
+    const auto end = rows * (fold + 1) / folds;
+
+    DataSplit split;
+    split.validation.assign(order.begin() + begin, order.begin() + end);
+    split.train.reserve(rows - (end - begin));
+    split.train.insert(split.train.end(), order.begin(), order.begin() + begin);
+    split.train.insert(split.train.end(), order.begin() + end, order.end());
+    return split;
+}
+
+void GatherRows(const Dataset& data, const int64_t* rows, int64_t count, float* x, float* y) {
+    for (int64_t i = 0; i < count; ++i) {
+        std::memcpy(x + i * data.cols, data.Row(rows[i]), sizeof(float) * data.cols);
+        y[i] = data.labels[rows[i]];
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,97 @@
+#include "regdb/core/engine/deadline.hpp"
+
+#include <cctype>
+#include <stdexcept>
+
+namespace regdb {
+
+// 解析时间阈值
+std::chrono::milliseconds ParseTimeThreshold(const std::string& threshold) {
+    size_t pos = 0;
+    while (pos < threshold.size() && std::isspace(static_cast<unsigned char>(threshold[pos]))) {
+        ++pos;
+    }
+    const auto start = pos;
+    while (pos < threshold.size() && (std::isdigit(static_cast<unsigned char>(threshold[pos])) || threshold[pos] == '.')) {
+        ++pos;
+    }
+    if (pos == start) {
+        throw std::runtime_error("Invalid time threshold '" + threshold + "', expected e.g. 120s, 5m or 1h.");
+    }
+    const double amount = std::stod(threshold.substr(start, pos - start));
+    std::string unit;
+    for (; pos < threshold.size(); ++pos) {
+        if (!std::isspace(static_cast<unsigned char>(threshold[pos]))) {
+            unit.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(threshold[pos]))));
+        }
+    }
+
+    double millis;
+    if (unit == "ms") {
+        millis = amount;
+    } else if (unit.empty() || unit == "s") {
+        millis = amount * 1000.0;
+    } else if (unit == "m") {
+        millis = amount * 60.0 * 1000.0;
+    } else if (unit == "h") {
+        millis = amount * 3600.0 * 1000.0;
+    } else {
+        throw std::runtime_error("Unknown time unit '" + unit + "' in time threshold, expected ms, s, m or h.");
+    }
+    if (millis <= 0) {
+        throw std::runtime_error("Time threshold must be positive.");
+    }
+    return std::chrono::milliseconds(static_cast<int64_t>(millis));
+}
+
+std::string StopReasonToString(StopReason reason) {
+    switch (reason) {
+        case StopReason::NONE:
+            return "completed";
+        case StopReason::DEADLINE:
+            return "deadline";
+        case StopReason::INTERRUPTED:
+            return "interrupted";
+        default:
+            return "unknown";
+    }
+}
+
+Deadline::Deadline(std::chrono::milliseconds budget)
+    : start_(Clock::now()), end_(start_ + budget), budget_(budget) {}
+
+std::chrono::milliseconds Deadline::Elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_);
+}
+
+std::chrono::milliseconds Deadline::Remaining() const {
+    const auto now = Clock::now();
+    if (now >= end_) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end_ - now);
+}
+
+// 抢占点检查: 已停止 -> 中断 -> 截止时间
+bool StopToken::ShouldStop() {
+    if (reason_.load(std::memory_order_relaxed) != StopReason::NONE) {
+        return true;
+    }
+    if (interrupted_ && interrupted_->load(std::memory_order_relaxed)) {
+        RequestStop(StopReason::INTERRUPTED);
+        return true;
+    }
+    if (deadline_.Expired()) {
+        RequestStop(StopReason::DEADLINE);
+        return true;
+    }
+    return false;
+}
+
+// 只记录第一次停止原因
+void StopToken::RequestStop(StopReason reason) {
+    auto expected = StopReason::NONE;
+    reason_.compare_exchange_strong(expected, reason, std::memory_order_acq_rel);
+}
+
+} // namespace regdb
@@ -0,0 +1,106 @@
+#include "regdb/core/engine/early_stop.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace regdb {
+
+namespace {
+
+// 固定 c 后 a, b 是线性最小二乘的闭式解; c 在对数网格上搜索
+constexpr int64_t RATE_STEPS = 32;
+constexpr double RATE_MIN = 0.02;
+constexpr double RATE_MAX = 4.0;
+
+// 按 basis(t, c) 拟合 a + b * basis, 返回 SSE 最小的拟合在 epochs 处的预测值, 没有 b > 0 的拟合时返回正无穷
+template <typename Basis>
+double FitFamily(const std::vector<double>& curve, int64_t epochs, Basis basis) {
+    const auto n = static_cast<double>(curve.size());
+    double best_sse = std::numeric_limits<double>::infinity();
+    double prediction = std::numeric_limits<double>::infinity();
+    for (int64_t step = 0; step < RATE_STEPS; ++step) {
+        const auto c = RATE_MIN * std::pow(RATE_MAX / RATE_MIN, static_cast<double>(step) / (RATE_STEPS - 1));
+        double g_mean = 0.0;
+        double y_mean = 0.0;
+        for (size_t i = 0; i < curve.size(); ++i) {
+            g_mean += basis(static_cast<double>(i + 1), c);
+            y_mean += curve[i];
+        }
+        g_mean /= n;
+        y_mean /= n;
+        double cov = 0.0;
+        double var = 0.0;
+        for (size_t i = 0; i < curve.size(); ++i) {
+            const auto g = basis(static_cast<double>(i + 1), c) - g_mean;
+            cov += g * (curve[i] - y_mean);
+            var += g * g;
+        }
+        if (var <= 0.0 || cov <= 0.0) {
+            continue;
+        }
+        const auto b = cov / var;
+        const auto a = y_mean - b * g_mean;
+        double sse = 0.0;
+        for (size_t i = 0; i < curve.size(); ++i) {
+            const auto r = curve[i] - a - b * basis(static_cast<double>(i + 1), c);
+            sse += r * r;
+        }
+        if (sse < best_sse) {
+            best_sse = sse;
+            prediction = a + b * basis(static_cast<double>(epochs), c);
+        }
+    }
+    return prediction;
+}
+
+} // namespace
+
+void Incumbent::Offer(double loss) {
+    auto best = best_.load(std::memory_order_relaxed);
+    while (loss < best && !best_.compare_exchange_weak(best, loss, std::memory_order_relaxed)) {
+    }
+}
+
+double ExtrapolateCurve(const std::vector<double>& curve, int64_t epochs) {
+    if (curve.empty()) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    const auto lowest = *std::min_element(curve.begin(), curve.end());
+    if (curve.size() < 2) {
+        return lowest;
+    }
+    const auto power = FitFamily(curve, epochs, [](double t, double c) { return std::pow(t, -c); });
+    const auto exponential = FitFamily(curve, epochs, [](double t, double c) { return std::exp(-c * t); });
+    // 损失非负, 外推值不会低于 0
+    const auto prediction = std::max(0.0, std::min(power, exponential));
+    return std::min(prediction, lowest);
+}
+
+bool EarlyStopping::Update(const std::vector<double>& curve) {
+    if (curve.empty()) {
+        return false;
+    }
+    const auto loss = curve.back();
+    if (incumbent_) {
+        incumbent_->Offer(loss);
+    }
+    if (spec_.patience > 0) {
+        if (loss < best_ - spec_.min_delta) {
+            best_ = loss;
+            stale_ = 0;
+        } else if (++stale_ >= spec_.patience) {
+            return true;
+        }
+    }
+    // 外推到最后一个 epoch 的乐观值仍明显差于其他 trial 的最优值时, 剩余 epoch 不值得再训练
+    const auto epochs = static_cast<int64_t>(curve.size());
+    if (spec_.extrapolate && incumbent_ && epochs >= EXTRAPOLATE_MIN_EPOCHS && epochs < max_epochs_) {
+        const auto incumbent = incumbent_->Best();
+        if (std::isfinite(incumbent) && ExtrapolateCurve(curve, max_epochs_) > incumbent * (1.0 + EXTRAPOLATE_MARGIN)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace regdb
@@ -0,0 +1,97 @@
+#include "regdb/core/engine/incremental.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace regdb {
+
+IncrementalTrainer::IncrementalTrainer(const ModelSpec& spec, const RegConfig& config, const TrainOptions& options)
+    : model_(spec, config, options.seed), options_(options), optimizer_(model_, options.learning_rate),
+      rng_(static_cast<uint32_t>(options.seed)) {
+    buffer_.cols = spec.in_features;
+}
+
+IncrementalTrainer::IncrementalTrainer(const ModelWeights& weights, const TrainOptions& options)
+    : IncrementalTrainer(weights.spec, weights.config, options) {
+    weights.Restore(model_);
+    if (!weights.adam_m.empty()) {
+        optimizer_.LoadState(weights.adam_m, weights.adam_v, weights.adam_steps);
+    }
+    rows_ = weights.rows;
+    loss_ = weights.train_loss;
+}
+
+void IncrementalTrainer::Add(const float* x, float y) {
+    const auto offset = buffer_.features.size();
+    buffer_.features.resize(offset + buffer_.cols);
+    std::copy(x, x + buffer_.cols, buffer_.features.data() + offset);
+    buffer_.labels.push_back(y);
+    if (++buffer_.rows >= FLUSH_ROWS) {
+        Flush();
+    }
+}
+
+void IncrementalTrainer::Flush() {
+    const auto rows = buffer_.rows;
+    if (rows == 0) {
+        return;
+    }
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    ws_.Reserve(model_, batch_size);
+    order_.resize(rows);
+    std::iota(order_.begin(), order_.end(), 0);
+    double epoch_loss = 0.0;
+    for (int64_t epoch = 0; epoch < options_.max_epochs; ++epoch) {
+        std::shuffle(order_.begin(), order_.end(), rng_);
+        double loss_sum = 0.0;
+        for (int64_t start = 0; start < rows; start += batch_size) {
+            const auto count = std::min(batch_size, rows - start);
+            GatherRows(buffer_, order_.data() + start, count, ws_.x.data(), ws_.y.data());
+            loss_sum += model_.TrainStep(ws_.x.data(), ws_.y.data(), count, ws_, rng_) * static_cast<double>(count);
+            optimizer_.Step(model_);
+        }
+        epoch_loss = loss_sum / static_cast<double>(rows);
+    }
+    loss_ = (loss_ * static_cast<double>(rows_) + epoch_loss * static_cast<double>(rows)) /
+            static_cast<double>(rows_ + rows);
+    rows_ += rows;
+    // 工作区还回 arena 池, 大量分组同时存活时只有正在训练的状态占用工作区
+    ws_ = MlpWorkspace();
+    buffer_.rows = 0;
+    buffer_.features.resize(0);
+    buffer_.labels.resize(0);
+}
+
+void IncrementalTrainer::Merge(IncrementalTrainer& other) {
+    Flush();
+    other.Flush();
+    if (other.rows_ == 0) {
+        return;
+    }
+    // 各份状态从同一个种子初始化, 在同一个盆地附近训练, 参数平均有意义
+    const auto weight = static_cast<float>(static_cast<double>(other.rows_) / static_cast<double>(rows_ + other.rows_));
+    auto blend = [weight](Buffer<float>& target, const Buffer<float>& source) {
+        float* __restrict t = target.data();
+        const float* __restrict s = source.data();
+        const auto size = static_cast<int64_t>(target.size());
+        for (int64_t i = 0; i < size; ++i) {
+            t[i] += weight * (s[i] - t[i]);
+        }
+    };
+    blend(model_.Parameters(), other.model_.Parameters());
+    blend(model_.Buffers(), other.model_.Buffers());
+    loss_ += static_cast<double>(weight) * (other.loss_ - loss_);
+    rows_ += other.rows_;
+}
+
+ModelWeights IncrementalTrainer::Weights(const std::string& model_name, const std::string& key, bool with_optimizer) {
+    Flush();
+    auto weights = ModelWeights::FromModel(model_name, key, model_, rows_, loss_);
+    if (with_optimizer) {
+        optimizer_.SaveState(weights.adam_m, weights.adam_v);
+        weights.adam_steps = optimizer_.Steps();
+    }
+    return weights;
+}
+
+} // namespace regdb
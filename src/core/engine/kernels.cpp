@@ -0,0 +1,756 @@
+#include "regdb/core/engine/kernels.hpp"
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/random.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// x86-64 上量化内核按 AVX-512 VNNI、AVX2 和通用目标各编译一份, 运行时按 CPU 选择
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define REGDB_X86_DISPATCH 1
+#define REGDB_KERNEL_BODY static inline __attribute__((always_inline))
+#else
+#define REGDB_KERNEL_BODY static inline
+#endif
+
+// 按宽度特化的线性层用 GCC 向量扩展写成, 其他编译器上 Linear 只走通用 GEMM
+#if defined(__GNUC__)
+#define REGDB_FIXED_WIDTH 1
+#endif
+
+namespace regdb {
+namespace kernels {
+
+namespace {
+
+constexpr int64_t BLOCK_K = 256;
+constexpr int64_t BLOCK_N = 256;
+constexpr float NORM_EPS = 1e-5f;
+
+// C[M, N] += alpha * A * B, A(i, k) = a[i * a_row + k * a_col], B 为 [K, N] 行主序
+// 内层对 C 的一行做 axpy, 编译器可以直接向量化, 一次处理 4 行复用 B 的访存
+void GemmAxpy(int64_t m, int64_t n, int64_t k, float alpha, const float* a, int64_t a_row, int64_t a_col,
+              const float* b, int64_t ldb, float* c, int64_t ldc) {
+    for (int64_t k0 = 0; k0 < k; k0 += BLOCK_K) {
+        const auto k1 = std::min(k, k0 + BLOCK_K);
+        for (int64_t j0 = 0; j0 < n; j0 += BLOCK_N) {
+            const auto nb = std::min(n, j0 + BLOCK_N) - j0;
+            int64_t i = 0;
+            for (; i + 4 <= m; i += 4) {
+                float* __restrict c0 = c + (i + 0) * ldc + j0;
+                float* __restrict c1 = c + (i + 1) * ldc + j0;
+                float* __restrict c2 = c + (i + 2) * ldc + j0;
+                float* __restrict c3 = c + (i + 3) * ldc + j0;
+                for (int64_t p = k0; p < k1; ++p) {
+                    const float* __restrict bp = b + p * ldb + j0;
+                    const float a0 = alpha * a[(i + 0) * a_row + p * a_col];
+                    const float a1 = alpha * a[(i + 1) * a_row + p * a_col];
+                    const float a2 = alpha * a[(i + 2) * a_row + p * a_col];
+                    const float a3 = alpha * a[(i + 3) * a_row + p * a_col];
+                    for (int64_t j = 0; j < nb; ++j) {
+                        const float bv = bp[j];
+                        c0[j] += a0 * bv;
+                        c1[j] += a1 * bv;
+                        c2[j] += a2 * bv;
+                        c3[j] += a3 * bv;
+                    }
+                }
+            }
+            for (; i < m; ++i) {
+                float* __restrict ci = c + i * ldc + j0;
+                for (int64_t p = k0; p < k1; ++p) {
+                    const float* __restrict bp = b + p * ldb + j0;
+                    const float av = alpha * a[i * a_row + p * a_col];
+                    for (int64_t j = 0; j < nb; ++j) {
+                        ci[j] += av * bp[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 线程私有的打包缓冲, 只在容量不足时增长
+float* PackScratch(int64_t count) {
+    thread_local std::vector<float> scratch;
+    if (static_cast<int64_t>(scratch.size()) < count) {
+        scratch.resize(count);
+    }
+    return scratch.data();
+}
+
+} // namespace
+
+void ReservePackScratch(int64_t count) {
+    PackScratch(count);
+}
+
+void Gemm(bool trans_a, bool trans_b, int64_t m, int64_t n, int64_t k, float alpha,
+          const float* a, int64_t lda, const float* b, int64_t ldb, float beta, float* c, int64_t ldc) {
+    if (beta != 1.0f) {
+        for (int64_t i = 0; i < m; ++i) {
+            float* ci = c + i * ldc;
+            if (beta == 0.0f) {
+                std::fill(ci, ci + n, 0.0f);
+            } else {
+                for (int64_t j = 0; j < n; ++j) {
+                    ci[j] *= beta;
+                }
+            }
+        }
+    }
+    if (m == 0 || n == 0 || k == 0 || alpha == 0.0f) {
+        return;
+    }
+
+    const auto a_row = trans_a ? int64_t(1) : lda;
+    const auto a_col = trans_a ? lda : int64_t(1);
+    if (!trans_b) {
+        GemmAxpy(m, n, k, alpha, a, a_row, a_col, b, ldb, c, ldc);
+        return;
+    }
+    // B 按 [N, K] 存储, 先转置打包成 [K, N]
+    float* packed = PackScratch(k * n);
+    for (int64_t j = 0; j < n; ++j) {
+        const float* bj = b + j * ldb;
+        for (int64_t p = 0; p < k; ++p) {
+            packed[p * n + j] = bj[p];
+        }
+    }
+    GemmAxpy(m, n, k, alpha, a, a_row, a_col, packed, n, c, ldc);
+}
+
+void LinearGemm(int64_t rows, int64_t in, int64_t out, const float* x, const float* weight, const float* bias,
+                float* z) {
+    LinearGemm(rows, in, out, x, in, weight, out, bias, z, out);
+}
+
+void LinearGemm(int64_t rows, int64_t in, int64_t out, const float* x, int64_t ldx, const float* weight,
+                int64_t ldw, const float* bias, float* z, int64_t ldz) {
+    for (int64_t i = 0; i < rows; ++i) {
+        std::copy(bias, bias + out, z + i * ldz);
+    }
+    Gemm(false, false, rows, out, in, 1.0f, x, ldx, weight, ldw, 1.0f, z, ldz);
+}
+
+void ColumnSum(int64_t rows, int64_t cols, const float* x, float* out) {
+    for (int64_t i = 0; i < rows; ++i) {
+        const float* __restrict xi = x + i * cols;
+        for (int64_t j = 0; j < cols; ++j) {
+            out[j] += xi[j];
+        }
+    }
+}
+
+void Dropout(int64_t count, float rate, uint64_t key, uint64_t counter, float* x) {
+    // 随机数小于 rate * 2^32 时丢弃, 整数比较避免逐元素转换为浮点
+    const auto threshold = static_cast<uint32_t>(std::min(static_cast<double>(rate), 1.0) * 4294967295.0);
+    const float scale = 1.0f / (1.0f - rate);
+    uint32_t random[Philox::BLOCK];
+    for (int64_t j0 = 0; j0 < count; j0 += Philox::BLOCK) {
+        Philox::Block(key, counter + static_cast<uint64_t>(j0 / 4), random);
+        const auto n = std::min(Philox::BLOCK, count - j0);
+        float* __restrict xj = x + j0;
+        for (int64_t j = 0; j < n; ++j) {
+            xj[j] = random[j] < threshold ? 0.0f : xj[j] * scale;
+        }
+    }
+}
+
+void NormActForward(int64_t rows, int64_t cols, int64_t ld, const float* z, const NormActForwardArgs& args) {
+    const float inv_cols = 1.0f / static_cast<float>(cols);
+    const auto row_counters = Philox::Counters(cols);
+    for (int64_t i = 0; i < rows; ++i) {
+        const float* __restrict zi = z + i * ld;
+        // act 行作为这一行的工作区
+        float* __restrict ai = args.act + i * ld;
+        if (args.bn_mean) {
+            float* __restrict xi = args.bn_xhat ? args.bn_xhat + i * ld : nullptr;
+            for (int64_t j = 0; j < cols; ++j) {
+                const float xv = (zi[j] - args.bn_mean[j]) * args.bn_istd[j];
+                if (xi) {
+                    xi[j] = xv;
+                }
+                ai[j] = args.bn_gamma[j] * xv + args.bn_beta[j];
+            }
+        } else {
+            std::copy(zi, zi + cols, ai);
+        }
+        if (args.ln_gamma) {
+            float mean = 0.0f;
+            for (int64_t j = 0; j < cols; ++j) {
+                mean += ai[j];
+            }
+            mean *= inv_cols;
+            float var = 0.0f;
+            for (int64_t j = 0; j < cols; ++j) {
+                const float diff = ai[j] - mean;
+                var += diff * diff;
+            }
+            const float inv_std = 1.0f / std::sqrt(var * inv_cols + NORM_EPS);
+            args.ln_istd[i] = inv_std;
+            float* __restrict xi = args.ln_xhat ? args.ln_xhat + i * ld : nullptr;
+            for (int64_t j = 0; j < cols; ++j) {
+                const float xv = (ai[j] - mean) * inv_std;
+                if (xi) {
+                    xi[j] = xv;
+                }
+                ai[j] = args.ln_gamma[j] * xv + args.ln_beta[j];
+            }
+        }
+        for (int64_t j = 0; j < cols; ++j) {
+            ai[j] = ai[j] > 0.0f ? ai[j] : 0.0f;
+        }
+        if (args.dropout_rate > 0.0f) {
+            Dropout(cols, args.dropout_rate, args.dropout_key, args.dropout_counter + i * row_counters, ai);
+        }
+        if (args.skip) {
+            const float* __restrict si = args.skip + i * ld;
+            float* __restrict oi = args.out + i * ld;
+            for (int64_t j = 0; j < cols; ++j) {
+                oi[j] = ai[j] + si[j];
+            }
+        }
+    }
+}
+
+void BatchNormStatistics(int64_t rows, int64_t cols, int64_t ld, const float* z, float* mean, float* var,
+                         float* istd, float* running_mean, float* running_var, float momentum) {
+    // istd 暂存偏移量, 减去偏移后再累加平方和, 避免大均值下的相消误差
+    float* shift = istd;
+    std::copy(z, z + cols, shift);
+    std::fill(mean, mean + cols, 0.0f);
+    std::fill(var, var + cols, 0.0f);
+    for (int64_t i = 0; i < rows; ++i) {
+        const float* __restrict zi = z + i * ld;
+        for (int64_t j = 0; j < cols; ++j) {
+            const float diff = zi[j] - shift[j];
+            mean[j] += diff;
+            var[j] += diff * diff;
+        }
+    }
+    const float inv_rows = 1.0f / static_cast<float>(rows);
+    const float unbias = rows > 1 ? static_cast<float>(rows) / static_cast<float>(rows - 1) : 1.0f;
+    for (int64_t j = 0; j < cols; ++j) {
+        const float offset = mean[j] * inv_rows;
+        mean[j] = shift[j] + offset;
+        var[j] = std::max(0.0f, var[j] * inv_rows - offset * offset);
+        istd[j] = 1.0f / std::sqrt(var[j] + NORM_EPS);
+    }
+    if (running_mean && running_var) {
+        for (int64_t j = 0; j < cols; ++j) {
+            running_mean[j] = (1.0f - momentum) * running_mean[j] + momentum * mean[j];
+            running_var[j] = (1.0f - momentum) * running_var[j] + momentum * var[j] * unbias;
+        }
+    }
+}
+
+void NormActBackward(int64_t rows, int64_t cols, int64_t ld, float* d, const NormActBackwardArgs& args) {
+    const float inv_cols = 1.0f / static_cast<float>(cols);
+    if (args.bn_xhat) {
+        std::fill(args.bn_sum, args.bn_sum + cols, 0.0f);
+        std::fill(args.bn_dot, args.bn_dot + cols, 0.0f);
+    }
+    for (int64_t i = 0; i < rows; ++i) {
+        float* __restrict di = d + i * ld;
+        const float* __restrict ai = args.act + i * ld;
+        if (args.dropout_scale > 0.0f) {
+            const float scale = args.dropout_scale;
+            for (int64_t j = 0; j < cols; ++j) {
+                di[j] = ai[j] > 0.0f ? di[j] * scale : 0.0f;
+            }
+        } else {
+            for (int64_t j = 0; j < cols; ++j) {
+                di[j] = ai[j] > 0.0f ? di[j] : 0.0f;
+            }
+        }
+        if (args.ln_xhat) {
+            const float* __restrict xi = args.ln_xhat + i * ld;
+            float sum = 0.0f;
+            float dot = 0.0f;
+            for (int64_t j = 0; j < cols; ++j) {
+                args.ln_dgamma[j] += di[j] * xi[j];
+                args.ln_dbeta[j] += di[j];
+                di[j] *= args.ln_gamma[j];
+                sum += di[j];
+                dot += di[j] * xi[j];
+            }
+            const float mean_sum = sum * inv_cols;
+            const float mean_dot = dot * inv_cols;
+            for (int64_t j = 0; j < cols; ++j) {
+                di[j] = args.ln_istd[i] * (di[j] - mean_sum - xi[j] * mean_dot);
+            }
+        }
+        if (args.bn_xhat) {
+            const float* __restrict xi = args.bn_xhat + i * ld;
+            for (int64_t j = 0; j < cols; ++j) {
+                args.bn_dgamma[j] += di[j] * xi[j];
+                args.bn_dbeta[j] += di[j];
+                di[j] *= args.bn_gamma[j];
+                args.bn_sum[j] += di[j];
+                args.bn_dot[j] += di[j] * xi[j];
+            }
+        }
+    }
+    if (!args.bn_xhat) {
+        return;
+    }
+    const float inv_rows = 1.0f / static_cast<float>(rows);
+    for (int64_t i = 0; i < rows; ++i) {
+        float* __restrict di = d + i * ld;
+        const float* __restrict xi = args.bn_xhat + i * ld;
+        for (int64_t j = 0; j < cols; ++j) {
+            di[j] = args.bn_istd[j] * (di[j] - args.bn_sum[j] * inv_rows - xi[j] * args.bn_dot[j] * inv_rows);
+        }
+    }
+}
+
+void FoldBatchNorm(int64_t in, int64_t out, int64_t ld, const float* weight, const float* bias, const float* gamma,
+                   const float* beta, const float* running_mean, const float* running_var, float* folded_weight,
+                   float* folded_bias) {
+    // folded_bias 先暂存每列的缩放系数
+    float* scale = folded_bias;
+    for (int64_t j = 0; j < out; ++j) {
+        scale[j] = gamma[j] / std::sqrt(running_var[j] + NORM_EPS);
+    }
+    for (int64_t p = 0; p < in; ++p) {
+        const float* __restrict wp = weight + p * ld;
+        float* __restrict fp = folded_weight + p * ld;
+        for (int64_t j = 0; j < out; ++j) {
+            fp[j] = wp[j] * scale[j];
+        }
+    }
+    for (int64_t j = 0; j < out; ++j) {
+        folded_bias[j] = (bias[j] - running_mean[j]) * scale[j] + beta[j];
+    }
+}
+
+namespace {
+
+// 量化和稀疏内核主体, 内联进下面不同目标 ISA 的包装函数后由编译器分别向量化
+REGDB_KERNEL_BODY void QuantizeActivationsBody(int64_t count, const float* x, float scale, uint8_t* q) {
+    const float inv = scale > 0.0f ? 1.0f / scale : 0.0f;
+    for (int64_t i = 0; i < count; ++i) {
+        const float v = std::min(127.0f, std::max(-127.0f, std::nearbyint(x[i] * inv)));
+        q[i] = static_cast<uint8_t>(static_cast<int32_t>(v) + 128);
+    }
+}
+
+REGDB_KERNEL_BODY void LinearInt8Body(int64_t rows, int64_t in, int64_t out, const uint8_t* q, float x_scale,
+                                      const int8_t* weight, const int32_t* weight_sum, const float* weight_scale,
+                                      const float* bias, float* z) {
+    for (int64_t i = 0; i < rows; ++i) {
+        const uint8_t* __restrict qi = q + i * in;
+        float* __restrict zi = z + i * out;
+        for (int64_t j = 0; j < out; ++j) {
+            const int8_t* __restrict wj = weight + j * in;
+            int32_t acc = 0;
+            for (int64_t p = 0; p < in; ++p) {
+                acc += static_cast<int32_t>(qi[p]) * static_cast<int32_t>(wj[p]);
+            }
+            // 减去 128 偏移的贡献后还原为对称量化的点积
+            zi[j] = static_cast<float>(acc - 128 * weight_sum[j]) * x_scale * weight_scale[j] + bias[j];
+        }
+    }
+}
+
+REGDB_KERNEL_BODY float Bf16ToFloat(uint16_t value) {
+    const uint32_t bits = static_cast<uint32_t>(value) << 16;
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+REGDB_KERNEL_BODY void LinearBf16Body(int64_t rows, int64_t in, int64_t out, const float* x, const uint16_t* weight,
+                                      const float* bias, float* z) {
+    for (int64_t i = 0; i < rows; ++i) {
+        std::copy(bias, bias + out, z + i * out);
+    }
+    // 与 GemmAxpy 相同的分块; 每个权重块先展开为 fp32 放在线程局部的面板中, 再供全部输入行复用,
+    // 展开的开销摊到整批行上, 从内存读取的仍是 bf16
+    thread_local std::vector<float> panel(BLOCK_K * BLOCK_N);
+    for (int64_t k0 = 0; k0 < in; k0 += BLOCK_K) {
+        const auto k1 = std::min(in, k0 + BLOCK_K);
+        for (int64_t j0 = 0; j0 < out; j0 += BLOCK_N) {
+            const auto nb = std::min(out, j0 + BLOCK_N) - j0;
+            for (int64_t p = k0; p < k1; ++p) {
+                const uint16_t* __restrict wp = weight + p * out + j0;
+                float* __restrict pp = panel.data() + (p - k0) * nb;
+                for (int64_t j = 0; j < nb; ++j) {
+                    pp[j] = Bf16ToFloat(wp[j]);
+                }
+            }
+            int64_t i = 0;
+            for (; i + 4 <= rows; i += 4) {
+                float* __restrict z0 = z + (i + 0) * out + j0;
+                float* __restrict z1 = z + (i + 1) * out + j0;
+                float* __restrict z2 = z + (i + 2) * out + j0;
+                float* __restrict z3 = z + (i + 3) * out + j0;
+                for (int64_t p = k0; p < k1; ++p) {
+                    const float* __restrict bp = panel.data() + (p - k0) * nb;
+                    const float a0 = x[(i + 0) * in + p];
+                    const float a1 = x[(i + 1) * in + p];
+                    const float a2 = x[(i + 2) * in + p];
+                    const float a3 = x[(i + 3) * in + p];
+                    for (int64_t j = 0; j < nb; ++j) {
+                        const float bv = bp[j];
+                        z0[j] += a0 * bv;
+                        z1[j] += a1 * bv;
+                        z2[j] += a2 * bv;
+                        z3[j] += a3 * bv;
+                    }
+                }
+            }
+            for (; i < rows; ++i) {
+                float* __restrict zi = z + i * out + j0;
+                for (int64_t p = k0; p < k1; ++p) {
+                    const float* __restrict bp = panel.data() + (p - k0) * nb;
+                    const float av = x[i * in + p];
+                    for (int64_t j = 0; j < nb; ++j) {
+                        zi[j] += av * bp[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+REGDB_KERNEL_BODY void LinearBlockSparseBody(int64_t rows, int64_t in, int64_t out, const float* x,
+                                             const int32_t* row_start, const int32_t* block_col, const float* values,
+                                             const float* bias, float* z) {
+    for (int64_t i = 0; i < rows; ++i) {
+        std::copy(bias, bias + out, z + i * out);
+    }
+    // 一次处理 4 行输入, 每个非零块读一次供 4 行复用; 完整的块长度固定, 编译器展开为整向量的 FMA
+    int64_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        float* __restrict z0 = z + (i + 0) * out;
+        float* __restrict z1 = z + (i + 1) * out;
+        float* __restrict z2 = z + (i + 2) * out;
+        float* __restrict z3 = z + (i + 3) * out;
+        for (int64_t p = 0; p < in; ++p) {
+            const float a0 = x[(i + 0) * in + p];
+            const float a1 = x[(i + 1) * in + p];
+            const float a2 = x[(i + 2) * in + p];
+            const float a3 = x[(i + 3) * in + p];
+            for (int32_t b = row_start[p]; b < row_start[p + 1]; ++b) {
+                const int64_t j0 = static_cast<int64_t>(block_col[b]) * SPARSE_BLOCK;
+                const float* __restrict v = values + static_cast<int64_t>(b) * SPARSE_BLOCK;
+                if (j0 + SPARSE_BLOCK <= out) {
+                    for (int64_t j = 0; j < SPARSE_BLOCK; ++j) {
+                        z0[j0 + j] += a0 * v[j];
+                        z1[j0 + j] += a1 * v[j];
+                        z2[j0 + j] += a2 * v[j];
+                        z3[j0 + j] += a3 * v[j];
+                    }
+                    continue;
+                }
+                for (int64_t j = 0; j < out - j0; ++j) {
+                    z0[j0 + j] += a0 * v[j];
+                    z1[j0 + j] += a1 * v[j];
+                    z2[j0 + j] += a2 * v[j];
+                    z3[j0 + j] += a3 * v[j];
+                }
+            }
+        }
+    }
+    for (; i < rows; ++i) {
+        float* __restrict zi = z + i * out;
+        for (int64_t p = 0; p < in; ++p) {
+            const float av = x[i * in + p];
+            for (int32_t b = row_start[p]; b < row_start[p + 1]; ++b) {
+                const int64_t j0 = static_cast<int64_t>(block_col[b]) * SPARSE_BLOCK;
+                const float* __restrict v = values + static_cast<int64_t>(b) * SPARSE_BLOCK;
+                const auto width = std::min(SPARSE_BLOCK, out - j0);
+                for (int64_t j = 0; j < width; ++j) {
+                    zi[j0 + j] += av * v[j];
+                }
+            }
+        }
+    }
+}
+
+#ifdef REGDB_FIXED_WIDTH
+// 各目标 ISA 下分别对应 xmm / ymm / zmm 寄存器
+typedef float Float4 __attribute__((vector_size(16)));
+typedef float Float8 __attribute__((vector_size(32)));
+typedef float Float16 __attribute__((vector_size(64)));
+
+// 输出宽度固定的线性层的一个行块: ROWS 行 x VECS 个向量的累加器整块留在寄存器中, 扫过 in 行权重之后写回一次.
+// 列块数 OUT / (VECS * lanes) 是编译期常量, 循环完全展开, 没有列的余数处理. 行跨度 ldx / ldw / ldz 在连续存储时
+// 分别为 in / OUT / OUT, 堆叠的模型按 trial 取列块时更大
+template <class Vec, int64_t VECS, int64_t ROWS, int64_t OUT>
+REGDB_KERNEL_BODY void LinearFixedTile(int64_t i, int64_t in, const float* x, int64_t ldx, const float* weight,
+                                       int64_t ldw, const float* bias, float* z, int64_t ldz) {
+    constexpr int64_t LANES = static_cast<int64_t>(sizeof(Vec) / sizeof(float));
+    constexpr int64_t TILE = VECS * LANES;
+    static_assert(OUT % TILE == 0, "fixed width must be a multiple of the column tile");
+    const float* xi = x + i * ldx;
+    for (int64_t j0 = 0; j0 < OUT; j0 += TILE) {
+        Vec acc[ROWS][VECS];
+        for (int64_t v = 0; v < VECS; ++v) {
+            Vec b;
+            std::memcpy(&b, bias + j0 + v * LANES, sizeof(Vec));
+            for (int64_t r = 0; r < ROWS; ++r) {
+                acc[r][v] = b;
+            }
+        }
+        for (int64_t p = 0; p < in; ++p) {
+            const float* wp = weight + p * ldw + j0;
+            Vec w[VECS];
+            for (int64_t v = 0; v < VECS; ++v) {
+                std::memcpy(&w[v], wp + v * LANES, sizeof(Vec));
+            }
+            for (int64_t r = 0; r < ROWS; ++r) {
+                const Vec a = Vec{} + xi[r * ldx + p];
+                for (int64_t v = 0; v < VECS; ++v) {
+                    acc[r][v] += a * w[v];
+                }
+            }
+        }
+        for (int64_t r = 0; r < ROWS; ++r) {
+            for (int64_t v = 0; v < VECS; ++v) {
+                std::memcpy(z + (i + r) * ldz + j0 + v * LANES, &acc[r][v], sizeof(Vec));
+            }
+        }
+    }
+}
+
+// 每次 4 行, 不足 4 行的尾部逐行计算
+template <class Vec, int64_t VECS, int64_t OUT>
+REGDB_KERNEL_BODY void LinearFixedBody(int64_t rows, int64_t in, const float* x, int64_t ldx, const float* weight,
+                                       int64_t ldw, const float* bias, float* z, int64_t ldz) {
+    constexpr int64_t ROWS = 4;
+    int64_t i = 0;
+    for (; i + ROWS <= rows; i += ROWS) {
+        LinearFixedTile<Vec, VECS, ROWS, OUT>(i, in, x, ldx, weight, ldw, bias, z, ldz);
+    }
+    for (; i < rows; ++i) {
+        LinearFixedTile<Vec, VECS, 1, OUT>(i, in, x, ldx, weight, ldw, bias, z, ldz);
+    }
+}
+
+constexpr int64_t FIXED_WIDTHS[] = {64, 128, 256, 512};
+constexpr size_t FIXED_WIDTH_COUNT = sizeof(FIXED_WIDTHS) / sizeof(FIXED_WIDTHS[0]);
+
+int64_t FixedWidthIndex(int64_t out) {
+    for (size_t w = 0; w < FIXED_WIDTH_COUNT; ++w) {
+        if (FIXED_WIDTHS[w] == out) {
+            return static_cast<int64_t>(w);
+        }
+    }
+    return -1;
+}
+
+struct DenseKernels {
+    const char* isa;
+    void (*linear[FIXED_WIDTH_COUNT])(int64_t, int64_t, const float*, int64_t, const float*, int64_t, const float*,
+                                      float*, int64_t);
+};
+
+// 累加器: 通用版本 4 x 2 个 xmm, AVX2 4 x 2 个 ymm, AVX-512 4 x 4 个 zmm, 都给权重和广播留出寄存器
+#define REGDB_DENSE_KERNELS(SUFFIX, TARGET, VEC, VECS)                                                            \
+    TARGET void LinearFixed64##SUFFIX(int64_t rows, int64_t in, const float* x, int64_t ldx,                      \
+                                      const float* weight, int64_t ldw, const float* bias, float* z,              \
+                                      int64_t ldz) {                                                              \
+        LinearFixedBody<VEC, VECS, 64>(rows, in, x, ldx, weight, ldw, bias, z, ldz);                              \
+    }                                                                                                             \
+    TARGET void LinearFixed128##SUFFIX(int64_t rows, int64_t in, const float* x, int64_t ldx,                     \
+                                       const float* weight, int64_t ldw, const float* bias, float* z,             \
+                                       int64_t ldz) {                                                             \
+        LinearFixedBody<VEC, VECS, 128>(rows, in, x, ldx, weight, ldw, bias, z, ldz);                             \
+    }                                                                                                             \
+    TARGET void LinearFixed256##SUFFIX(int64_t rows, int64_t in, const float* x, int64_t ldx,                     \
+                                       const float* weight, int64_t ldw, const float* bias, float* z,             \
+                                       int64_t ldz) {                                                             \
+        LinearFixedBody<VEC, VECS, 256>(rows, in, x, ldx, weight, ldw, bias, z, ldz);                             \
+    }                                                                                                             \
+    TARGET void LinearFixed512##SUFFIX(int64_t rows, int64_t in, const float* x, int64_t ldx,                     \
+                                       const float* weight, int64_t ldw, const float* bias, float* z,             \
+                                       int64_t ldz) {                                                             \
+        LinearFixedBody<VEC, VECS, 512>(rows, in, x, ldx, weight, ldw, bias, z, ldz);                             \
+    }
+
+REGDB_DENSE_KERNELS(Generic, , Float4, 2)
+#ifdef REGDB_X86_DISPATCH
+REGDB_DENSE_KERNELS(Avx2, __attribute__((target("avx2,fma"))), Float8, 2)
+REGDB_DENSE_KERNELS(Avx512, __attribute__((target("avx512f,fma"))), Float16, 4)
+#endif
+
+const DenseKernels& SelectDenseKernels() {
+    static const DenseKernels kernels = []() -> DenseKernels {
+#ifdef REGDB_X86_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return {"avx512", {LinearFixed64Avx512, LinearFixed128Avx512, LinearFixed256Avx512,
+                               LinearFixed512Avx512}};
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return {"avx2", {LinearFixed64Avx2, LinearFixed128Avx2, LinearFixed256Avx2, LinearFixed512Avx2}};
+        }
+#endif
+        return {"generic", {LinearFixed64Generic, LinearFixed128Generic, LinearFixed256Generic,
+                            LinearFixed512Generic}};
+    }();
+    return kernels;
+}
+#endif
+
+struct CompressedKernels {
+    const char* isa;
+    void (*quantize)(int64_t, const float*, float, uint8_t*);
+    void (*linear_int8)(int64_t, int64_t, int64_t, const uint8_t*, float, const int8_t*, const int32_t*,
+                        const float*, const float*, float*);
+    void (*linear_bf16)(int64_t, int64_t, int64_t, const float*, const uint16_t*, const float*, float*);
+    void (*linear_sparse)(int64_t, int64_t, int64_t, const float*, const int32_t*, const int32_t*, const float*,
+                          const float*, float*);
+};
+
+#define REGDB_COMPRESSED_KERNELS(SUFFIX, TARGET)                                                                   \
+    TARGET void QuantizeActivations##SUFFIX(int64_t count, const float* x, float scale, uint8_t* q) {             \
+        QuantizeActivationsBody(count, x, scale, q);                                                              \
+    }                                                                                                             \
+    TARGET void LinearInt8##SUFFIX(int64_t rows, int64_t in, int64_t out, const uint8_t* q, float x_scale,         \
+                                   const int8_t* weight, const int32_t* weight_sum, const float* weight_scale,    \
+                                   const float* bias, float* z) {                                                 \
+        LinearInt8Body(rows, in, out, q, x_scale, weight, weight_sum, weight_scale, bias, z);                     \
+    }                                                                                                             \
+    TARGET void LinearBf16##SUFFIX(int64_t rows, int64_t in, int64_t out, const float* x, const uint16_t* weight,  \
+                                   const float* bias, float* z) {                                                 \
+        LinearBf16Body(rows, in, out, x, weight, bias, z);                                                        \
+    }                                                                                                             \
+    TARGET void LinearBlockSparse##SUFFIX(int64_t rows, int64_t in, int64_t out, const float* x,                  \
+                                          const int32_t* row_start, const int32_t* block_col,                     \
+                                          const float* values, const float* bias, float* z) {                     \
+        LinearBlockSparseBody(rows, in, out, x, row_start, block_col, values, bias, z);                           \
+    }
+
+REGDB_COMPRESSED_KERNELS(Generic, )
+#ifdef REGDB_X86_DISPATCH
+REGDB_COMPRESSED_KERNELS(Avx2, __attribute__((target("avx2,fma"))))
+REGDB_COMPRESSED_KERNELS(Avx512, __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni,fma"))))
+#endif
+
+// 第一次调用时检测一次 CPU, 不支持的指令集回退到较低的版本
+const CompressedKernels& SelectCompressedKernels() {
+    static const CompressedKernels kernels = []() -> CompressedKernels {
+#ifdef REGDB_X86_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512vnni")) {
+            return {"avx512_vnni", QuantizeActivationsAvx512, LinearInt8Avx512, LinearBf16Avx512,
+                    LinearBlockSparseAvx512};
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return {"avx2", QuantizeActivationsAvx2, LinearInt8Avx2, LinearBf16Avx2,
+                    LinearBlockSparseAvx2};
+        }
+#endif
+        return {"generic", QuantizeActivationsGeneric, LinearInt8Generic, LinearBf16Generic,
+                LinearBlockSparseGeneric};
+    }();
+    return kernels;
+}
+
+} // namespace
+
+const char* DenseKernelIsa() {
+#ifdef REGDB_FIXED_WIDTH
+    return SelectDenseKernels().isa;
+#else
+    return "none";
+#endif
+}
+
+bool IsFixedWidth(int64_t out) {
+#ifdef REGDB_FIXED_WIDTH
+    return FixedWidthIndex(out) >= 0;
+#else
+    return false;
+#endif
+}
+
+void Linear(int64_t rows, int64_t in, int64_t out, const float* x, const float* weight, const float* bias, float* z) {
+    Linear(rows, in, out, x, in, weight, out, bias, z, out);
+}
+
+void Linear(int64_t rows, int64_t in, int64_t out, const float* x, int64_t ldx, const float* weight, int64_t ldw,
+            const float* bias, float* z, int64_t ldz) {
+#ifdef REGDB_FIXED_WIDTH
+    const auto index = FixedWidthIndex(out);
+    if (index >= 0) {
+        SelectDenseKernels().linear[index](rows, in, x, ldx, weight, ldw, bias, z, ldz);
+        return;
+    }
+#endif
+    LinearGemm(rows, in, out, x, ldx, weight, ldw, bias, z, ldz);
+}
+
+const char* QuantizedKernelIsa() {
+    return SelectCompressedKernels().isa;
+}
+
+void QuantizeActivations(int64_t count, const float* x, float scale, uint8_t* q) {
+    SelectCompressedKernels().quantize(count, x, scale, q);
+}
+
+void LinearInt8(int64_t rows, int64_t in, int64_t out, const uint8_t* q, float x_scale, const int8_t* weight,
+                const int32_t* weight_sum, const float* weight_scale, const float* bias, float* z) {
+    SelectCompressedKernels().linear_int8(rows, in, out, q, x_scale, weight, weight_sum, weight_scale, bias, z);
+}
+
+void LinearBf16(int64_t rows, int64_t in, int64_t out, const float* x, const uint16_t* weight, const float* bias,
+                float* z) {
+    SelectCompressedKernels().linear_bf16(rows, in, out, x, weight, bias, z);
+}
+
+void LinearBlockSparse(int64_t rows, int64_t in, int64_t out, const float* x, const int32_t* row_start,
+                       const int32_t* block_col, const float* values, const float* bias, float* z) {
+    SelectCompressedKernels().linear_sparse(rows, in, out, x, row_start, block_col, values, bias, z);
+}
+
+double MseLoss(int64_t rows, const float* pred, int64_t ld, const float* y, float* dpred) {
+    const float inv_rows = 1.0f / static_cast<float>(rows);
+    double loss = 0.0;
+    for (int64_t i = 0; i < rows; ++i) {
+        const float diff = pred[i * ld] - y[i];
+        loss += static_cast<double>(diff) * diff;
+        if (dpred) {
+            dpred[i * ld] = 2.0f * diff * inv_rows;
+        }
+    }
+    return loss;
+}
+
+double SoftmaxCrossEntropy(int64_t rows, int64_t classes, const float* logits, int64_t ld, const float* y,
+                           float* dlogits) {
+    const float inv_rows = 1.0f / static_cast<float>(rows);
+    double loss = 0.0;
+    for (int64_t i = 0; i < rows; ++i) {
+        const float* row = logits + i * ld;
+        const auto label = static_cast<int64_t>(y[i]);
+        if (label < 0 || label >= classes || static_cast<float>(label) != y[i]) {
+            throw std::runtime_error("Classification label must be an integer in [0, out_features).");
+        }
+        const float max = *std::max_element(row, row + classes);
+        float sum = 0.0f;
+        for (int64_t j = 0; j < classes; ++j) {
+            sum += std::exp(row[j] - max);
+        }
+        const float log_sum = max + std::log(sum);
+        loss += log_sum - row[label];
+        if (dlogits) {
+            float* drow = dlogits + i * ld;
+            for (int64_t j = 0; j < classes; ++j) {
+                drow[j] = (std::exp(row[j] - log_sum) - (j == label ? 1.0f : 0.0f)) * inv_rows;
+            }
+        }
+    }
+    return loss;
+}
+
+} // namespace kernels
+} // namespace regdb
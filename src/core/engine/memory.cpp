@@ -0,0 +1,278 @@
+#include "regdb/core/engine/memory.hpp"
+
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace regdb {
+
+namespace {
+
+struct CategoryCounters {
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
+    std::atomic<int64_t> blocks{0};
+};
+
+std::array<CategoryCounters, MEMORY_CATEGORY_COUNT>& Counters() {
+    static std::array<CategoryCounters, MEMORY_CATEGORY_COUNT> counters;
+    return counters;
+}
+
+void Track(MemoryCategory category, int64_t bytes, int64_t blocks) {
+    auto& counter = Counters()[static_cast<size_t>(category)];
+    const auto current = counter.bytes.fetch_add(bytes) + bytes;
+    counter.blocks.fetch_add(blocks);
+    auto peak = counter.peak_bytes.load();
+    while (current > peak && !counter.peak_bytes.compare_exchange_weak(peak, current)) {
+    }
+}
+
+// 默认后端: 进程堆, 不可换出
+class HeapBlock : public MemoryBlock {
+public:
+    HeapBlock(MemoryCategory category, int64_t bytes)
+        : MemoryBlock(category, bytes), storage_(new uint8_t[bytes]) {}
+
+    uint8_t* Data() override { return storage_.get(); }
+
+private:
+    std::unique_ptr<uint8_t[]> storage_;
+};
+
+std::mutex backend_lock;
+std::shared_ptr<MemoryBackend> backend;
+
+// 没有 HeapCounter 存活时 operator new 只多读一次 heap_counters
+std::atomic<int64_t> heap_counters{0};
+std::atomic<int64_t> heap_allocations{0};
+
+void CountHeapAllocation() {
+    if (heap_counters.load(std::memory_order_relaxed) > 0) {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+HeapCounter::HeapCounter() {
+    heap_counters.fetch_add(1);
+    begin_ = heap_allocations.load();
+}
+
+HeapCounter::~HeapCounter() {
+    heap_counters.fetch_sub(1);
+}
+
+int64_t HeapCounter::Count() const {
+    return heap_allocations.load() - begin_;
+}
+
+std::string MemoryCategoryToString(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::DATASET:
+            return "dataset";
+        case MemoryCategory::WEIGHTS:
+            return "weights";
+        case MemoryCategory::WORKSPACE:
+            return "workspace";
+        case MemoryCategory::OPTIMIZER:
+            return "optimizer";
+        case MemoryCategory::CACHE:
+            return "cache";
+        case MemoryCategory::POOL:
+            return "pool";
+    }
+    return "unknown";
+}
+
+MemoryBlock::MemoryBlock(MemoryCategory category, int64_t bytes) : category_(category), bytes_(bytes) {
+    Track(category_, bytes_, 1);
+}
+
+MemoryBlock::~MemoryBlock() {
+    Track(category_, -bytes_, -1);
+}
+
+void MemoryBlock::SetCategory(MemoryCategory category) {
+    if (category == category_) {
+        return;
+    }
+    Track(category_, -bytes_, -1);
+    category_ = category;
+    Track(category_, bytes_, 1);
+}
+
+std::unique_ptr<MemoryBlock> Memory::Allocate(MemoryCategory category, int64_t bytes) {
+    std::shared_ptr<MemoryBackend> current;
+    {
+        std::lock_guard<std::mutex> guard(backend_lock);
+        current = backend;
+    }
+    if (current) {
+        return current->Allocate(category, bytes);
+    }
+    return std::make_unique<HeapBlock>(category, bytes);
+}
+
+void Memory::SetBackend(std::shared_ptr<MemoryBackend> value) {
+    std::lock_guard<std::mutex> guard(backend_lock);
+    backend = std::move(value);
+}
+
+void Memory::ResetBackend(const MemoryBackend* value) {
+    std::lock_guard<std::mutex> guard(backend_lock);
+    if (backend.get() == value) {
+        backend.reset();
+    }
+}
+
+std::vector<MemoryUsage> Memory::Report() {
+    std::vector<MemoryUsage> report;
+    for (int64_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+        const auto& counter = Counters()[i];
+        MemoryUsage usage;
+        usage.category = static_cast<MemoryCategory>(i);
+        usage.bytes = counter.bytes.load();
+        usage.peak_bytes = counter.peak_bytes.load();
+        usage.blocks = counter.blocks.load();
+        report.push_back(usage);
+    }
+    return report;
+}
+
+} // namespace regdb
+
+// 替换全局 operator new / delete, 除计数外与默认实现相同
+namespace {
+
+void* AllocateHeap(std::size_t size) {
+    regdb::CountHeapAllocation();
+    while (true) {
+        if (auto* p = std::malloc(size == 0 ? 1 : size)) {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* AllocateAlignedHeap(std::size_t size, std::align_val_t alignment) {
+    regdb::CountHeapAllocation();
+    const auto align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+    while (true) {
+        void* p = nullptr;
+        if (posix_memalign(&p, align, size == 0 ? 1 : size) == 0) {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return AllocateHeap(size);
+}
+
+void* operator new[](std::size_t size) {
+    return AllocateHeap(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return AllocateHeap(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return AllocateHeap(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return AllocateAlignedHeap(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return AllocateAlignedHeap(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return AllocateAlignedHeap(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return AllocateAlignedHeap(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
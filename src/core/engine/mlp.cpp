@@ -0,0 +1,340 @@
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace regdb {
+
+namespace {
+
+constexpr float BN_MOMENTUM = 0.1f;
+// dropout 计数器的高位为层号, 每层可用 2^40 个计数器
+constexpr int DROPOUT_LAYER_SHIFT = 40;
+
+const float* LayerOutput(const LayerShape& layer, const LayerCache& cache) {
+    return layer.skip ? cache.out.data() : cache.act.data();
+}
+
+} // namespace
+
+void MlpWorkspace::Reserve(const Mlp& model, int64_t batch) {
+    if (batch <= capacity_ && layers.size() == static_cast<int64_t>(model.Layers().size())) {
+        return;
+    }
+    arena_ = ArenaPool::Instance().Acquire(Bytes(model, batch), MemoryCategory::WORKSPACE);
+    Bind(model, batch, *arena_);
+}
+
+int64_t MlpWorkspace::Bytes(const Mlp& model, int64_t batch) {
+    Arena measure;
+    MlpWorkspace ws;
+    ws.Bind(model, batch, measure);
+    return measure.Used();
+}
+
+void MlpWorkspace::Bind(const Mlp& model, int64_t batch, Arena& arena) {
+    const auto& config = model.Config();
+    const auto count = static_cast<int64_t>(model.Layers().size());
+    layers = arena.Allocate<LayerCache>(count);
+    pack_floats_ = 0;
+    for (int64_t l = 0; l < count; ++l) {
+        const auto& layer = model.Layers()[l];
+        pack_floats_ = std::max(pack_floats_, layer.in * layer.out);
+        LayerCache cache;
+        if (layer.hidden) {
+            const auto size = batch * layer.out;
+            cache.z = arena.Allocate<float>(size);
+            cache.act = arena.Allocate<float>(size);
+            if (config.use_bn) {
+                cache.bn_xhat = arena.Allocate<float>(size);
+                cache.bn_mean = arena.Allocate<float>(layer.out);
+                cache.bn_var = arena.Allocate<float>(layer.out);
+                cache.bn_istd = arena.Allocate<float>(layer.out);
+            }
+            if (config.use_ln) {
+                cache.ln_xhat = arena.Allocate<float>(size);
+                cache.ln_istd = arena.Allocate<float>(batch);
+            }
+            if (layer.skip) {
+                cache.out = arena.Allocate<float>(size);
+            }
+        }
+        if (!arena.Measuring()) {
+            new (&layers[l]) LayerCache(cache);
+        }
+    }
+    logits = arena.Allocate<float>(batch * model.Spec().out_features);
+    dlogits = arena.Allocate<float>(batch * model.Spec().out_features);
+    grad_a = arena.Allocate<float>(batch * model.MaxWidth());
+    grad_b = arena.Allocate<float>(batch * model.MaxWidth());
+    x = arena.Allocate<float>(batch * model.Spec().in_features);
+    y = arena.Allocate<float>(batch);
+    folded = config.use_bn ? arena.Allocate<float>(static_cast<int64_t>(model.Parameters().size())) : Span<float>();
+    capacity_ = batch;
+    if (!arena.Measuring()) {
+        ReserveThreadScratch();
+    }
+}
+
+void MlpWorkspace::ReserveThreadScratch() const {
+    kernels::ReservePackScratch(pack_floats_);
+}
+
+void MlpWorkspace::FoldBatchNorm(const Mlp& model) {
+    if (!model.Config().use_bn) {
+        return;
+    }
+    const float* params = model.Parameters().data();
+    const float* buffers = model.Buffers().data();
+    for (const auto& layer : model.Layers()) {
+        if (!layer.hidden) {
+            continue;
+        }
+        kernels::FoldBatchNorm(layer.in, layer.out, layer.out, params + layer.weight, params + layer.bias,
+                               params + layer.bn_gamma, params + layer.bn_beta, buffers + layer.running_mean,
+                               buffers + layer.running_var, folded.data() + layer.weight, folded.data() + layer.bias);
+    }
+}
+
+Mlp::Mlp(const ModelSpec& spec, const RegConfig& config, uint64_t seed) : spec_(spec), config_(config) {
+    auto in = spec.in_features;
+    max_width_ = std::max(spec.in_features, spec.out_features);
+    for (size_t l = 0; l <= spec.hidden_features.size(); ++l) {
+        LayerShape layer;
+        layer.in = in;
+        layer.hidden = l < spec.hidden_features.size();
+        layer.out = layer.hidden ? spec.hidden_features[l] : spec.out_features;
+        layer.skip = layer.hidden && (config.use_skip || spec.residual) && layer.in == layer.out;
+
+        const auto prefix = "layers." + std::to_string(l) + ".";
+        layer.weight = AddSlot(prefix + "weight", layer.in * layer.out, true);
+        layer.bias = AddSlot(prefix + "bias", layer.out, false);
+        if (layer.hidden && config.use_bn) {
+            layer.bn_gamma = AddSlot(prefix + "bn.weight", layer.out, false);
+            layer.bn_beta = AddSlot(prefix + "bn.bias", layer.out, false);
+            layer.running_mean = static_cast<int64_t>(buffers_.size());
+            buffers_.resize(buffers_.size() + layer.out, 0.0f);
+            layer.running_var = static_cast<int64_t>(buffers_.size());
+            buffers_.resize(buffers_.size() + layer.out, 1.0f);
+        }
+        if (layer.hidden && config.use_ln) {
+            layer.ln_gamma = AddSlot(prefix + "ln.weight", layer.out, false);
+            layer.ln_beta = AddSlot(prefix + "ln.bias", layer.out, false);
+        }
+        layers_.push_back(layer);
+        max_width_ = std::max(max_width_, layer.out);
+        in = layer.out;
+    }
+
+    const auto total = slots_.back().offset + slots_.back().size;
+    params_.assign(total, 0.0f);
+    grads_.assign(total, 0.0f);
+
+    // 隐藏层 He 均匀初始化, 输出层 1/sqrt(in)
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    for (const auto& layer : layers_) {
+        const float bound = layer.hidden ? std::sqrt(6.0f / static_cast<float>(layer.in))
+                                         : 1.0f / std::sqrt(static_cast<float>(layer.in));
+        std::uniform_real_distribution<float> dist(-bound, bound);
+        float* weight = params_.data() + layer.weight;
+        for (int64_t i = 0; i < layer.in * layer.out; ++i) {
+            weight[i] = dist(rng);
+        }
+        if (layer.bn_gamma >= 0) {
+            std::fill_n(params_.data() + layer.bn_gamma, layer.out, 1.0f);
+        }
+        if (layer.ln_gamma >= 0) {
+            std::fill_n(params_.data() + layer.ln_gamma, layer.out, 1.0f);
+        }
+    }
+}
+
+int64_t Mlp::AddSlot(const std::string& name, int64_t size, bool decay) {
+    const auto offset = slots_.empty() ? int64_t(0) : slots_.back().offset + slots_.back().size;
+    slots_.push_back({name, offset, size, decay});
+    return offset;
+}
+
+void Mlp::Forward(const float* x, int64_t batch, bool training, MlpWorkspace& ws, std::mt19937& rng,
+                  bool update_stats) {
+    ws.Reserve(*this, batch);
+    // 评估时 BN 折叠进 Linear; 参数可能在两次调用之间被优化器或 SWA 改写, 每次重新折叠
+    const bool fold = config_.use_bn && !training;
+    if (fold) {
+        ws.FoldBatchNorm(*this);
+    }
+    const float* source = fold ? ws.folded.data() : params_.data();
+    // 每次训练前向从 rng 取一个 Philox key, 同一 trial 的结果仍只由种子决定
+    uint64_t dropout_key = 0;
+    if (config_.use_dropout && training) {
+        dropout_key = (static_cast<uint64_t>(rng()) << 32) | rng();
+    }
+    const float* input = x;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& layer = layers_[l];
+        if (!layer.hidden) {
+            kernels::Linear(batch, layer.in, layer.out, input, params_.data() + layer.weight,
+                            params_.data() + layer.bias, ws.logits.data());
+            break;
+        }
+        // 折叠只覆盖隐藏层
+        const float* weight = source + layer.weight;
+        const float* bias = source + layer.bias;
+
+        auto& cache = ws.layers[l];
+        float* z = cache.z.data();
+        kernels::Linear(batch, layer.in, layer.out, input, weight, bias, z);
+
+        kernels::NormActForwardArgs args;
+        args.act = cache.act.data();
+        if (config_.use_bn && training) {
+            kernels::BatchNormStatistics(batch, layer.out, layer.out, z, cache.bn_mean.data(), cache.bn_var.data(),
+                                         cache.bn_istd.data(),
+                                         update_stats ? buffers_.data() + layer.running_mean : nullptr,
+                                         update_stats ? buffers_.data() + layer.running_var : nullptr, BN_MOMENTUM);
+            args.bn_mean = cache.bn_mean.data();
+            args.bn_istd = cache.bn_istd.data();
+            args.bn_gamma = params_.data() + layer.bn_gamma;
+            args.bn_beta = params_.data() + layer.bn_beta;
+            args.bn_xhat = cache.bn_xhat.data();
+        }
+        if (config_.use_ln) {
+            args.ln_gamma = params_.data() + layer.ln_gamma;
+            args.ln_beta = params_.data() + layer.ln_beta;
+            args.ln_xhat = training ? cache.ln_xhat.data() : nullptr;
+            args.ln_istd = cache.ln_istd.data();
+        }
+        if (config_.use_dropout && training) {
+            // 每层使用独立的计数器区间, 掩码在融合内核内现场生成
+            args.dropout_rate = config_.dropout_rate;
+            args.dropout_key = dropout_key;
+            args.dropout_counter = static_cast<uint64_t>(l) << DROPOUT_LAYER_SHIFT;
+        }
+        if (layer.skip) {
+            args.skip = input;
+            args.out = cache.out.data();
+        }
+        kernels::NormActForward(batch, layer.out, layer.out, z, args);
+        input = LayerOutput(layer, cache);
+    }
+}
+
+void Mlp::Backward(const float* x, int64_t batch, MlpWorkspace& ws) {
+    Backward(x, batch, ws, grads_.data());
+}
+
+void Mlp::Backward(const float* x, int64_t batch, MlpWorkspace& ws, float* grads) {
+    std::fill(grads, grads + params_.size(), 0.0f);
+    float* d = ws.grad_a.data();
+    float* d_next = ws.grad_b.data();
+
+    for (auto l = static_cast<int64_t>(layers_.size()) - 1; l >= 0; --l) {
+        const auto& layer = layers_[l];
+        const float* input = l > 0 ? LayerOutput(layers_[l - 1], ws.layers[l - 1]) : x;
+        const float* weight = params_.data() + layer.weight;
+        float* dweight = grads + layer.weight;
+        float* dbias = grads + layer.bias;
+
+        // dz: 输出层直接使用 dlogits, 隐藏层就地在 d 上回传
+        float* dz = d;
+        float beta = 0.0f;
+        if (!layer.hidden) {
+            dz = ws.dlogits.data();
+        } else {
+            auto& cache = ws.layers[l];
+            const auto size = batch * layer.out;
+            if (layer.skip) {
+                std::memcpy(d_next, d, sizeof(float) * size);
+                beta = 1.0f;
+            }
+            kernels::NormActBackwardArgs args;
+            args.act = cache.act.data();
+            args.dropout_scale = config_.use_dropout ? 1.0f / (1.0f - config_.dropout_rate) : 0.0f;
+            if (config_.use_ln) {
+                args.ln_xhat = cache.ln_xhat.data();
+                args.ln_istd = cache.ln_istd.data();
+                args.ln_gamma = params_.data() + layer.ln_gamma;
+                args.ln_dgamma = grads + layer.ln_gamma;
+                args.ln_dbeta = grads + layer.ln_beta;
+            }
+            if (config_.use_bn) {
+                args.bn_xhat = cache.bn_xhat.data();
+                args.bn_istd = cache.bn_istd.data();
+                args.bn_gamma = params_.data() + layer.bn_gamma;
+                args.bn_dgamma = grads + layer.bn_gamma;
+                args.bn_dbeta = grads + layer.bn_beta;
+                args.bn_sum = cache.bn_mean.data();
+                args.bn_dot = cache.bn_var.data();
+            }
+            kernels::NormActBackward(batch, layer.out, layer.out, d, args);
+        }
+
+        kernels::Gemm(true, false, layer.in, layer.out, batch, 1.0f, input, layer.in, dz, layer.out,
+                      1.0f, dweight, layer.out);
+        kernels::ColumnSum(batch, layer.out, dz, dbias);
+        if (l > 0) {
+            kernels::Gemm(false, true, batch, layer.in, layer.out, 1.0f, dz, layer.out, weight, layer.out,
+                          beta, d_next, layer.in);
+            std::swap(d, d_next);
+        }
+    }
+}
+
+double Mlp::Loss(const float* logits, const float* y, int64_t batch, float* dlogits) const {
+    if (IsRegression()) {
+        return kernels::MseLoss(batch, logits, 1, y, dlogits);
+    }
+    return kernels::SoftmaxCrossEntropy(batch, spec_.out_features, logits, spec_.out_features, y, dlogits);
+}
+
+double Mlp::TrainStep(const float* x, const float* y, int64_t batch, MlpWorkspace& ws, std::mt19937& rng) {
+    return ShardGradient(x, y, batch, batch, ws, rng, grads_.data(), true) / static_cast<double>(batch);
+}
+
+double Mlp::ShardGradient(const float* x, const float* y, int64_t rows, int64_t batch_rows, MlpWorkspace& ws,
+                          std::mt19937& rng, float* grads, bool update_stats) {
+    Forward(x, rows, true, ws, rng, update_stats);
+    const auto loss = Loss(ws.logits.data(), y, rows, ws.dlogits.data());
+    if (rows != batch_rows) {
+        const float scale = static_cast<float>(rows) / static_cast<float>(batch_rows);
+        for (int64_t i = 0; i < rows * spec_.out_features; ++i) {
+            ws.dlogits[i] *= scale;
+        }
+    }
+    Backward(x, rows, ws, grads);
+    return loss;
+}
+
+double Mlp::EvaluateLoss(const float* x, const float* y, int64_t batch, MlpWorkspace& ws) {
+    std::mt19937 unused;
+    Forward(x, batch, false, ws, unused);
+    return Loss(ws.logits.data(), y, batch, nullptr);
+}
+
+void Mlp::RecomputeBatchNorm(const float* x, int64_t batch, MlpWorkspace& ws) {
+    if (!config_.use_bn || batch <= 0) {
+        return;
+    }
+    std::mt19937 rng(static_cast<uint32_t>(batch));
+    Forward(x, batch, true, ws, rng, false);
+    // 前向留在工作区里的 batch 均值和 (有偏) 方差即为新的统计量
+    const float unbias = batch > 1 ? static_cast<float>(batch) / static_cast<float>(batch - 1) : 1.0f;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& layer = layers_[l];
+        if (!layer.hidden) {
+            continue;
+        }
+        const auto& cache = ws.layers[l];
+        float* running_mean = buffers_.data() + layer.running_mean;
+        float* running_var = buffers_.data() + layer.running_var;
+        for (int64_t j = 0; j < layer.out; ++j) {
+            running_mean[j] = cache.bn_mean[j];
+            running_var[j] = cache.bn_var[j] * unbias;
+        }
+    }
+}
+
+} // namespace regdb
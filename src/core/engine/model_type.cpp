@@ -0,0 +1,166 @@
+#include "regdb/core/engine/model_type.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+std::string Upper(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::toupper(c); });
+    return name;
+}
+
+std::string JoinNames(const std::vector<std::string>& names) {
+    std::string joined;
+    for (size_t i = 0; i < names.size(); ++i) {
+        joined += (i == 0 ? "" : ", ") + names[i];
+    }
+    return joined;
+}
+
+// Linear -> [BN] -> [LN] -> ReLU -> [Dropout] -> [+skip], 残差只在 use_skip 时出现
+struct MlpArch {
+    static constexpr const char* NAME = "MLP";
+    static constexpr const char* DESCRIPTION = "Multi-layer perceptron, skip connections follow use_skip.";
+    static constexpr bool RESIDUAL = false;
+
+    static std::vector<ModelArg> ExtraArgs() { return {}; }
+    static std::vector<std::pair<std::string, bool>> FixedRegFlags() { return {}; }
+    static void Validate(const ModelSpec&) {}
+    static ModelCost Cost(const ModelSpec& spec) { return LinearStackCost(spec); }
+};
+
+// 与 MLP 相同的层, 但 in == out 的隐藏层总有残差连接, use_skip 固定开启、不再参与搜索
+struct ResNetMlpArch {
+    static constexpr const char* NAME = "RESNET_MLP";
+    static constexpr const char* DESCRIPTION = "MLP with a residual connection on every hidden layer as wide as "
+                                               "its input.";
+    static constexpr bool RESIDUAL = true;
+
+    static std::vector<ModelArg> ExtraArgs() { return {}; }
+    static std::vector<std::pair<std::string, bool>> FixedRegFlags() { return {{"use_skip", true}}; }
+
+    static void Validate(const ModelSpec& spec) {
+        auto in = spec.in_features;
+        for (auto width : spec.hidden_features) {
+            if (width == in) {
+                return;
+            }
+            in = width;
+        }
+        throw std::runtime_error("RESNET_MLP needs at least one hidden layer as wide as its input.");
+    }
+
+    static ModelCost Cost(const ModelSpec& spec) {
+        auto cost = LinearStackCost(spec);
+        auto in = spec.in_features;
+        for (auto width : spec.hidden_features) {
+            cost.flops_per_row += width == in ? width : 0;
+            in = width;
+        }
+        return cost;
+    }
+};
+
+} // namespace
+
+const std::vector<ModelArg>& CommonModelArgs() {
+    static const std::vector<ModelArg> args = {
+        {"in_features", true, "number of input features"},
+        {"out_features", true, "1 for regression, otherwise the number of classes"},
+        {"hidden_features", true, "widths of the hidden layers"},
+        {"hogwild", false, "asynchronous updates when training with several threads"},
+        {"folds", false, "k-fold cross validation for each search trial"},
+        {"early_stopping", false, "false, true or {patience, min_delta, extrapolate}"},
+        {"preprocess", false, "true or an object mapping columns to zscore/minmax/onehot/hash"}
+    };
+    return args;
+}
+
+ModelCost LinearStackCost(const ModelSpec& spec) {
+    ModelCost cost;
+    cost.widest = spec.out_features;
+    auto in = spec.in_features;
+    for (auto width : spec.hidden_features) {
+        cost.parameters += (in + 1) * width;
+        cost.flops_per_row += 2 * in * width;
+        cost.widest = std::max(cost.widest, width);
+        in = width;
+    }
+    cost.parameters += (in + 1) * spec.out_features;
+    cost.flops_per_row += 2 * in * spec.out_features;
+    return cost;
+}
+
+void ModelType::CheckArgs(const nlohmann::json& model_args) const {
+    if (!model_args.is_object()) {
+        throw std::runtime_error("model_args of " + Name() + " must be a json object.");
+    }
+    std::vector<std::string> names;
+    for (const auto& arg : Args()) {
+        names.push_back(arg.name);
+        if (arg.required && !model_args.contains(arg.name)) {
+            throw std::runtime_error("Missing key '" + arg.name + "' in model_args of " + Name() + ".");
+        }
+    }
+    for (auto it = model_args.begin(); it != model_args.end(); ++it) {
+        if (std::find(names.begin(), names.end(), it.key()) == names.end()) {
+            throw std::runtime_error("Unknown key '" + it.key() + "' in model_args of " + Name() + ", expected: " +
+                                     JoinNames(names) + ".");
+        }
+    }
+}
+
+ModelTypeRegistry::ModelTypeRegistry() {
+    Register<MlpArch>();
+    Register<ResNetMlpArch>();
+}
+
+ModelTypeRegistry& ModelTypeRegistry::Instance() {
+    static ModelTypeRegistry registry;
+    return registry;
+}
+
+void ModelTypeRegistry::Register(std::unique_ptr<ModelType> type) {
+    std::lock_guard<std::mutex> guard(lock_);
+    const auto name = Upper(type->Name());
+    for (const auto& existing : types_) {
+        if (Upper(existing->Name()) == name) {
+            throw std::runtime_error("Model type '" + type->Name() + "' is already registered.");
+        }
+    }
+    types_.push_back(std::move(type));
+}
+
+const ModelType* ModelTypeRegistry::Find(const std::string& name) const {
+    std::lock_guard<std::mutex> guard(lock_);
+    const auto upper = Upper(name);
+    for (const auto& type : types_) {
+        if (Upper(type->Name()) == upper) {
+            return type.get();
+        }
+    }
+    return nullptr;
+}
+
+const ModelType& ModelTypeRegistry::Get(const std::string& name) const {
+    const auto* type = Find(name);
+    if (!type) {
+        throw std::runtime_error("Unknown model_type '" + name + "', expected one of: " + JoinNames(Names()) + ".");
+    }
+    return *type;
+}
+
+std::vector<std::string> ModelTypeRegistry::Names() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    std::vector<std::string> names;
+    for (const auto& type : types_) {
+        names.push_back(type->Name());
+    }
+    return names;
+}
+
+} // namespace regdb
@@ -0,0 +1,347 @@
+#include "regdb/core/engine/optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace regdb {
+
+namespace {
+
+void AdamUpdate(int64_t count, float* p, const float* g, float* m, float* v, float beta1, float beta2, float eps,
+                float step_size, float inv_sqrt_correction2, float decay) {
+    for (int64_t i = 0; i < count; ++i) {
+        m[i] = beta1 * m[i] + (1.0f - beta1) * g[i];
+        v[i] = beta2 * v[i] + (1.0f - beta2) * g[i] * g[i];
+        p[i] -= decay * p[i];
+        p[i] -= step_size * m[i] / (std::sqrt(v[i]) * inv_sqrt_correction2 + eps);
+    }
+}
+
+// 从 arena 池借两段清零的矩缓冲
+ArenaPool::Handle AcquireMoments(int64_t count, Span<float>& m, Span<float>& v) {
+    Arena measure;
+    measure.Allocate<float>(count);
+    measure.Allocate<float>(count);
+    auto state = ArenaPool::Instance().Acquire(measure.Used(), MemoryCategory::OPTIMIZER);
+    m = state->Allocate<float>(count);
+    v = state->Allocate<float>(count);
+    std::fill(m.begin(), m.end(), 0.0f);
+    std::fill(v.begin(), v.end(), 0.0f);
+    return state;
+}
+
+// slow += alpha * (fast - slow), fast = slow
+void LookaheadUpdate(int64_t count, float* fast, float* slow, float alpha) {
+    for (int64_t i = 0; i < count; ++i) {
+        const float value = slow[i] + alpha * (fast[i] - slow[i]);
+        slow[i] = value;
+        fast[i] = value;
+    }
+}
+
+// 累积平均 average += (value - average) / (n + 1)
+void AverageUpdate(int64_t count, const float* value, float* average, float weight) {
+    for (int64_t i = 0; i < count; ++i) {
+        average[i] += weight * (value[i] - average[i]);
+    }
+}
+
+void SwapRange(int64_t count, float* a, float* b) {
+    for (int64_t i = 0; i < count; ++i) {
+        const float value = a[i];
+        a[i] = b[i];
+        b[i] = value;
+    }
+}
+
+// 按需从 arena 池借慢权重、SWA 平均和 BN 统计量备份, 未开启的部分不分配
+ArenaPool::Handle AcquireAveraging(int64_t params, int64_t buffers, bool lookahead, bool swa, Span<float>& slow,
+                                   Span<float>& average, Span<float>& backup) {
+    if (!lookahead && !swa) {
+        return ArenaPool::Handle();
+    }
+    Arena measure;
+    measure.Allocate<float>(lookahead ? params : 0);
+    measure.Allocate<float>(swa ? params : 0);
+    measure.Allocate<float>(swa ? buffers : 0);
+    auto state = ArenaPool::Instance().Acquire(measure.Used(), MemoryCategory::OPTIMIZER);
+    slow = state->Allocate<float>(lookahead ? params : 0);
+    average = state->Allocate<float>(swa ? params : 0);
+    backup = state->Allocate<float>(swa ? buffers : 0);
+    // 池中的 arena 保留上一个 trial 的内容; 第一次采样 average += 1 * (value - average) 只有从 0 开始才等于 value
+    std::fill(average.begin(), average.end(), 0.0f);
+    return state;
+}
+
+int64_t SwaStartEpoch(int64_t max_epochs) {
+    return static_cast<int64_t>(static_cast<double>(max_epochs) * WeightAveraging::SWA_START);
+}
+
+} // namespace
+
+Adam::Adam(const Mlp& model, float learning_rate) : learning_rate_(learning_rate) {
+    state_ = AcquireMoments(static_cast<int64_t>(model.Parameters().size()), m_, v_);
+}
+
+void Adam::Step(Mlp& model) {
+    BeginStep();
+    StepRange(model, model.Gradients().data(), 0, static_cast<int64_t>(model.Parameters().size()));
+}
+
+void Adam::BeginStep() {
+    ++steps_;
+    const float correction1 = 1.0f - std::pow(beta1_, static_cast<float>(steps_));
+    const float correction2 = 1.0f - std::pow(beta2_, static_cast<float>(steps_));
+    step_size_ = learning_rate_ / correction1;
+    inv_sqrt_correction2_ = 1.0f / std::sqrt(correction2);
+}
+
+void Adam::StepRange(Mlp& model, const float* grads, int64_t begin, int64_t end) {
+    const auto& config = model.Config();
+    float* params = model.Parameters().data();
+    for (const auto& slot : model.Slots()) {
+        // 只更新 slot 与 [begin, end) 的交集
+        const auto first = std::max(begin, slot.offset);
+        const auto last = std::min(end, slot.offset + slot.size);
+        if (first >= last) {
+            continue;
+        }
+        const float decay = config.use_weight_decay && slot.decay ? learning_rate_ * config.weight_decay : 0.0f;
+        AdamUpdate(last - first, params + first, grads + first, m_.data() + first, v_.data() + first, beta1_,
+                   beta2_, eps_, step_size_, inv_sqrt_correction2_, decay);
+    }
+}
+
+void Adam::HogwildStep(Mlp& model, const float* grads, int64_t step, const uint8_t* active_rows) {
+    const float correction1 = 1.0f - std::pow(beta1_, static_cast<float>(step));
+    const float correction2 = 1.0f - std::pow(beta2_, static_cast<float>(step));
+    const float step_size = learning_rate_ / correction1;
+    const float inv_sqrt_correction2 = 1.0f / std::sqrt(correction2);
+    const auto& config = model.Config();
+    const auto& first = model.Layers().front();
+    float* params = model.Parameters().data();
+    for (const auto& slot : model.Slots()) {
+        const float decay = config.use_weight_decay && slot.decay ? learning_rate_ * config.weight_decay : 0.0f;
+        if (active_rows && slot.offset == first.weight) {
+            // 宽输入的第一层类似 embedding 表, 每步只触及少数行
+            for (int64_t row = 0; row < first.in; ++row) {
+                if (!active_rows[row]) {
+                    continue;
+                }
+                const auto offset = slot.offset + row * first.out;
+                AdamUpdate(first.out, params + offset, grads + offset, m_.data() + offset, v_.data() + offset,
+                           beta1_, beta2_, eps_, step_size, inv_sqrt_correction2, decay);
+            }
+            continue;
+        }
+        AdamUpdate(slot.size, params + slot.offset, grads + slot.offset, m_.data() + slot.offset,
+                   v_.data() + slot.offset, beta1_, beta2_, eps_, step_size, inv_sqrt_correction2, decay);
+    }
+}
+
+void Adam::SaveState(std::vector<float>& m, std::vector<float>& v) const {
+    m.assign(m_.begin(), m_.end());
+    v.assign(v_.begin(), v_.end());
+}
+
+void Adam::LoadState(const std::vector<float>& m, const std::vector<float>& v, int64_t steps) {
+    if (static_cast<int64_t>(m.size()) != static_cast<int64_t>(m_.size()) ||
+        static_cast<int64_t>(v.size()) != static_cast<int64_t>(v_.size())) {
+        throw std::runtime_error("Stored optimizer state does not match the model.");
+    }
+    std::copy(m.begin(), m.end(), m_.begin());
+    std::copy(v.begin(), v.end(), v_.begin());
+    steps_ = steps;
+}
+
+StackedAdam::StackedAdam(const StackedMlp& model, float learning_rate) : learning_rate_(learning_rate) {
+    state_ = AcquireMoments(static_cast<int64_t>(model.Parameters().size()), m_, v_);
+}
+
+void StackedAdam::Step(StackedMlp& model) {
+    ++steps_;
+    const float correction1 = 1.0f - std::pow(beta1_, static_cast<float>(steps_));
+    const float correction2 = 1.0f - std::pow(beta2_, static_cast<float>(steps_));
+    const float step_size = learning_rate_ / correction1;
+    const float inv_sqrt_correction2 = 1.0f / std::sqrt(correction2);
+    const auto trials = model.Trials();
+
+    float* params = model.Parameters().data();
+    const float* grads = model.Gradients().data();
+    for (const auto& slot : model.Slots()) {
+        for (int64_t r = 0; r < slot.rows; ++r) {
+            for (int64_t k = 0; k < trials; ++k) {
+                const auto& config = model.Configs()[k];
+                const float decay =
+                    config.use_weight_decay && slot.decay ? learning_rate_ * config.weight_decay : 0.0f;
+                const auto offset = slot.offset + (r * trials + k) * slot.width;
+                AdamUpdate(slot.width, params + offset, grads + offset, m_.data() + offset, v_.data() + offset,
+                           beta1_, beta2_, eps_, step_size, inv_sqrt_correction2, decay);
+            }
+        }
+    }
+}
+
+WeightAveraging::WeightAveraging(const Mlp& model, int64_t max_epochs)
+    : lookahead_(model.Config().use_lookahead), swa_(model.Config().use_swa), swa_start_(SwaStartEpoch(max_epochs)) {
+    const auto& params = model.Parameters();
+    state_ = AcquireAveraging(static_cast<int64_t>(params.size()), static_cast<int64_t>(model.Buffers().size()),
+                              lookahead_, swa_, slow_, average_, buffers_);
+    if (lookahead_) {
+        std::copy(params.begin(), params.end(), slow_.begin());
+    }
+}
+
+void WeightAveraging::Step(Mlp& model, int64_t steps) {
+    StepRange(model, steps, 0, static_cast<int64_t>(model.Parameters().size()));
+}
+
+void WeightAveraging::StepRange(Mlp& model, int64_t steps, int64_t begin, int64_t end) {
+    if (lookahead_ && steps % LOOKAHEAD_STEPS == 0) {
+        Lookahead(model, begin, end);
+    }
+}
+
+void WeightAveraging::Lookahead(Mlp& model, int64_t begin, int64_t end) {
+    if (lookahead_ && end > begin) {
+        LookaheadUpdate(end - begin, model.Parameters().data() + begin, slow_.data() + begin, LOOKAHEAD_ALPHA);
+    }
+}
+
+void WeightAveraging::SaveState(std::vector<float>& slow, std::vector<float>& average, int64_t& samples) const {
+    slow.assign(slow_.begin(), slow_.end());
+    average.assign(average_.begin(), average_.end());
+    samples = swa_samples_;
+}
+
+void WeightAveraging::LoadState(const Mlp& model, const std::vector<float>& slow, const std::vector<float>& average,
+                                int64_t samples) {
+    const auto& params = model.Parameters();
+    if (lookahead_ && slow.empty()) {
+        std::copy(params.begin(), params.end(), slow_.begin());
+    } else if (static_cast<int64_t>(slow.size()) != slow_.size()) {
+        throw std::runtime_error("Stored lookahead weights do not match the model.");
+    } else {
+        std::copy(slow.begin(), slow.end(), slow_.begin());
+    }
+    if (swa_ && average.empty()) {
+        swa_samples_ = 0;
+        return;
+    }
+    if (static_cast<int64_t>(average.size()) != average_.size()) {
+        throw std::runtime_error("Stored SWA average does not match the model.");
+    }
+    std::copy(average.begin(), average.end(), average_.begin());
+    swa_samples_ = samples;
+}
+
+void WeightAveraging::EndEpoch(Mlp& model, int64_t epoch) {
+    if (!swa_ || epoch < swa_start_) {
+        return;
+    }
+    ++swa_samples_;
+    AverageUpdate(static_cast<int64_t>(average_.size()), model.Parameters().data(), average_.data(),
+                  1.0f / static_cast<float>(swa_samples_));
+}
+
+void WeightAveraging::BeginEvaluate(Mlp& model, const float* x, int64_t batch, MlpWorkspace& ws) {
+    if (!Averaged() || swapped_) {
+        return;
+    }
+    auto& buffers = model.Buffers();
+    std::copy(buffers.begin(), buffers.end(), buffers_.begin());
+    SwapRange(static_cast<int64_t>(average_.size()), model.Parameters().data(), average_.data());
+    swapped_ = true;
+    // 平均权重的激活分布与任何一个快权重都不同, 滑动统计量不能沿用
+    model.RecomputeBatchNorm(x, batch, ws);
+}
+
+void WeightAveraging::EndEvaluate(Mlp& model) {
+    if (!swapped_) {
+        return;
+    }
+    SwapRange(static_cast<int64_t>(average_.size()), model.Parameters().data(), average_.data());
+    std::copy(buffers_.begin(), buffers_.end(), model.Buffers().begin());
+    swapped_ = false;
+}
+
+StackedWeightAveraging::StackedWeightAveraging(const StackedMlp& model, int64_t max_epochs)
+    : swa_start_(SwaStartEpoch(max_epochs)) {
+    for (const auto& config : model.Configs()) {
+        lookahead_.push_back(config.use_lookahead);
+        swa_.push_back(config.use_swa);
+        any_lookahead_ = any_lookahead_ || config.use_lookahead;
+        any_swa_ = any_swa_ || config.use_swa;
+    }
+    const auto& params = model.Parameters();
+    state_ = AcquireAveraging(static_cast<int64_t>(params.size()), static_cast<int64_t>(model.Buffers().size()),
+                              any_lookahead_, any_swa_, slow_, average_, buffers_);
+    if (any_lookahead_) {
+        std::copy(params.begin(), params.end(), slow_.begin());
+    }
+}
+
+template <class F>
+void StackedWeightAveraging::ForEachBlock(const StackedMlp& model, const std::vector<bool>& flags, F&& f) const {
+    const auto trials = model.Trials();
+    for (const auto& slot : model.Slots()) {
+        for (int64_t r = 0; r < slot.rows; ++r) {
+            for (int64_t k = 0; k < trials; ++k) {
+                if (flags[k]) {
+                    f(slot.offset + (r * trials + k) * slot.width, slot.width);
+                }
+            }
+        }
+    }
+}
+
+void StackedWeightAveraging::Step(StackedMlp& model, int64_t steps) {
+    if (!any_lookahead_ || steps % WeightAveraging::LOOKAHEAD_STEPS != 0) {
+        return;
+    }
+    float* params = model.Parameters().data();
+    ForEachBlock(model, lookahead_, [&](int64_t offset, int64_t width) {
+        LookaheadUpdate(width, params + offset, slow_.data() + offset, WeightAveraging::LOOKAHEAD_ALPHA);
+    });
+}
+
+void StackedWeightAveraging::EndEpoch(StackedMlp& model, int64_t epoch) {
+    if (!any_swa_ || epoch < swa_start_) {
+        return;
+    }
+    ++swa_samples_;
+    const float weight = 1.0f / static_cast<float>(swa_samples_);
+    const float* params = model.Parameters().data();
+    ForEachBlock(model, swa_, [&](int64_t offset, int64_t width) {
+        AverageUpdate(width, params + offset, average_.data() + offset, weight);
+    });
+}
+
+void StackedWeightAveraging::BeginEvaluate(StackedMlp& model, const float* x, int64_t batch,
+                                           StackedWorkspace& ws) {
+    if (!Averaged() || swapped_) {
+        return;
+    }
+    auto& buffers = model.Buffers();
+    std::copy(buffers.begin(), buffers.end(), buffers_.begin());
+    float* params = model.Parameters().data();
+    ForEachBlock(model, swa_, [&](int64_t offset, int64_t width) {
+        SwapRange(width, params + offset, average_.data() + offset);
+    });
+    swapped_ = true;
+    model.RecomputeBatchNorm(x, batch, ws, swa_);
+}
+
+void StackedWeightAveraging::EndEvaluate(StackedMlp& model) {
+    if (!swapped_) {
+        return;
+    }
+    float* params = model.Parameters().data();
+    ForEachBlock(model, swa_, [&](int64_t offset, int64_t width) {
+        SwapRange(width, params + offset, average_.data() + offset);
+    });
+    std::copy(buffers_.begin(), buffers_.end(), model.Buffers().begin());
+    swapped_ = false;
+}
+
+} // namespace regdb
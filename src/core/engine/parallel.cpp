@@ -0,0 +1,271 @@
+#include "regdb/core/engine/parallel.hpp"
+
+#include <algorithm>
+
+namespace regdb {
+
+namespace {
+
+int64_t RoundUpToCacheLine(int64_t count) {
+    return (count + CACHE_LINE_FLOATS - 1) / CACHE_LINE_FLOATS * CACHE_LINE_FLOATS;
+}
+
+} // namespace
+
+GradientReducer::GradientReducer(int64_t size, int64_t workers)
+    : size_(size), workers_(std::max<int64_t>(1, workers)) {
+    stride_ = RoundUpToCacheLine(std::max<int64_t>(1, size_));
+    chunk_ = RoundUpToCacheLine((size_ + workers_ - 1) / workers_);
+    // 多分配一个 cache line 用于对齐起始地址
+    storage_.assign(stride_ * workers_ + CACHE_LINE_FLOATS, 0.0f);
+    const auto address = reinterpret_cast<uintptr_t>(storage_.data());
+    const auto aligned = (address + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES * CACHE_LINE_BYTES;
+    base_ = storage_.data() + (aligned - address) / sizeof(float);
+}
+
+std::pair<int64_t, int64_t> GradientReducer::Chunk(int64_t worker) const {
+    const auto begin = std::min(size_, worker * chunk_);
+    const auto end = std::min(size_, begin + chunk_);
+    return {begin, end};
+}
+
+void GradientReducer::Reduce(int64_t worker) {
+    const auto range = Chunk(worker);
+    const auto count = range.second - range.first;
+    if (count <= 0) {
+        return;
+    }
+    for (int64_t step = 1; step < workers_; step *= 2) {
+        for (int64_t dst = 0; dst + step < workers_; dst += 2 * step) {
+            float* target = base_ + dst * stride_ + range.first;
+            const float* source = base_ + (dst + step) * stride_ + range.first;
+            for (int64_t i = 0; i < count; ++i) {
+                target[i] += source[i];
+            }
+        }
+    }
+}
+
+ThreadPool& ThreadPool::Instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool() {
+    limit_ = std::max<int64_t>(1, static_cast<int64_t>(std::thread::hardware_concurrency()));
+}
+
+ThreadPool::~ThreadPool() {
+    std::unique_lock<std::mutex> guard(lock_);
+    for (auto& slot : slots_) {
+        slot->stop = true;
+        slot->ready.notify_one();
+    }
+    // 外部线程不归池所有, 等它们从 Loop 返回
+    exited_.wait(guard, [this]() { return external_running_ == 0; });
+    guard.unlock();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Resize(int64_t threads) {
+    std::lock_guard<std::mutex> guard(lock_);
+    // 只记录上限, 线程在第一次借用时按需创建; 缩小时已借出的线程在归还后不再超出上限
+    limit_ = std::max<int64_t>(1, threads);
+}
+
+int64_t ThreadPool::Threads() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return limit_;
+}
+
+void ThreadPool::Attach(Launcher launcher) {
+    std::lock_guard<std::mutex> guard(lock_);
+    launcher_ = std::move(launcher);
+    // 旧 launcher 上还没运行的请求不再等待; 已在运行的线程空闲后自行退出
+    starting_ = 0;
+}
+
+ThreadPool::Lease ThreadPool::Acquire(int64_t workers) {
+    std::unique_lock<std::mutex> guard(lock_);
+    auto granted = Take(guard, workers - 1, true);
+    return Lease(this, std::move(granted));
+}
+
+bool ThreadPool::Submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> guard(lock_);
+    const auto granted = Take(guard, 1, false);
+    if (granted.empty()) {
+        return false;
+    }
+    const auto index = granted[0];
+    auto& slot = *slots_[index];
+    slot.task = [this, index, task = std::move(task)]() {
+        task();
+        Release({index});
+    };
+    slot.ready.notify_one();
+    return true;
+}
+
+std::vector<int64_t> ThreadPool::Take(std::unique_lock<std::mutex>& guard, int64_t wanted, bool launch) {
+    // 调用方线程本身占用一个并发名额; 嵌套借用时调用方是已借出的线程, 已计入 leased_
+    auto available = [&]() { return std::min(wanted, limit_ - 1 - leased_); };
+    if (available() <= 0) {
+        return {};
+    }
+    if (!launcher_) {
+        // 自建线程创建后立即可用
+        while (static_cast<int64_t>(idle_.size()) < available()) {
+            const auto index = NewSlot(false);
+            threads_.emplace_back(&ThreadPool::Loop, this, index);
+            idle_.push_back(index);
+        }
+    } else if (launch) {
+        // 外部线程要等调度器安排, 只借出已经进入 Loop 的线程
+        std::vector<int64_t> requests;
+        while (static_cast<int64_t>(idle_.size() + requests.size()) + starting_ < available()) {
+            requests.push_back(NewSlot(true));
+        }
+        starting_ += static_cast<int64_t>(requests.size());
+        const auto launcher = launcher_;
+        guard.unlock();
+        std::vector<int64_t> failed;
+        for (auto index : requests) {
+            if (!launcher([this, index]() { Loop(index); })) {
+                failed.push_back(index);
+            }
+        }
+        guard.lock();
+        starting_ = std::max<int64_t>(0, starting_ - static_cast<int64_t>(failed.size()));
+        for (auto index : failed) {
+            slots_[index]->alive = false;
+        }
+        arrived_.wait_for(guard, LAUNCH_WAIT,
+                          [&]() { return static_cast<int64_t>(idle_.size()) >= available(); });
+    }
+    // 等待期间其他借用可能已经拿走名额, 重新按上限截断
+    const auto count = std::max<int64_t>(0, std::min(available(), static_cast<int64_t>(idle_.size())));
+    std::vector<int64_t> granted(idle_.end() - count, idle_.end());
+    idle_.resize(idle_.size() - count);
+    leased_ += count;
+    return granted;
+}
+
+int64_t ThreadPool::NewSlot(bool external) {
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (!slots_[i]->alive) {
+            slots_[i]->alive = true;
+            slots_[i]->external = external;
+            return static_cast<int64_t>(i);
+        }
+    }
+    slots_.push_back(std::make_unique<Slot>());
+    slots_.back()->external = external;
+    return static_cast<int64_t>(slots_.size()) - 1;
+}
+
+void ThreadPool::Release(const std::vector<int64_t>& threads) {
+    std::lock_guard<std::mutex> guard(lock_);
+    leased_ -= static_cast<int64_t>(threads.size());
+    idle_.insert(idle_.end(), threads.begin(), threads.end());
+}
+
+void ThreadPool::Loop(int64_t index) {
+    std::unique_lock<std::mutex> guard(lock_);
+    auto& slot = *slots_[index];
+    if (slot.external) {
+        starting_ = std::max<int64_t>(0, starting_ - 1);
+        ++external_running_;
+        idle_.push_back(index);
+        arrived_.notify_all();
+    }
+    auto wake = [&]() { return slot.stop || static_cast<bool>(slot.task); };
+    while (true) {
+        if (!slot.external) {
+            slot.ready.wait(guard, wake);
+        } else if (!slot.ready.wait_for(guard, LINGER, wake) || slot.stop) {
+            // 外部线程空闲过久或池析构时退出, 把 worker 还给调度器; 已被借出的线程继续等任务
+            const auto it = std::find(idle_.begin(), idle_.end(), index);
+            if (it == idle_.end() && !slot.stop) {
+                continue;
+            }
+            if (it != idle_.end()) {
+                idle_.erase(it);
+            }
+            slot.alive = false;
+            --external_running_;
+            exited_.notify_all();
+            return;
+        }
+        if (slot.stop) {
+            return;
+        }
+        auto task = std::move(slot.task);
+        slot.task = nullptr;
+        guard.unlock();
+        task();
+        guard.lock();
+    }
+}
+
+ThreadPool::Lease::Lease(Lease&& other) noexcept : pool_(other.pool_), threads_(std::move(other.threads_)) {
+    other.threads_.clear();
+}
+
+ThreadPool::Lease::~Lease() {
+    if (!threads_.empty()) {
+        pool_->Release(threads_);
+    }
+}
+
+void ThreadPool::Lease::Run(const std::function<void(int64_t)>& fn) {
+    std::mutex done_lock;
+    std::condition_variable done;
+    int64_t pending = static_cast<int64_t>(threads_.size());
+    std::exception_ptr error;
+    std::exception_ptr aborted;
+    auto invoke = [&](int64_t worker) {
+        try {
+            fn(worker);
+        } catch (const BarrierAborted&) {
+            // 其他 worker 失败后放弃了屏障, 原始异常由那个 worker 记录
+            std::lock_guard<std::mutex> guard(done_lock);
+            if (!aborted) {
+                aborted = std::current_exception();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(done_lock);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+    {
+        std::lock_guard<std::mutex> guard(pool_->lock_);
+        for (size_t i = 0; i < threads_.size(); ++i) {
+            const auto worker = static_cast<int64_t>(i) + 1;
+            auto& slot = *pool_->slots_[threads_[i]];
+            slot.task = [&, worker]() {
+                invoke(worker);
+                std::lock_guard<std::mutex> guard(done_lock);
+                if (--pending == 0) {
+                    done.notify_one();
+                }
+            };
+            slot.ready.notify_one();
+        }
+    }
+    invoke(0);
+    std::unique_lock<std::mutex> guard(done_lock);
+    done.wait(guard, [&]() { return pending == 0; });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (aborted) {
+        std::rethrow_exception(aborted);
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,168 @@
+#include "regdb/core/engine/predictor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+// 没有量化或块稀疏张量、以 fp32 稠密格式推理的成员才能堆叠
+bool Dense(const ModelWeights& weights) {
+    return weights.quantized.empty() && weights.sparse.empty();
+}
+
+} // namespace
+
+Predictor::Predictor(const ModelWeights& weights) : spec_(weights.spec), members_(1) {
+    AddSingle(weights);
+}
+
+void Predictor::AddSingle(const ModelWeights& weights) {
+    singles_.push_back(std::make_unique<Mlp>(weights.spec, weights.config, 0));
+    weights.Restore(*singles_.back());
+    quantized_.push_back(weights.quantized.empty() ? nullptr
+                                                   : std::make_unique<QuantizedMlp>(*singles_.back(), weights.quantized));
+    sparse_.push_back(weights.sparse.empty() ? nullptr
+                                             : std::make_unique<SparseMlp>(*singles_.back(), weights.sparse));
+}
+
+Precision Predictor::GetPrecision() const {
+    return members_ == 1 && quantized_[0] ? quantized_[0]->GetPrecision() : Precision::FP32;
+}
+
+Predictor::Predictor(const std::vector<ModelWeights>& members)
+    : spec_(members.empty() ? ModelSpec() : members[0].spec), members_(static_cast<int64_t>(members.size())) {
+    if (members.empty()) {
+        throw std::runtime_error("An ensemble needs at least one model.");
+    }
+    // 按隐藏层结构分组, 同一组的成员堆叠在一起
+    std::vector<std::vector<size_t>> groups;
+    for (size_t i = 0; i < members.size(); ++i) {
+        const auto& spec = members[i].spec;
+        if (spec.in_features != spec_.in_features || spec.out_features != spec_.out_features) {
+            throw std::runtime_error("Model '" + members[i].model_name + "' has different in_features or out_features "
+                                     "from model '" + members[0].model_name + "'.");
+        }
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const std::vector<size_t>& group) {
+            return Dense(members[group[0]]) && members[group[0]].spec.hidden_features == spec.hidden_features;
+        });
+        if (group == groups.end() || !Dense(members[i])) {
+            groups.push_back({i});
+        } else {
+            group->push_back(i);
+        }
+    }
+    for (const auto& group : groups) {
+        if (group.size() == 1) {
+            AddSingle(members[group[0]]);
+            continue;
+        }
+        std::vector<RegConfig> configs;
+        for (auto i : group) {
+            configs.push_back(members[i].config);
+        }
+        const auto& spec = members[group[0]].spec;
+        auto stacked = std::make_unique<StackedMlp>(spec, configs, std::vector<uint64_t>(group.size(), 0));
+        for (size_t k = 0; k < group.size(); ++k) {
+            Mlp model(spec, configs[k], 0);
+            members[group[k]].Restore(model);
+            stacked->Insert(static_cast<int64_t>(k), model);
+        }
+        groups_.push_back(std::move(stacked));
+    }
+}
+
+void Predictor::Accumulate(const float* logits, int64_t rows, int64_t stride, float* sum) const {
+    const auto classes = spec_.out_features;
+    for (int64_t row = 0; row < rows; ++row) {
+        const float* scores = logits + row * stride;
+        float* total = sum + row * classes;
+        if (classes == 1) {
+            total[0] += scores[0];
+            continue;
+        }
+        const float max = *std::max_element(scores, scores + classes);
+        float norm = 0.0f;
+        for (int64_t c = 0; c < classes; ++c) {
+            norm += std::exp(scores[c] - max);
+        }
+        for (int64_t c = 0; c < classes; ++c) {
+            total[c] += std::exp(scores[c] - max) / norm;
+        }
+    }
+}
+
+const float* Predictor::Forward(size_t i, const float* x, int64_t rows, PredictWorkspace& ws) const {
+    if (quantized_[i]) {
+        return quantized_[i]->Forward(x, rows, ws.quantized[i]);
+    }
+    if (sparse_[i]) {
+        return sparse_[i]->Forward(x, rows, ws.sparse[i]);
+    }
+    std::mt19937 unused;
+    singles_[i]->Forward(x, rows, false, ws.singles[i], unused);
+    return ws.singles[i].logits.data();
+}
+
+void Predictor::Predict(const float* x, int64_t rows, PredictWorkspace& ws, float* out) const {
+    const auto in_features = spec_.in_features;
+    const auto classes = spec_.out_features;
+    std::mt19937 unused;
+    ws.singles.resize(singles_.size());
+    ws.quantized.resize(singles_.size());
+    ws.sparse.resize(singles_.size());
+    ws.groups.resize(groups_.size());
+
+    // 单个模型直接输出 logits, 不需要累加
+    if (members_ == 1) {
+        for (int64_t start = 0; start < rows; start += BATCH_ROWS) {
+            const auto count = std::min(BATCH_ROWS, rows - start);
+            const float* logits = Forward(0, x + start * in_features, count, ws);
+            if (classes == 1) {
+                std::copy(logits, logits + count, out + start);
+                continue;
+            }
+            for (int64_t row = 0; row < count; ++row) {
+                const float* scores = logits + row * classes;
+                out[start + row] = static_cast<float>(std::max_element(scores, scores + classes) - scores);
+            }
+        }
+        return;
+    }
+
+    ws.sum.resize(TILE_ROWS * classes);
+    const float scale = 1.0f / static_cast<float>(members_);
+    for (int64_t start = 0; start < rows; start += TILE_ROWS) {
+        const auto count = std::min(TILE_ROWS, rows - start);
+        const float* tile = x + start * in_features;
+        float* sum = ws.sum.data();
+        std::fill(sum, sum + count * classes, 0.0f);
+        for (size_t i = 0; i < singles_.size(); ++i) {
+            Accumulate(Forward(i, tile, count, ws), count, classes, sum);
+        }
+        for (size_t g = 0; g < groups_.size(); ++g) {
+            auto& group = *groups_[g];
+            group.Forward(tile, count, false, ws.groups[g], unused);
+            // 堆叠的 logits 为 [count, K * classes], 成员 k 占第 k 个列块
+            const auto trials = group.Trials();
+            for (int64_t k = 0; k < trials; ++k) {
+                Accumulate(ws.groups[g].logits.data() + k * classes, count, trials * classes, sum);
+            }
+        }
+        if (classes == 1) {
+            for (int64_t row = 0; row < count; ++row) {
+                out[start + row] = sum[row] * scale;
+            }
+            continue;
+        }
+        for (int64_t row = 0; row < count; ++row) {
+            const float* probs = sum + row * classes;
+            out[start + row] = static_cast<float>(std::max_element(probs, probs + classes) - probs);
+        }
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,185 @@
+#include "regdb/core/engine/preprocess.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace regdb {
+
+std::string FeatureTransformToString(FeatureTransform transform) {
+    switch (transform) {
+    case FeatureTransform::ZSCORE:
+        return "zscore";
+    case FeatureTransform::MINMAX:
+        return "minmax";
+    case FeatureTransform::ONEHOT:
+        return "onehot";
+    case FeatureTransform::HASH:
+        return "hash";
+    }
+    return "zscore";
+}
+
+FeatureTransform FeatureTransformFromString(const std::string& name) {
+    if (name == "zscore") return FeatureTransform::ZSCORE;
+    if (name == "minmax") return FeatureTransform::MINMAX;
+    if (name == "onehot") return FeatureTransform::ONEHOT;
+    if (name == "hash") return FeatureTransform::HASH;
+    throw std::runtime_error("Unknown preprocess transform: " + name);
+}
+
+uint32_t MurmurHash3(const void* data, size_t length, uint32_t seed) {
+    constexpr uint32_t C1 = 0xcc9e2d51;
+    constexpr uint32_t C2 = 0x1b873593;
+    auto rotl = [](uint32_t x, int r) { return (x << r) | (x >> (32 - r)); };
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    const auto blocks = length / 4;
+    uint32_t h = seed;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint32_t k;
+        std::memcpy(&k, bytes + i * 4, sizeof(k));
+        k = rotl(k * C1, 15) * C2;
+        h = rotl(h ^ k, 13) * 5 + 0xe6546b64;
+    }
+    const auto* tail = bytes + blocks * 4;
+    uint32_t k = 0;
+    switch (length & 3) {
+    case 3:
+        k ^= static_cast<uint32_t>(tail[2]) << 16;
+        // fallthrough
+    case 2:
+        k ^= static_cast<uint32_t>(tail[1]) << 8;
+        // fallthrough
+    case 1:
+        k ^= tail[0];
+        h ^= rotl(k * C1, 15) * C2;
+    }
+    h ^= static_cast<uint32_t>(length);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+Preprocessor::Preprocessor(std::vector<ColumnTransform> columns, std::string label, int64_t width)
+    : columns_(std::move(columns)), label_(std::move(label)), width_(width) {
+    int64_t fixed = 0;
+    bool hashed = false;
+    for (auto& column : columns_) {
+        column.offset = fixed;
+        if (column.Numeric()) {
+            fixed += 1;
+        } else if (column.transform == FeatureTransform::ONEHOT) {
+            fixed += static_cast<int64_t>(column.categories.size());
+        } else {
+            hashed = true;
+        }
+    }
+    // 哈希列共享剩余的全部宽度
+    hash_offset_ = fixed;
+    hash_buckets_ = hashed ? width_ - fixed : 0;
+    if (hashed && hash_buckets_ <= 0) {
+        throw std::runtime_error("Preprocessing needs " + std::to_string(fixed) +
+                                 " columns before feature hashing, in_features must be larger.");
+    }
+    if (!hashed && fixed != width_) {
+        throw std::runtime_error("Preprocessing produces " + std::to_string(fixed) + " features but in_features is " +
+                                 std::to_string(width_) + ".");
+    }
+    for (auto& column : columns_) {
+        if (column.transform == FeatureTransform::HASH) {
+            column.offset = hash_offset_;
+        }
+    }
+    BuildIndex();
+}
+
+void Preprocessor::BuildIndex() {
+    index_.assign(columns_.size(), {});
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        const auto& column = columns_[c];
+        for (size_t i = 0; i < column.categories.size(); ++i) {
+            index_[c].emplace(column.categories[i], column.offset + static_cast<int64_t>(i));
+        }
+    }
+}
+
+Preprocessor Preprocessor::FromJson(const nlohmann::json& json) {
+    std::vector<ColumnTransform> columns;
+    for (const auto& item : json.at("columns")) {
+        ColumnTransform column;
+        column.name = item.at("name").get<std::string>();
+        column.transform = FeatureTransformFromString(item.at("transform").get<std::string>());
+        column.shift = item.value("shift", 0.0f);
+        column.scale = item.value("scale", 1.0f);
+        column.categories = item.value("categories", std::vector<std::string>());
+        columns.push_back(std::move(column));
+    }
+    return Preprocessor(std::move(columns), json.at("label").get<std::string>(), json.at("width").get<int64_t>());
+}
+
+nlohmann::json Preprocessor::ToJson() const {
+    auto columns = nlohmann::json::array();
+    for (const auto& column : columns_) {
+        nlohmann::json item = {{"name", column.name}, {"transform", FeatureTransformToString(column.transform)}};
+        if (column.Numeric()) {
+            item["shift"] = column.shift;
+            item["scale"] = column.scale;
+        } else if (column.transform == FeatureTransform::ONEHOT) {
+            item["categories"] = column.categories;
+        }
+        columns.push_back(std::move(item));
+    }
+    return {{"columns", columns}, {"label", label_}, {"width", width_}};
+}
+
+void Preprocessor::TransformNumeric(int64_t column, const float* values, const uint8_t* valid, int64_t rows,
+                                    float* out) const {
+    const auto& transform = columns_[column];
+    const auto shift = transform.shift;
+    const auto scale = transform.scale;
+    float* target = out + transform.offset;
+    if (!valid) {
+        for (int64_t r = 0; r < rows; ++r) {
+            target[r * width_] = (values[r] - shift) * scale;
+        }
+        return;
+    }
+    for (int64_t r = 0; r < rows; ++r) {
+        target[r * width_] = valid[r] ? (values[r] - shift) * scale : 0.0f;
+    }
+}
+
+void Preprocessor::TransformCategorical(int64_t column, const std::string_view* values, const uint8_t* valid,
+                                        int64_t rows, float* out) const {
+    const auto& transform = columns_[column];
+    if (transform.transform == FeatureTransform::ONEHOT) {
+        const auto& index = index_[column];
+        std::string key;
+        for (int64_t r = 0; r < rows; ++r) {
+            if (valid && !valid[r]) {
+                continue;
+            }
+            key.assign(values[r].data(), values[r].size());
+            auto it = index.find(key);
+            if (it != index.end()) {
+                out[r * width_ + it->second] = 1.0f;
+            }
+        }
+        return;
+    }
+    // 以列号为种子, 不同列的相同取值落到不同的桶
+    const auto seed = static_cast<uint32_t>(column);
+    for (int64_t r = 0; r < rows; ++r) {
+        if (valid && !valid[r]) {
+            continue;
+        }
+        const auto hash = MurmurHash3(values[r].data(), values[r].size(), seed);
+        const auto bucket = static_cast<int64_t>((hash & 0x7fffffffu) % static_cast<uint32_t>(hash_buckets_));
+        out[r * width_ + hash_offset_ + bucket] += (hash >> 31) ? -1.0f : 1.0f;
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,415 @@
+#include "regdb/core/engine/prune.hpp"
+#include "regdb/core/engine/kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+const char* const KIND_SPARSE_ROWS = "sparse_rows";
+const char* const KIND_SPARSE_COLS = "sparse_cols";
+const char* const KIND_SPARSE_VALUES = "sparse_values";
+
+std::string WeightName(size_t layer) {
+    return "layers." + std::to_string(layer) + ".weight";
+}
+
+template <class T>
+std::vector<uint8_t> Bytes(const std::vector<T>& values) {
+    std::vector<uint8_t> bytes(values.size() * sizeof(T));
+    std::memcpy(bytes.data(), values.data(), bytes.size());
+    return bytes;
+}
+
+template <class T>
+void FromBytes(const std::vector<uint8_t>& bytes, std::vector<T>& values, const std::string& name) {
+    if (bytes.size() % sizeof(T) != 0) {
+        throw std::runtime_error("Sparse tensor '" + name + "' does not match the model architecture.");
+    }
+    values.resize(bytes.size() / sizeof(T));
+    std::memcpy(values.data(), bytes.data(), bytes.size());
+}
+
+// 折叠 BN 之后的一层权重 [in, out] 和偏置
+void FoldLayer(const Mlp& model, const LayerShape& shape, std::vector<float>& weight, std::vector<float>& bias) {
+    const float* params = model.Parameters().data();
+    const float* buffers = model.Buffers().data();
+    weight.assign(params + shape.weight, params + shape.weight + shape.in * shape.out);
+    bias.assign(params + shape.bias, params + shape.bias + shape.out);
+    if (shape.bn_gamma >= 0) {
+        kernels::FoldBatchNorm(shape.in, shape.out, shape.out, params + shape.weight, params + shape.bias,
+                               params + shape.bn_gamma, params + shape.bn_beta, buffers + shape.running_mean,
+                               buffers + shape.running_var, weight.data(), bias.data());
+    }
+}
+
+void CheckSparsity(double sparsity) {
+    if (!(sparsity >= 0.0 && sparsity < 1.0)) {
+        throw std::runtime_error("Pruning sparsity must be in [0, 1).");
+    }
+}
+
+// 剪枝结果只保留参数和 BN 统计量, 元数据沿用原权重
+ModelWeights PrunedWeights(const ModelWeights& weights, const Mlp& model) {
+    auto result = ModelWeights::FromModel(weights.model_name, weights.key, model, weights.rows, weights.train_loss);
+    result.last_rowid = weights.last_rowid;
+    result.preprocess = weights.preprocess;
+    return result;
+}
+
+} // namespace
+
+std::string PruneMethodToString(PruneMethod method) {
+    switch (method) {
+        case PruneMethod::MAGNITUDE:
+            return "magnitude";
+        case PruneMethod::NEURON:
+            return "neuron";
+    }
+    return "magnitude";
+}
+
+PruneMethod PruneMethodFromString(const std::string& name) {
+    if (name == "magnitude") {
+        return PruneMethod::MAGNITUDE;
+    }
+    if (name == "neuron") {
+        return PruneMethod::NEURON;
+    }
+    throw std::runtime_error("Unknown pruning method '" + name + "', expected magnitude or neuron.");
+}
+
+bool IsSparseKind(const std::string& kind) {
+    return kind == KIND_SPARSE_ROWS || kind == KIND_SPARSE_COLS || kind == KIND_SPARSE_VALUES;
+}
+
+bool IsPrunedFrom(const ModelSpec& pruned, const ModelSpec& spec) {
+    if (pruned.hidden_features.size() != spec.hidden_features.size()) {
+        return false;
+    }
+    for (size_t l = 0; l < spec.hidden_features.size(); ++l) {
+        if (pruned.hidden_features[l] > spec.hidden_features[l]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ModelWeights PruneBlocks(const ModelWeights& weights, double sparsity) {
+    CheckSparsity(sparsity);
+    Mlp model(weights.spec, weights.config, 0);
+    weights.Restore(model);
+    auto* params = model.Parameters().data();
+    for (const auto& shape : model.Layers()) {
+        if (!shape.hidden) {
+            continue;
+        }
+        std::vector<float> folded;
+        std::vector<float> bias;
+        FoldLayer(model, shape, folded, bias);
+        const auto blocks_per_row = (shape.out + kernels::SPARSE_BLOCK - 1) / kernels::SPARSE_BLOCK;
+        std::vector<float> norm(shape.in * blocks_per_row, 0.0f);
+        for (int64_t p = 0; p < shape.in; ++p) {
+            for (int64_t j = 0; j < shape.out; ++j) {
+                const float w = folded[p * shape.out + j];
+                norm[p * blocks_per_row + j / kernels::SPARSE_BLOCK] += w * w;
+            }
+        }
+        const auto pruned = static_cast<int64_t>(std::floor(sparsity * static_cast<double>(norm.size())));
+        std::vector<int64_t> order(norm.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + pruned, order.end(),
+                         [&](int64_t a, int64_t b) { return norm[a] < norm[b]; });
+        float* weight = params + shape.weight;
+        for (int64_t k = 0; k < pruned; ++k) {
+            const auto p = order[k] / blocks_per_row;
+            const auto j0 = (order[k] % blocks_per_row) * kernels::SPARSE_BLOCK;
+            float* row = weight + p * shape.out;
+            std::fill(row + j0, row + std::min(shape.out, j0 + kernels::SPARSE_BLOCK), 0.0f);
+        }
+    }
+    return PrunedWeights(weights, model);
+}
+
+ModelWeights PruneNeurons(const ModelWeights& weights, double sparsity) {
+    CheckSparsity(sparsity);
+    Mlp model(weights.spec, weights.config, 0);
+    weights.Restore(model);
+    const auto& layers = model.Layers();
+    const float* params = model.Parameters().data();
+    const auto hidden = weights.spec.hidden_features.size();
+
+    // 有残差的层与上一层共用神经元, 同一条链上的层一起剪; 第一层有残差时链连着输入, 不能剪
+    std::vector<size_t> chain(hidden);
+    std::vector<bool> fixed;
+    for (size_t l = 0; l < hidden; ++l) {
+        if (layers[l].skip && l > 0) {
+            chain[l] = chain[l - 1];
+            continue;
+        }
+        chain[l] = fixed.size();
+        fixed.push_back(layers[l].skip);
+    }
+    std::vector<std::vector<double>> score(fixed.size());
+    for (size_t l = 0; l < hidden; ++l) {
+        const auto& shape = layers[l];
+        const auto& next = layers[l + 1];
+        std::vector<float> folded;
+        std::vector<float> bias;
+        FoldLayer(model, shape, folded, bias);
+        auto& total = score[chain[l]];
+        total.resize(shape.out, 0.0);
+        for (int64_t j = 0; j < shape.out; ++j) {
+            double in_norm = 0.0;
+            if (shape.ln_gamma >= 0) {
+                // LN 之后神经元的尺度由 LN 的缩放决定
+                in_norm = std::abs(params[shape.ln_gamma + j]) + std::abs(params[shape.ln_beta + j]);
+            } else {
+                for (int64_t p = 0; p < shape.in; ++p) {
+                    in_norm += static_cast<double>(folded[p * shape.out + j]) * folded[p * shape.out + j];
+                }
+                in_norm = std::sqrt(in_norm);
+            }
+            double out_norm = 0.0;
+            const float* row = params + next.weight + j * next.out;
+            for (int64_t k = 0; k < next.out; ++k) {
+                out_norm += static_cast<double>(row[k]) * row[k];
+            }
+            total[j] += in_norm * std::sqrt(out_norm);
+        }
+    }
+
+    std::vector<int64_t> width(fixed.size());
+    for (size_t c = 0; c < fixed.size(); ++c) {
+        const auto original = static_cast<int64_t>(score[c].size());
+        width[c] = fixed[c] ? original
+                            : std::max<int64_t>(1, std::llround(static_cast<double>(original) * (1.0 - sparsity)));
+    }
+    // 宽度与输入相同的层在有残差时会多出残差连接, 多留或少留一个神经元避开
+    if (weights.config.use_skip || weights.spec.residual) {
+        for (size_t l = 0; l < hidden; ++l) {
+            if (layers[l].skip) {
+                continue;
+            }
+            const auto in = l == 0 ? weights.spec.in_features : width[chain[l - 1]];
+            auto& w = width[chain[l]];
+            if (w != in) {
+                continue;
+            }
+            if (w < layers[l].out) {
+                ++w;
+            } else if (w > 1) {
+                --w;
+            } else {
+                throw std::runtime_error("Cannot prune model '" + weights.model_name +
+                                         "' without changing its skip connections.");
+            }
+        }
+    }
+
+    // 每条链按分数保留前 width 个神经元, 保持原来的顺序
+    std::vector<std::vector<int64_t>> kept(fixed.size());
+    for (size_t c = 0; c < fixed.size(); ++c) {
+        auto& keep = kept[c];
+        keep.resize(score[c].size());
+        std::iota(keep.begin(), keep.end(), 0);
+        std::stable_sort(keep.begin(), keep.end(), [&](int64_t a, int64_t b) { return score[c][a] > score[c][b]; });
+        keep.resize(width[c]);
+        std::sort(keep.begin(), keep.end());
+    }
+
+    auto spec = weights.spec;
+    for (size_t l = 0; l < hidden; ++l) {
+        spec.hidden_features[l] = width[chain[l]];
+    }
+    Mlp pruned(spec, weights.config, 0);
+    std::vector<int64_t> inputs(weights.spec.in_features);
+    std::iota(inputs.begin(), inputs.end(), 0);
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const auto& from = layers[l];
+        const auto& to = pruned.Layers()[l];
+        if (to.skip != from.skip) {
+            throw std::runtime_error("Pruning changed the skip connections of model '" + weights.model_name + "'.");
+        }
+        std::vector<int64_t> outputs(from.out);
+        std::iota(outputs.begin(), outputs.end(), 0);
+        const auto& columns = from.hidden ? kept[chain[l]] : outputs;
+        auto* target = pruned.Parameters().data();
+        for (size_t r = 0; r < inputs.size(); ++r) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                target[to.weight + r * to.out + c] = params[from.weight + inputs[r] * from.out + columns[c]];
+            }
+        }
+        auto copy = [&](const float* source, int64_t from_offset, float* dest, int64_t to_offset) {
+            if (from_offset < 0) {
+                return;
+            }
+            for (size_t c = 0; c < columns.size(); ++c) {
+                dest[to_offset + c] = source[from_offset + columns[c]];
+            }
+        };
+        copy(params, from.bias, target, to.bias);
+        copy(params, from.bn_gamma, target, to.bn_gamma);
+        copy(params, from.bn_beta, target, to.bn_beta);
+        copy(params, from.ln_gamma, target, to.ln_gamma);
+        copy(params, from.ln_beta, target, to.ln_beta);
+        copy(model.Buffers().data(), from.running_mean, pruned.Buffers().data(), to.running_mean);
+        copy(model.Buffers().data(), from.running_var, pruned.Buffers().data(), to.running_var);
+        inputs = columns;
+    }
+    return PrunedWeights(weights, pruned);
+}
+
+void SparseWorkspace::Reserve(const SparseMlp& model, int64_t batch) {
+    if (batch <= capacity_) {
+        return;
+    }
+    Arena measure;
+    Bind(model, batch, measure);
+    arena_ = ArenaPool::Instance().Acquire(measure.Used(), MemoryCategory::WORKSPACE);
+    Bind(model, batch, *arena_);
+}
+
+void SparseWorkspace::Bind(const SparseMlp& model, int64_t batch, Arena& arena) {
+    const auto width = batch * model.Model().MaxWidth();
+    z = arena.Allocate<float>(width);
+    for (int i = 0; i < 2; ++i) {
+        act[i] = arena.Allocate<float>(width);
+        out[i] = arena.Allocate<float>(width);
+    }
+    ln_istd = arena.Allocate<float>(batch);
+    logits = arena.Allocate<float>(batch * model.Model().Spec().out_features);
+    capacity_ = arena.Measuring() ? 0 : batch;
+}
+
+SparseMlp::SparseMlp(const Mlp& model) : model_(model), layers_(model.Layers().size()) {
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& shape = model.Layers()[l];
+        auto& layer = layers_[l];
+        std::vector<float> weight;
+        FoldLayer(model, shape, weight, layer.bias);
+        layer.row_start.assign(1, 0);
+        for (int64_t p = 0; p < shape.in; ++p) {
+            for (int64_t j0 = 0; j0 < shape.out; j0 += kernels::SPARSE_BLOCK) {
+                const float* block = weight.data() + p * shape.out + j0;
+                const auto width = std::min(kernels::SPARSE_BLOCK, shape.out - j0);
+                if (std::all_of(block, block + width, [](float w) { return w == 0.0f; })) {
+                    continue;
+                }
+                layer.block_col.push_back(static_cast<int32_t>(j0 / kernels::SPARSE_BLOCK));
+                layer.values.insert(layer.values.end(), block, block + width);
+                layer.values.resize(layer.values.size() + kernels::SPARSE_BLOCK - width, 0.0f);
+            }
+            layer.row_start.push_back(static_cast<int32_t>(layer.block_col.size()));
+        }
+    }
+}
+
+SparseMlp::SparseMlp(const Mlp& model, const std::vector<QuantizedTensor>& tensors)
+    : model_(model), layers_(model.Layers().size()) {
+    std::vector<int> loaded(layers_.size(), 0);
+    for (const auto& tensor : tensors) {
+        size_t l = 0;
+        while (l < layers_.size() && WeightName(l) != tensor.name) {
+            ++l;
+        }
+        if (l == layers_.size()) {
+            throw std::runtime_error("Sparse tensor '" + tensor.name + "' does not match the model architecture.");
+        }
+        auto& layer = layers_[l];
+        if (tensor.kind == KIND_SPARSE_ROWS) {
+            FromBytes(tensor.data, layer.row_start, tensor.name);
+        } else if (tensor.kind == KIND_SPARSE_COLS) {
+            FromBytes(tensor.data, layer.block_col, tensor.name);
+        } else {
+            FromBytes(tensor.data, layer.values, tensor.name);
+        }
+        ++loaded[l];
+    }
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& shape = model.Layers()[l];
+        auto& layer = layers_[l];
+        std::vector<float> weight;
+        FoldLayer(model, shape, weight, layer.bias);
+        const auto blocks = static_cast<int64_t>(layer.block_col.size());
+        const auto blocks_per_row = (shape.out + kernels::SPARSE_BLOCK - 1) / kernels::SPARSE_BLOCK;
+        const bool valid = loaded[l] == 3 && static_cast<int64_t>(layer.row_start.size()) == shape.in + 1 &&
+                           layer.row_start.front() == 0 && layer.row_start.back() == blocks &&
+                           std::is_sorted(layer.row_start.begin(), layer.row_start.end()) &&
+                           static_cast<int64_t>(layer.values.size()) == blocks * kernels::SPARSE_BLOCK &&
+                           std::all_of(layer.block_col.begin(), layer.block_col.end(),
+                                       [&](int32_t col) { return col >= 0 && col < blocks_per_row; });
+        if (!valid) {
+            throw std::runtime_error("Sparse tensors of '" + WeightName(l) + "' do not match the model architecture.");
+        }
+    }
+}
+
+double SparseMlp::Density() const {
+    int64_t stored = 0;
+    int64_t total = 0;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& shape = model_.Layers()[l];
+        stored += static_cast<int64_t>(layers_[l].block_col.size());
+        total += shape.in * ((shape.out + kernels::SPARSE_BLOCK - 1) / kernels::SPARSE_BLOCK);
+    }
+    return total > 0 ? static_cast<double>(stored) / static_cast<double>(total) : 0.0;
+}
+
+int64_t SparseMlp::WeightBytes() const {
+    int64_t bytes = 0;
+    for (const auto& layer : layers_) {
+        bytes += static_cast<int64_t>((layer.row_start.size() + layer.block_col.size()) * sizeof(int32_t) +
+                                      layer.values.size() * sizeof(float));
+    }
+    return bytes;
+}
+
+std::vector<QuantizedTensor> SparseMlp::Tensors() const {
+    std::vector<QuantizedTensor> tensors;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& layer = layers_[l];
+        tensors.push_back({WeightName(l), KIND_SPARSE_ROWS, Bytes(layer.row_start)});
+        tensors.push_back({WeightName(l), KIND_SPARSE_COLS, Bytes(layer.block_col)});
+        tensors.push_back({WeightName(l), KIND_SPARSE_VALUES, Bytes(layer.values)});
+    }
+    return tensors;
+}
+
+const float* SparseMlp::Forward(const float* x, int64_t rows, SparseWorkspace& ws) const {
+    ws.Reserve(*this, rows);
+    const float* params = model_.Parameters().data();
+    const float* input = x;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& shape = model_.Layers()[l];
+        const auto& layer = layers_[l];
+        float* z = shape.hidden ? ws.z.data() : ws.logits.data();
+        kernels::LinearBlockSparse(rows, shape.in, shape.out, input, layer.row_start.data(), layer.block_col.data(),
+                                   layer.values.data(), layer.bias.data(), z);
+        if (!shape.hidden) {
+            break;
+        }
+        // 与 Mlp::Forward 的评估路径相同, 两组输出缓冲交替使用, 残差读取的上一层输出不会被覆盖
+        kernels::NormActForwardArgs args;
+        args.act = ws.act[l % 2].data();
+        if (shape.ln_gamma >= 0) {
+            args.ln_gamma = params + shape.ln_gamma;
+            args.ln_beta = params + shape.ln_beta;
+            args.ln_istd = ws.ln_istd.data();
+        }
+        if (shape.skip) {
+            args.skip = input;
+            args.out = ws.out[l % 2].data();
+        }
+        kernels::NormActForward(rows, shape.out, shape.out, z, args);
+        input = shape.skip ? args.out : args.act;
+    }
+    return ws.logits.data();
+}
+
+} // namespace regdb
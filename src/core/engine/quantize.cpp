@@ -0,0 +1,356 @@
+#include "regdb/core/engine/quantize.hpp"
+#include "regdb/core/engine/kernels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+const char* const KIND_BF16 = "bf16";
+const char* const KIND_INT8 = "int8";
+const char* const KIND_INT8_SCALE = "int8_scale";
+const char* const KIND_INT8_INPUT_SCALE = "int8_input_scale";
+
+// 就近舍入到偶数, 与硬件的 fp32 -> bf16 转换一致
+uint16_t FloatToBf16(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if (std::isnan(value)) {
+        return static_cast<uint16_t>((bits >> 16) | 0x40);
+    }
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+template <class T>
+std::vector<uint8_t> Bytes(const std::vector<T>& values) {
+    std::vector<uint8_t> bytes(values.size() * sizeof(T));
+    std::memcpy(bytes.data(), values.data(), bytes.size());
+    return bytes;
+}
+
+template <class T>
+void FromBytes(const std::vector<uint8_t>& bytes, size_t count, std::vector<T>& values, const std::string& name) {
+    if (bytes.size() != count * sizeof(T)) {
+        throw std::runtime_error("Quantized tensor '" + name + "' does not match the model architecture.");
+    }
+    values.resize(count);
+    std::memcpy(values.data(), bytes.data(), bytes.size());
+}
+
+std::string WeightName(size_t layer) {
+    return "layers." + std::to_string(layer) + ".weight";
+}
+
+} // namespace
+
+std::string PrecisionToString(Precision precision) {
+    switch (precision) {
+        case Precision::FP32:
+            return "fp32";
+        case Precision::BF16:
+            return "bf16";
+        case Precision::INT8:
+            return "int8";
+    }
+    return "fp32";
+}
+
+Precision PrecisionFromString(const std::string& name) {
+    if (name == "fp32") {
+        return Precision::FP32;
+    }
+    if (name == "bf16") {
+        return Precision::BF16;
+    }
+    if (name == "int8") {
+        return Precision::INT8;
+    }
+    throw std::runtime_error("Unknown precision '" + name + "', expected fp32, bf16 or int8.");
+}
+
+bool IsQuantizedKind(const std::string& kind) {
+    return kind == KIND_BF16 || kind == KIND_INT8 || kind == KIND_INT8_SCALE || kind == KIND_INT8_INPUT_SCALE;
+}
+
+void QuantizedWorkspace::Reserve(const QuantizedMlp& model, int64_t batch) {
+    if (batch <= capacity_) {
+        return;
+    }
+    Arena measure;
+    Bind(model, batch, measure);
+    arena_ = ArenaPool::Instance().Acquire(measure.Used(), MemoryCategory::WORKSPACE);
+    Bind(model, batch, *arena_);
+}
+
+void QuantizedWorkspace::Bind(const QuantizedMlp& model, int64_t batch, Arena& arena) {
+    const auto width = batch * model.Model().MaxWidth();
+    z = arena.Allocate<float>(width);
+    for (int i = 0; i < 2; ++i) {
+        act[i] = arena.Allocate<float>(width);
+        out[i] = arena.Allocate<float>(width);
+    }
+    ln_istd = arena.Allocate<float>(batch);
+    q = arena.Allocate<uint8_t>(width);
+    logits = arena.Allocate<float>(batch * model.Model().Spec().out_features);
+    capacity_ = arena.Measuring() ? 0 : batch;
+}
+
+QuantizedMlp::QuantizedMlp(const Mlp& model, Precision precision, const float* calibration, int64_t rows)
+    : model_(model), precision_(precision), layers_(model.Layers().size()) {
+    if (precision == Precision::FP32) {
+        throw std::runtime_error("Quantization needs precision bf16 or int8.");
+    }
+    const auto weights = Fold();
+    if (precision == Precision::INT8) {
+        if (rows <= 0) {
+            throw std::runtime_error("Int8 quantization needs calibration rows.");
+        }
+        std::vector<float> input_max(layers_.size(), 0.0f);
+        QuantizedWorkspace ws;
+        for (int64_t start = 0; start < rows; start += 1024) {
+            const auto count = std::min<int64_t>(1024, rows - start);
+            Run(calibration + start * model.Spec().in_features, count, ws, &weights, input_max.data());
+        }
+        for (size_t l = 0; l < layers_.size(); ++l) {
+            layers_[l].input_scale = input_max[l] / 127.0f;
+        }
+    }
+    Quantize(weights);
+}
+
+QuantizedMlp::QuantizedMlp(const Mlp& model, const std::vector<QuantizedTensor>& tensors)
+    : model_(model), precision_(Precision::FP32), layers_(model.Layers().size()) {
+    for (const auto& tensor : tensors) {
+        precision_ = tensor.kind == KIND_BF16 ? Precision::BF16 : Precision::INT8;
+    }
+    if (precision_ == Precision::FP32) {
+        throw std::runtime_error("No quantized tensors to load.");
+    }
+    Fold();
+    std::vector<int> loaded(layers_.size(), 0);
+    for (const auto& tensor : tensors) {
+        size_t l = 0;
+        while (l < layers_.size() && WeightName(l) != tensor.name) {
+            ++l;
+        }
+        const bool bf16 = tensor.kind == KIND_BF16;
+        if (l == layers_.size() || bf16 != (precision_ == Precision::BF16)) {
+            throw std::runtime_error("Quantized tensor '" + tensor.name + "' (" + tensor.kind +
+                                     ") does not match the model architecture.");
+        }
+        const auto& shape = model.Layers()[l];
+        auto& layer = layers_[l];
+        if (bf16) {
+            FromBytes(tensor.data, shape.in * shape.out, layer.bf16, tensor.name);
+        } else if (tensor.kind == KIND_INT8) {
+            FromBytes(tensor.data, shape.in * shape.out, layer.int8, tensor.name);
+        } else if (tensor.kind == KIND_INT8_SCALE) {
+            FromBytes(tensor.data, shape.out, layer.scale, tensor.name);
+        } else {
+            std::vector<float> scale;
+            FromBytes(tensor.data, 1, scale, tensor.name);
+            layer.input_scale = scale[0];
+        }
+        ++loaded[l];
+    }
+    const int expected = precision_ == Precision::BF16 ? 1 : 3;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        if (loaded[l] != expected) {
+            throw std::runtime_error("Quantized tensors of '" + WeightName(l) + "' are incomplete.");
+        }
+        auto& layer = layers_[l];
+        const auto in = model.Layers()[l].in;
+        layer.sum.assign(layer.scale.size(), 0);
+        for (size_t j = 0; j < layer.sum.size(); ++j) {
+            for (int64_t p = 0; p < in; ++p) {
+                layer.sum[j] += layer.int8[j * in + p];
+            }
+        }
+    }
+}
+
+std::vector<std::vector<float>> QuantizedMlp::Fold() {
+    const float* params = model_.Parameters().data();
+    const float* buffers = model_.Buffers().data();
+    std::vector<std::vector<float>> weights(layers_.size());
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& shape = model_.Layers()[l];
+        auto& weight = weights[l];
+        auto& bias = layers_[l].bias;
+        weight.assign(params + shape.weight, params + shape.weight + shape.in * shape.out);
+        bias.assign(params + shape.bias, params + shape.bias + shape.out);
+        if (shape.bn_gamma >= 0) {
+            kernels::FoldBatchNorm(shape.in, shape.out, shape.out, params + shape.weight, params + shape.bias,
+                                   params + shape.bn_gamma, params + shape.bn_beta, buffers + shape.running_mean,
+                                   buffers + shape.running_var, weight.data(), bias.data());
+        }
+    }
+    return weights;
+}
+
+void QuantizedMlp::Quantize(const std::vector<std::vector<float>>& weights) {
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto in = model_.Layers()[l].in;
+        const auto out = model_.Layers()[l].out;
+        const auto& weight = weights[l];
+        auto& layer = layers_[l];
+        if (precision_ == Precision::BF16) {
+            layer.bf16.resize(weight.size());
+            std::transform(weight.begin(), weight.end(), layer.bf16.begin(), FloatToBf16);
+            continue;
+        }
+        // 按输出通道对称量化, 转置为 [out, in] 使点积连续读取
+        layer.int8.resize(weight.size());
+        layer.scale.assign(out, 0.0f);
+        layer.sum.assign(out, 0);
+        for (int64_t j = 0; j < out; ++j) {
+            float max = 0.0f;
+            for (int64_t p = 0; p < in; ++p) {
+                max = std::max(max, std::abs(weight[p * out + j]));
+            }
+            const float scale = max / 127.0f;
+            const float inv = scale > 0.0f ? 1.0f / scale : 0.0f;
+            for (int64_t p = 0; p < in; ++p) {
+                const auto q = static_cast<int8_t>(std::nearbyint(weight[p * out + j] * inv));
+                layer.int8[j * in + p] = q;
+                layer.sum[j] += q;
+            }
+            layer.scale[j] = scale;
+        }
+    }
+}
+
+int64_t QuantizedMlp::WeightBytes() const {
+    int64_t bytes = 0;
+    for (const auto& layer : layers_) {
+        bytes += static_cast<int64_t>(layer.bf16.size() * sizeof(uint16_t) + layer.int8.size() +
+                                      layer.scale.size() * sizeof(float));
+    }
+    return bytes;
+}
+
+std::vector<QuantizedTensor> QuantizedMlp::Tensors() const {
+    std::vector<QuantizedTensor> tensors;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& layer = layers_[l];
+        if (precision_ == Precision::BF16) {
+            tensors.push_back({WeightName(l), KIND_BF16, Bytes(layer.bf16)});
+            continue;
+        }
+        tensors.push_back({WeightName(l), KIND_INT8, Bytes(layer.int8)});
+        tensors.push_back({WeightName(l), KIND_INT8_SCALE, Bytes(layer.scale)});
+        tensors.push_back({WeightName(l), KIND_INT8_INPUT_SCALE, Bytes(std::vector<float>{layer.input_scale})});
+    }
+    return tensors;
+}
+
+void QuantizedMlp::Linear(size_t l, const float* input, int64_t rows, QuantizedWorkspace& ws, float* z) const {
+    const auto& shape = model_.Layers()[l];
+    const auto& layer = layers_[l];
+    if (precision_ == Precision::BF16) {
+        kernels::LinearBf16(rows, shape.in, shape.out, input, layer.bf16.data(), layer.bias.data(), z);
+        return;
+    }
+    kernels::QuantizeActivations(rows * shape.in, input, layer.input_scale, ws.q.data());
+    kernels::LinearInt8(rows, shape.in, shape.out, ws.q.data(), layer.input_scale, layer.int8.data(),
+                        layer.sum.data(), layer.scale.data(), layer.bias.data(), z);
+}
+
+const float* QuantizedMlp::Run(const float* x, int64_t rows, QuantizedWorkspace& ws,
+                               const std::vector<std::vector<float>>* fp32, float* input_max) const {
+    ws.Reserve(*this, rows);
+    const float* params = model_.Parameters().data();
+    const float* input = x;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& shape = model_.Layers()[l];
+        float* z = shape.hidden ? ws.z.data() : ws.logits.data();
+        if (fp32) {
+            // 校准: 用折叠后的 fp32 权重前向, 记录每层输入的范围
+            for (int64_t i = 0; i < rows * shape.in; ++i) {
+                input_max[l] = std::max(input_max[l], std::abs(input[i]));
+            }
+            kernels::Linear(rows, shape.in, shape.out, input, (*fp32)[l].data(), layers_[l].bias.data(), z);
+        } else {
+            Linear(l, input, rows, ws, z);
+        }
+        if (!shape.hidden) {
+            break;
+        }
+        // 与 Mlp::Forward 的评估路径相同, 两组输出缓冲交替使用, 残差读取的上一层输出不会被覆盖
+        kernels::NormActForwardArgs args;
+        args.act = ws.act[l % 2].data();
+        if (shape.ln_gamma >= 0) {
+            args.ln_gamma = params + shape.ln_gamma;
+            args.ln_beta = params + shape.ln_beta;
+            args.ln_istd = ws.ln_istd.data();
+        }
+        if (shape.skip) {
+            args.skip = input;
+            args.out = ws.out[l % 2].data();
+        }
+        kernels::NormActForward(rows, shape.out, shape.out, z, args);
+        input = shape.skip ? args.out : args.act;
+    }
+    return ws.logits.data();
+}
+
+const float* QuantizedMlp::Forward(const float* x, int64_t rows, QuantizedWorkspace& ws) const {
+    return Run(x, rows, ws, nullptr, nullptr);
+}
+
+// 两边各自重复前向直到累计超过 MIN_SECONDS, 取吞吐
+CompressionReport CompareCompressed(Mlp& model, const std::function<const float*(const float*, int64_t)>& forward,
+                                    int64_t compressed_bytes, const float* x, const float* y, int64_t rows) {
+    constexpr double MIN_SECONDS = 0.2;
+    CompressionReport report;
+    report.compressed_bytes = compressed_bytes;
+    for (const auto& layer : model.Layers()) {
+        report.fp32_bytes += layer.in * layer.out * static_cast<int64_t>(sizeof(float));
+    }
+    if (rows <= 0) {
+        return report;
+    }
+    const auto classes = model.Spec().out_features;
+    MlpWorkspace ws;
+    std::mt19937 unused;
+
+    auto throughput = [&](auto&& run) {
+        int64_t scored = 0;
+        const auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do {
+            run();
+            scored += rows;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < MIN_SECONDS);
+        return static_cast<double>(scored) / seconds;
+    };
+    report.fp32_rows_per_second = throughput([&]() { model.Forward(x, rows, false, ws, unused); });
+    const float* actual = nullptr;
+    report.compressed_rows_per_second = throughput([&]() { actual = forward(x, rows); });
+
+    const float* expected = ws.logits.data();
+    report.fp32_loss = model.Loss(expected, y, rows, nullptr) / static_cast<double>(rows);
+    report.compressed_loss = model.Loss(actual, y, rows, nullptr) / static_cast<double>(rows);
+    double delta = 0.0;
+    for (int64_t row = 0; row < rows; ++row) {
+        if (classes == 1) {
+            delta += std::abs(expected[row] - actual[row]);
+            continue;
+        }
+        const float* a = expected + row * classes;
+        const float* b = actual + row * classes;
+        delta += (std::max_element(a, a + classes) - a) != (std::max_element(b, b + classes) - b) ? 1.0 : 0.0;
+    }
+    report.prediction_delta = delta / static_cast<double>(rows);
+    return report;
+}
+
+} // namespace regdb
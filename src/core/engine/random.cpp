@@ -0,0 +1,53 @@
+#include "regdb/core/engine/random.hpp"
+
+namespace regdb {
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9u;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85u;
+constexpr int64_t PHILOX_LANES = Philox::BLOCK / 4;
+constexpr int PHILOX_ROUNDS = 10;
+
+} // namespace
+
+void Philox::Block(uint64_t key, uint64_t counter, uint32_t* out) {
+    uint32_t c0[PHILOX_LANES];
+    uint32_t c1[PHILOX_LANES];
+    uint32_t c2[PHILOX_LANES];
+    uint32_t c3[PHILOX_LANES];
+    for (int64_t l = 0; l < PHILOX_LANES; ++l) {
+        const auto value = counter + static_cast<uint64_t>(l);
+        c0[l] = static_cast<uint32_t>(value);
+        c1[l] = static_cast<uint32_t>(value >> 32);
+        c2[l] = 0;
+        c3[l] = 0;
+    }
+    auto k0 = static_cast<uint32_t>(key);
+    auto k1 = static_cast<uint32_t>(key >> 32);
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        for (int64_t l = 0; l < PHILOX_LANES; ++l) {
+            const uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0[l];
+            const uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2[l];
+            const auto n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+            const auto n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+            c1[l] = static_cast<uint32_t>(p1);
+            c3[l] = static_cast<uint32_t>(p0);
+            c0[l] = n0;
+            c2[l] = n2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    // 按字输出: out[w * 16 + l] 为第 l 个计数器的第 w 个字
+    for (int64_t l = 0; l < PHILOX_LANES; ++l) {
+        out[l] = c0[l];
+        out[PHILOX_LANES + l] = c1[l];
+        out[2 * PHILOX_LANES + l] = c2[l];
+        out[3 * PHILOX_LANES + l] = c3[l];
+    }
+}
+
+} // namespace regdb
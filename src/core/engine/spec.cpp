@@ -0,0 +1,259 @@
+#include "regdb/core/engine/spec.hpp"
+#include "regdb/core/engine/model_type.hpp"
+#include "regdb/core/engine/preprocess.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+const std::vector<std::string>& RegFlagNames() {
+    static const std::vector<std::string> names = {
+        "use_weight_decay", "use_dropout", "use_bn", "use_ln",
+        "use_skip", "use_data_augment", "use_swa", "use_lookahead"
+    };
+    return names;
+}
+
+bool& RegFlag(RegConfig& config, const std::string& name) {
+    if (name == "use_weight_decay") return config.use_weight_decay;
+    if (name == "use_dropout") return config.use_dropout;
+    if (name == "use_bn") return config.use_bn;
+    if (name == "use_ln") return config.use_ln;
+    if (name == "use_skip") return config.use_skip;
+    if (name == "use_data_augment") return config.use_data_augment;
+    if (name == "use_swa") return config.use_swa;
+    if (name == "use_lookahead") return config.use_lookahead;
+    throw std::runtime_error("Unknown reg_args key: " + name);
+}
+
+const std::vector<AugmentOp>& AugmentOps() {
+    static const std::vector<AugmentOp> ops = {AugmentOp::MIXUP, AugmentOp::CUTMIX, AugmentOp::NOISE};
+    return ops;
+}
+
+} // namespace
+
+AugmentOp AugmentOpFromString(const std::string& name) {
+    if (name == "mixup") return AugmentOp::MIXUP;
+    if (name == "cutmix") return AugmentOp::CUTMIX;
+    if (name == "noise") return AugmentOp::NOISE;
+    throw std::runtime_error("Unknown augment op: " + name + ", expected mixup, cutmix or noise.");
+}
+
+std::string AugmentOpToString(AugmentOp op) {
+    switch (op) {
+    case AugmentOp::MIXUP:
+        return "mixup";
+    case AugmentOp::CUTMIX:
+        return "cutmix";
+    case AugmentOp::NOISE:
+        return "noise";
+    }
+    return "mixup";
+}
+
+float DefaultAugmentStrength(AugmentOp op) {
+    switch (op) {
+    case AugmentOp::MIXUP:
+        return 0.2f;
+    case AugmentOp::CUTMIX:
+        return 0.2f;
+    case AugmentOp::NOISE:
+        return 0.1f;
+    }
+    return 0.2f;
+}
+
+ModelSpec ModelSpec::FromJson(const std::string& model_type, const nlohmann::json& model_args) {
+    const auto& type = ModelTypeRegistry::Instance().Get(model_type);
+    type.CheckArgs(model_args);
+    ModelSpec spec;
+    spec.model_type = model_type;
+    spec.in_features = model_args.at("in_features").get<int64_t>();
+    spec.out_features = model_args.at("out_features").get<int64_t>();
+    spec.hidden_features = model_args.at("hidden_features").get<std::vector<int64_t>>();
+    spec.hogwild = model_args.value("hogwild", false);
+    spec.folds = model_args.value("folds", int64_t(1));
+    if (spec.folds < 1) {
+        throw std::runtime_error("folds must be positive.");
+    }
+    // 未设置或 false 关闭, true 使用默认值, 对象中可以覆盖 patience / min_delta / extrapolate
+    const auto early_stopping = model_args.value("early_stopping", nlohmann::json(false));
+    if (early_stopping.is_boolean()) {
+        spec.early_stopping = early_stopping.get<bool>() ? EarlyStopSpec::DefaultForSearch() : EarlyStopSpec();
+    } else if (early_stopping.is_object()) {
+        const auto defaults = EarlyStopSpec::DefaultForSearch();
+        spec.early_stopping.patience = early_stopping.value("patience", defaults.patience);
+        spec.early_stopping.min_delta = early_stopping.value("min_delta", defaults.min_delta);
+        spec.early_stopping.extrapolate = early_stopping.value("extrapolate", defaults.extrapolate);
+        if (spec.early_stopping.patience < 0 || spec.early_stopping.min_delta < 0.0) {
+            throw std::runtime_error("early_stopping patience and min_delta must not be negative.");
+        }
+    } else {
+        throw std::runtime_error("early_stopping must be a boolean or an object.");
+    }
+    // true 表示所有列自动选择变换, 对象中可以为部分列指定变换
+    const auto preprocess = model_args.value("preprocess", nlohmann::json());
+    if (preprocess.is_boolean()) {
+        spec.preprocess = preprocess.get<bool>() ? nlohmann::json::object() : nlohmann::json();
+    } else if (preprocess.is_object()) {
+        for (auto it = preprocess.begin(); it != preprocess.end(); ++it) {
+            FeatureTransformFromString(it.value().get<std::string>());
+        }
+        spec.preprocess = preprocess;
+    } else if (!preprocess.is_null()) {
+        throw std::runtime_error("preprocess must be a boolean or an object of column transforms.");
+    }
+    if (spec.in_features <= 0 || spec.out_features <= 0) {
+        throw std::runtime_error("in_features and out_features must be positive.");
+    }
+    for (auto width : spec.hidden_features) {
+        if (width <= 0) {
+            throw std::runtime_error("hidden_features must be positive.");
+        }
+    }
+    type.Configure(spec);
+    return spec;
+}
+
+nlohmann::json ModelSpec::ToJson() const {
+    nlohmann::json json = {
+        {"in_features", in_features},
+        {"out_features", out_features},
+        {"hidden_features", hidden_features}
+    };
+    if (hogwild) {
+        json["hogwild"] = true;
+    }
+    if (folds > 1) {
+        json["folds"] = folds;
+    }
+    if (early_stopping.Enabled()) {
+        const auto defaults = EarlyStopSpec::DefaultForSearch();
+        if (early_stopping.patience != defaults.patience || early_stopping.min_delta != defaults.min_delta ||
+            early_stopping.extrapolate != defaults.extrapolate) {
+            json["early_stopping"] = {
+                {"patience", early_stopping.patience},
+                {"min_delta", early_stopping.min_delta},
+                {"extrapolate", early_stopping.extrapolate}
+            };
+        } else {
+            json["early_stopping"] = true;
+        }
+    }
+    if (!preprocess.is_null()) {
+        json["preprocess"] = preprocess;
+    }
+    return json;
+}
+
+// ToJson 的逆过程, 缺省的开关为关闭
+RegConfig RegConfig::FromJson(const nlohmann::json& reg_args) {
+    RegConfig config;
+    for (auto it = reg_args.begin(); it != reg_args.end(); ++it) {
+        if (it.key() == "augment") {
+            config.augment = AugmentOpFromString(it.value().get<std::string>());
+        } else if (it.key() == "augment_strength") {
+            config.augment_strength = it.value().get<float>();
+        } else {
+            RegFlag(config, it.key()) = it.value().get<bool>();
+        }
+    }
+    return config;
+}
+
+nlohmann::json RegConfig::ToJson() const {
+    nlohmann::json json;
+    auto copy = *this;
+    for (const auto& name : RegFlagNames()) {
+        json[name] = RegFlag(copy, name);
+    }
+    if (use_data_augment) {
+        json["augment"] = AugmentOpToString(augment);
+        json["augment_strength"] = augment_strength;
+    }
+    return json;
+}
+
+RegSpace RegSpace::FromJson(const nlohmann::json& reg_args) {
+    RegSpace space;
+    for (auto it = reg_args.begin(); it != reg_args.end(); ++it) {
+        RegConfig probe;
+        RegFlag(probe, it.key());   // 校验 key
+        if (it.key() == "use_data_augment" && it.value().is_object()) {
+            const auto& augment = it.value();
+            std::vector<AugmentOp> ops;
+            for (const auto& name : augment.value("ops", nlohmann::json::array())) {
+                ops.push_back(AugmentOpFromString(name.get<std::string>()));
+            }
+            if (ops.empty()) {
+                ops = AugmentOps();
+            }
+            const auto strengths = augment.value("strength", std::vector<float>());
+            for (auto op : ops) {
+                if (strengths.empty()) {
+                    space.augments_.emplace_back(op, DefaultAugmentStrength(op));
+                }
+                for (auto strength : strengths) {
+                    if (strength <= 0.0f) {
+                        throw std::runtime_error("use_data_augment strength must be positive.");
+                    }
+                    space.augments_.emplace_back(op, strength);
+                }
+            }
+            space.searchable_.push_back(it.key());
+            continue;
+        }
+        if (it.value().get<bool>()) {
+            space.searchable_.push_back(it.key());
+            if (it.key() == "use_data_augment") {
+                for (auto op : AugmentOps()) {
+                    space.augments_.emplace_back(op, DefaultAugmentStrength(op));
+                }
+            }
+        }
+    }
+    return space;
+}
+
+void RegSpace::Fix(const std::string& name, bool value) {
+    RegConfig probe;
+    RegFlag(probe, name);   // 校验 key
+    searchable_.erase(std::remove(searchable_.begin(), searchable_.end(), name), searchable_.end());
+    if (name == "use_data_augment") {
+        // 固定开启时使用第一种方式的默认强度
+        augments_.assign(1, {AugmentOps()[0], DefaultAugmentStrength(AugmentOps()[0])});
+    }
+    fixed_.emplace_back(name, value);
+}
+
+std::vector<RegConfig> RegSpace::Enumerate() const {
+    std::vector<RegConfig> configs;
+    const auto count = size_t(1) << searchable_.size();
+    configs.reserve(count);
+    for (size_t mask = 0; mask < count; ++mask) {
+        RegConfig config;
+        for (const auto& flag : fixed_) {
+            RegFlag(config, flag.first) = flag.second;
+        }
+        for (size_t bit = 0; bit < searchable_.size(); ++bit) {
+            RegFlag(config, searchable_[bit]) = (mask >> bit) & 1;
+        }
+        if (!config.use_data_augment) {
+            configs.push_back(config);
+            continue;
+        }
+        // 开启增强的配置按增强方式和强度继续展开
+        for (const auto& augment : augments_) {
+            config.augment = augment.first;
+            config.augment_strength = augment.second;
+            configs.push_back(config);
+        }
+    }
+    return configs;
+}
+
+} // namespace regdb
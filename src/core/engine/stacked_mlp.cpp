@@ -0,0 +1,480 @@
+#include "regdb/core/engine/stacked_mlp.hpp"
+#include "regdb/core/engine/kernels.hpp"
+#include "regdb/core/engine/random.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+constexpr float BN_MOMENTUM = 0.1f;
+constexpr int DROPOUT_LAYER_SHIFT = 40;
+
+// 遍历 trial 在单模型与堆叠存储中对应的张量, f(stacked_offset, single_offset, rows, width, is_buffer)
+template <class F>
+void VisitTrialTensors(const std::vector<LayerShape>& stacked, const std::vector<LayerShape>& single, F&& f) {
+    for (size_t l = 0; l < stacked.size(); ++l) {
+        const auto& st = stacked[l];
+        const auto& sl = single[l];
+        f(st.weight, sl.weight, st.in, st.out, false);
+        f(st.bias, sl.bias, int64_t(1), st.out, false);
+        if (sl.bn_gamma >= 0) {
+            f(st.bn_gamma, sl.bn_gamma, int64_t(1), st.out, false);
+            f(st.bn_beta, sl.bn_beta, int64_t(1), st.out, false);
+            f(st.running_mean, sl.running_mean, int64_t(1), st.out, true);
+            f(st.running_var, sl.running_var, int64_t(1), st.out, true);
+        }
+        if (sl.ln_gamma >= 0) {
+            f(st.ln_gamma, sl.ln_gamma, int64_t(1), st.out, false);
+            f(st.ln_beta, sl.ln_beta, int64_t(1), st.out, false);
+        }
+    }
+}
+
+} // namespace
+
+void StackedWorkspace::Reserve(const StackedMlp& model, int64_t batch) {
+    if (batch <= capacity_ && layers.size() == static_cast<int64_t>(model.Layers().size())) {
+        return;
+    }
+    Arena measure;
+    StackedWorkspace layout;
+    layout.Bind(model, batch, measure);
+    arena_ = ArenaPool::Instance().Acquire(measure.Used(), MemoryCategory::WORKSPACE);
+    Bind(model, batch, *arena_);
+}
+
+void StackedWorkspace::Bind(const StackedMlp& model, int64_t batch, Arena& arena) {
+    const auto trials = model.Trials();
+    const auto count = static_cast<int64_t>(model.Layers().size());
+    layers = arena.Allocate<LayerCache>(count);
+    int64_t pack_floats = 0;
+    for (int64_t l = 0; l < count; ++l) {
+        const auto& layer = model.Layers()[l];
+        pack_floats = std::max(pack_floats, layer.in * trials * layer.out);
+        LayerCache cache;
+        if (layer.hidden) {
+            const auto width = trials * layer.out;
+            const auto size = batch * width;
+            cache.z = arena.Allocate<float>(size);
+            cache.act = arena.Allocate<float>(size);
+            if (model.AnyBatchNorm()) {
+                cache.bn_xhat = arena.Allocate<float>(size);
+                cache.bn_mean = arena.Allocate<float>(width);
+                cache.bn_var = arena.Allocate<float>(width);
+                cache.bn_istd = arena.Allocate<float>(width);
+            }
+            if (model.AnyLayerNorm()) {
+                cache.ln_xhat = arena.Allocate<float>(size);
+                cache.ln_istd = arena.Allocate<float>(trials * batch);
+            }
+            if (model.AnySkip(l)) {
+                cache.out = arena.Allocate<float>(size);
+            }
+        }
+        if (!arena.Measuring()) {
+            new (&layers[l]) LayerCache(cache);
+        }
+    }
+    logits = arena.Allocate<float>(batch * trials * model.Spec().out_features);
+    dlogits = arena.Allocate<float>(batch * trials * model.Spec().out_features);
+    grad_a = arena.Allocate<float>(batch * trials * model.MaxWidth());
+    grad_b = arena.Allocate<float>(batch * trials * model.MaxWidth());
+    x = arena.Allocate<float>(batch * model.Spec().in_features);
+    y = arena.Allocate<float>(batch);
+    losses = arena.Allocate<double>(trials);
+    folded = model.AnyBatchNorm() ? arena.Allocate<float>(static_cast<int64_t>(model.Parameters().size()))
+                                  : Span<float>();
+    capacity_ = batch;
+    if (!arena.Measuring()) {
+        kernels::ReservePackScratch(pack_floats);
+    }
+}
+
+void StackedWorkspace::FoldBatchNorm(const StackedMlp& model) {
+    if (!model.AnyBatchNorm()) {
+        return;
+    }
+    const auto trials = model.Trials();
+    const float* params = model.Parameters().data();
+    const float* buffers = model.Buffers().data();
+    for (const auto& layer : model.Layers()) {
+        if (!layer.hidden) {
+            continue;
+        }
+        const auto width = trials * layer.out;
+        for (int64_t k = 0; k < trials; ++k) {
+            const auto col = k * layer.out;
+            if (model.Configs()[k].use_bn) {
+                kernels::FoldBatchNorm(layer.in, layer.out, width, params + layer.weight + col,
+                                       params + layer.bias + col, params + layer.bn_gamma + col,
+                                       params + layer.bn_beta + col, buffers + layer.running_mean + col,
+                                       buffers + layer.running_var + col, folded.data() + layer.weight + col,
+                                       folded.data() + layer.bias + col);
+                continue;
+            }
+            for (int64_t p = 0; p < layer.in; ++p) {
+                std::memcpy(folded.data() + layer.weight + p * width + col, params + layer.weight + p * width + col,
+                            sizeof(float) * layer.out);
+            }
+            std::memcpy(folded.data() + layer.bias + col, params + layer.bias + col, sizeof(float) * layer.out);
+        }
+    }
+}
+
+StackedMlp::StackedMlp(const ModelSpec& spec, const std::vector<RegConfig>& configs,
+                       const std::vector<uint64_t>& seeds)
+    : spec_(spec), configs_(configs), seeds_(seeds) {
+    if (configs.empty() || configs.size() != seeds.size()) {
+        throw std::runtime_error("StackedMlp expects one seed per configuration.");
+    }
+    for (const auto& config : configs) {
+        any_bn_ = any_bn_ || config.use_bn;
+        any_ln_ = any_ln_ || config.use_ln;
+        any_dropout_ = any_dropout_ || config.use_dropout;
+    }
+
+    const auto trials = Trials();
+    auto in = spec.in_features;
+    max_width_ = std::max(spec.in_features, spec.out_features);
+    for (size_t l = 0; l <= spec.hidden_features.size(); ++l) {
+        LayerShape layer;
+        layer.in = in;
+        layer.hidden = l < spec.hidden_features.size();
+        layer.out = layer.hidden ? spec.hidden_features[l] : spec.out_features;
+
+        const auto prefix = "layers." + std::to_string(l) + ".";
+        layer.weight = AddSlot(prefix + "weight", layer.in, layer.out, true);
+        layer.bias = AddSlot(prefix + "bias", 1, layer.out, false);
+        if (layer.hidden && any_bn_) {
+            layer.bn_gamma = AddSlot(prefix + "bn.weight", 1, layer.out, false);
+            layer.bn_beta = AddSlot(prefix + "bn.bias", 1, layer.out, false);
+            layer.running_mean = static_cast<int64_t>(buffers_.size());
+            buffers_.resize(buffers_.size() + trials * layer.out, 0.0f);
+            layer.running_var = static_cast<int64_t>(buffers_.size());
+            buffers_.resize(buffers_.size() + trials * layer.out, 1.0f);
+        }
+        if (layer.hidden && any_ln_) {
+            layer.ln_gamma = AddSlot(prefix + "ln.weight", 1, layer.out, false);
+            layer.ln_beta = AddSlot(prefix + "ln.bias", 1, layer.out, false);
+        }
+
+        std::vector<bool> skip(trials, false);
+        for (int64_t k = 0; k < trials; ++k) {
+            skip[k] = layer.hidden && (configs[k].use_skip || spec.residual) && layer.in == layer.out;
+        }
+        skip_.push_back(skip);
+        layers_.push_back(layer);
+        max_width_ = std::max(max_width_, layer.out);
+        in = layer.out;
+    }
+
+    const auto& last = slots_.back();
+    params_.assign(last.offset + last.rows * trials * last.width, 0.0f);
+    grads_.assign(params_.size(), 0.0f);
+    // 未启用归一化的 trial 的 gamma 也置 1, 保证列块内容有意义
+    for (const auto& layer : layers_) {
+        if (layer.bn_gamma >= 0) {
+            std::fill_n(params_.data() + layer.bn_gamma, trials * layer.out, 1.0f);
+        }
+        if (layer.ln_gamma >= 0) {
+            std::fill_n(params_.data() + layer.ln_gamma, trials * layer.out, 1.0f);
+        }
+    }
+
+    // 用单模型的初始化写入各自的列块, 保证与单独训练的 trial 等价
+    for (int64_t k = 0; k < trials; ++k) {
+        Mlp model(spec, configs[k], seeds[k]);
+        const float* single_params = model.Parameters().data();
+        const float* single_buffers = model.Buffers().data();
+        VisitTrialTensors(layers_, model.Layers(),
+                          [&](int64_t stacked, int64_t single, int64_t rows, int64_t width, bool buffer) {
+            float* dst = (buffer ? buffers_.data() : params_.data()) + stacked;
+            const float* src = (buffer ? single_buffers : single_params) + single;
+            for (int64_t r = 0; r < rows; ++r) {
+                std::memcpy(dst + r * trials * width + k * width, src + r * width, sizeof(float) * width);
+            }
+        });
+    }
+}
+
+int64_t StackedMlp::AddSlot(const std::string& name, int64_t rows, int64_t width, bool decay) {
+    const auto offset = slots_.empty() ? int64_t(0)
+                                       : slots_.back().offset + slots_.back().rows * Trials() * slots_.back().width;
+    slots_.push_back({name, offset, rows, width, decay});
+    return offset;
+}
+
+bool StackedMlp::AnySkip(size_t layer) const {
+    const auto& skip = skip_[layer];
+    return std::find(skip.begin(), skip.end(), true) != skip.end();
+}
+
+const float* StackedMlp::LayerOutput(size_t l, const StackedWorkspace& ws) const {
+    return AnySkip(l) ? ws.layers[l].out.data() : ws.layers[l].act.data();
+}
+
+Mlp StackedMlp::Extract(int64_t trial) const {
+    Mlp model(spec_, configs_[trial], seeds_[trial]);
+    const auto trials = Trials();
+    float* single_params = model.Parameters().data();
+    float* single_buffers = model.Buffers().data();
+    VisitTrialTensors(layers_, model.Layers(),
+                      [&](int64_t stacked, int64_t single, int64_t rows, int64_t width, bool buffer) {
+        const float* src = (buffer ? buffers_.data() : params_.data()) + stacked;
+        float* dst = (buffer ? single_buffers : single_params) + single;
+        for (int64_t r = 0; r < rows; ++r) {
+            std::memcpy(dst + r * width, src + r * trials * width + trial * width, sizeof(float) * width);
+        }
+    });
+    return model;
+}
+
+void StackedMlp::Insert(int64_t trial, const Mlp& model) {
+    const auto& spec = model.Spec();
+    const auto& config = model.Config();
+    if (spec.in_features != spec_.in_features || spec.out_features != spec_.out_features ||
+        spec.hidden_features != spec_.hidden_features || config.use_bn != configs_[trial].use_bn ||
+        config.use_ln != configs_[trial].use_ln) {
+        throw std::runtime_error("Model does not match the stacked architecture.");
+    }
+    const auto trials = Trials();
+    const float* single_params = model.Parameters().data();
+    const float* single_buffers = model.Buffers().data();
+    VisitTrialTensors(layers_, model.Layers(),
+                      [&](int64_t stacked, int64_t single, int64_t rows, int64_t width, bool buffer) {
+        const float* src = (buffer ? single_buffers : single_params) + single;
+        float* dst = (buffer ? buffers_.data() : params_.data()) + stacked;
+        for (int64_t r = 0; r < rows; ++r) {
+            std::memcpy(dst + r * trials * width + trial * width, src + r * width, sizeof(float) * width);
+        }
+    });
+}
+
+void StackedMlp::Forward(const float* x, int64_t batch, bool training, StackedWorkspace& ws, std::mt19937& rng,
+                         bool update_stats) {
+    ws.Reserve(*this, batch);
+    // 与 Mlp 相同, 评估时把 BN 折叠进 Linear, 参数可能在两次调用之间被改写, 每次重新折叠
+    const bool fold = any_bn_ && !training;
+    if (fold) {
+        ws.FoldBatchNorm(*this);
+    }
+    const float* source = fold ? ws.folded.data() : params_.data();
+    // 掩码由 (key, 层号, trial, 行) 现场生成, 反向时被丢弃的位置 act 为 0, 不需要保存
+    uint64_t dropout_key = 0;
+    if (training && any_dropout_) {
+        dropout_key = (static_cast<uint64_t>(rng()) << 32) | rng();
+    }
+    const auto trials = Trials();
+    const float* input = x;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& layer = layers_[l];
+        const auto width = trials * layer.out;
+        // 折叠只覆盖隐藏层
+        const float* weight = (layer.hidden ? source : params_.data()) + layer.weight;
+        const float* bias = (layer.hidden ? source : params_.data()) + layer.bias;
+        float* z = layer.hidden ? ws.layers[l].z.data() : ws.logits.data();
+
+        if (l == 0 && !kernels::IsFixedWidth(layer.out)) {
+            // 第一层所有 trial 共享输入, 单个 trial 的宽度没有特化内核时合并为一次 Linear
+            kernels::Linear(batch, layer.in, width, x, layer.in, weight, width, bias, z, width);
+        } else {
+            // 每个 trial 的列块单独经过 Linear, 宽度为 64/128/256/512 时使用特化内核
+            const auto ldx = l == 0 ? layer.in : trials * layer.in;
+            for (int64_t k = 0; k < trials; ++k) {
+                const float* in = l == 0 ? x : input + k * layer.in;
+                kernels::Linear(batch, layer.in, layer.out, in, ldx, weight + k * layer.out, width,
+                                bias + k * layer.out, z + k * layer.out, width);
+            }
+        }
+        if (!layer.hidden) {
+            break;
+        }
+
+        auto& cache = ws.layers[l];
+        const auto row_counters = Philox::Counters(layer.out);
+        for (int64_t k = 0; k < trials; ++k) {
+            const auto& config = configs_[k];
+            const auto col = k * layer.out;
+            kernels::NormActForwardArgs args;
+            args.act = cache.act.data() + col;
+            if (config.use_bn && training) {
+                kernels::BatchNormStatistics(batch, layer.out, width, z + col, cache.bn_mean.data() + col,
+                                             cache.bn_var.data() + col, cache.bn_istd.data() + col,
+                                             update_stats ? buffers_.data() + layer.running_mean + col : nullptr,
+                                             update_stats ? buffers_.data() + layer.running_var + col : nullptr,
+                                             BN_MOMENTUM);
+                args.bn_mean = cache.bn_mean.data() + col;
+                args.bn_istd = cache.bn_istd.data() + col;
+                args.bn_gamma = params_.data() + layer.bn_gamma + col;
+                args.bn_beta = params_.data() + layer.bn_beta + col;
+                args.bn_xhat = cache.bn_xhat.data() + col;
+            }
+            if (config.use_ln) {
+                args.ln_gamma = params_.data() + layer.ln_gamma + col;
+                args.ln_beta = params_.data() + layer.ln_beta + col;
+                args.ln_xhat = training ? cache.ln_xhat.data() + col : nullptr;
+                args.ln_istd = cache.ln_istd.data() + k * batch;
+            }
+            if (config.use_dropout && training) {
+                // 每层、每个 trial 使用不相交的计数器区间
+                args.dropout_rate = config.dropout_rate;
+                args.dropout_key = dropout_key;
+                args.dropout_counter = (static_cast<uint64_t>(l) << DROPOUT_LAYER_SHIFT) +
+                                       static_cast<uint64_t>(k * batch * row_counters);
+            }
+            if (skip_[l][k]) {
+                args.skip = input + k * layer.in;
+                args.out = cache.out.data() + col;
+            }
+            kernels::NormActForward(batch, layer.out, width, z + col, args);
+            if (AnySkip(l) && !skip_[l][k]) {
+                // 同一层有残差的 trial 时, 其余列块原样拷贝进 out
+                float* out = cache.out.data();
+                for (int64_t i = 0; i < batch; ++i) {
+                    std::memcpy(out + i * width + col, cache.act.data() + i * width + col,
+                                sizeof(float) * layer.out);
+                }
+            }
+        }
+        input = LayerOutput(l, ws);
+    }
+}
+
+void StackedMlp::Backward(const float* x, int64_t batch, StackedWorkspace& ws) {
+    std::fill(grads_.begin(), grads_.end(), 0.0f);
+    const auto trials = Trials();
+    float* d = ws.grad_a.data();
+    float* d_next = ws.grad_b.data();
+
+    for (auto l = static_cast<int64_t>(layers_.size()) - 1; l >= 0; --l) {
+        const auto& layer = layers_[l];
+        const auto width = trials * layer.out;
+        const auto in_width = trials * layer.in;
+        const float* weight = params_.data() + layer.weight;
+        float* dweight = grads_.data() + layer.weight;
+
+        float* dz = d;
+        if (!layer.hidden) {
+            dz = ws.dlogits.data();
+        } else {
+            auto& cache = ws.layers[l];
+            for (int64_t k = 0; k < trials; ++k) {
+                const auto& config = configs_[k];
+                const auto col = k * layer.out;
+                // 残差梯度先拷贝到下一层梯度, 之后的 GEMM 以 beta = 1 累加
+                if (skip_[l][k]) {
+                    for (int64_t i = 0; i < batch; ++i) {
+                        std::memcpy(d_next + i * in_width + k * layer.in, d + i * width + col,
+                                    sizeof(float) * layer.out);
+                    }
+                }
+                kernels::NormActBackwardArgs args;
+                args.act = cache.act.data() + col;
+                args.dropout_scale = config.use_dropout ? 1.0f / (1.0f - config.dropout_rate) : 0.0f;
+                if (config.use_ln) {
+                    args.ln_xhat = cache.ln_xhat.data() + col;
+                    args.ln_istd = cache.ln_istd.data() + k * batch;
+                    args.ln_gamma = params_.data() + layer.ln_gamma + col;
+                    args.ln_dgamma = grads_.data() + layer.ln_gamma + col;
+                    args.ln_dbeta = grads_.data() + layer.ln_beta + col;
+                }
+                if (config.use_bn) {
+                    args.bn_xhat = cache.bn_xhat.data() + col;
+                    args.bn_istd = cache.bn_istd.data() + col;
+                    args.bn_gamma = params_.data() + layer.bn_gamma + col;
+                    args.bn_dgamma = grads_.data() + layer.bn_gamma + col;
+                    args.bn_dbeta = grads_.data() + layer.bn_beta + col;
+                    args.bn_sum = cache.bn_mean.data() + col;
+                    args.bn_dot = cache.bn_var.data() + col;
+                }
+                kernels::NormActBackward(batch, layer.out, width, d + col, args);
+            }
+        }
+
+        if (l == 0) {
+            kernels::Gemm(true, false, layer.in, width, batch, 1.0f, x, layer.in, dz, width, 1.0f, dweight, width);
+        } else {
+            const float* input = LayerOutput(l - 1, ws);
+            for (int64_t k = 0; k < trials; ++k) {
+                kernels::Gemm(true, false, layer.in, layer.out, batch, 1.0f, input + k * layer.in, in_width,
+                              dz + k * layer.out, width, 1.0f, dweight + k * layer.out, width);
+            }
+        }
+        kernels::ColumnSum(batch, width, dz, grads_.data() + layer.bias);
+        if (l > 0) {
+            for (int64_t k = 0; k < trials; ++k) {
+                kernels::Gemm(false, true, batch, layer.in, layer.out, 1.0f, dz + k * layer.out, width,
+                              weight + k * layer.out, width, skip_[l][k] ? 1.0f : 0.0f, d_next + k * layer.in,
+                              in_width);
+            }
+            std::swap(d, d_next);
+        }
+    }
+}
+
+void StackedMlp::Loss(const float* y, int64_t batch, StackedWorkspace& ws, bool gradient, double* losses) const {
+    const auto trials = Trials();
+    const auto classes = spec_.out_features;
+    for (int64_t k = 0; k < trials; ++k) {
+        const float* logits = ws.logits.data() + k * classes;
+        float* dlogits = gradient ? ws.dlogits.data() + k * classes : nullptr;
+        if (IsRegression()) {
+            losses[k] = kernels::MseLoss(batch, logits, trials, y, dlogits);
+        } else {
+            losses[k] = kernels::SoftmaxCrossEntropy(batch, classes, logits, trials * classes, y, dlogits);
+        }
+    }
+}
+
+void StackedMlp::TrainStep(const float* x, const float* y, int64_t batch, StackedWorkspace& ws, std::mt19937& rng,
+                           double* losses) {
+    Forward(x, batch, true, ws, rng);
+    Loss(y, batch, ws, true, losses);
+    Backward(x, batch, ws);
+    for (int64_t k = 0; k < Trials(); ++k) {
+        losses[k] /= static_cast<double>(batch);
+    }
+}
+
+void StackedMlp::RecomputeBatchNorm(const float* x, int64_t batch, StackedWorkspace& ws,
+                                    const std::vector<bool>& trials) {
+    if (!any_bn_ || batch <= 0) {
+        return;
+    }
+    std::mt19937 rng(static_cast<uint32_t>(batch));
+    Forward(x, batch, true, ws, rng, false);
+    const float unbias = batch > 1 ? static_cast<float>(batch) / static_cast<float>(batch - 1) : 1.0f;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const auto& layer = layers_[l];
+        if (!layer.hidden) {
+            continue;
+        }
+        const auto& cache = ws.layers[l];
+        for (int64_t k = 0; k < Trials(); ++k) {
+            if (!trials[k] || !configs_[k].use_bn) {
+                continue;
+            }
+            const auto col = k * layer.out;
+            for (int64_t j = col; j < col + layer.out; ++j) {
+                buffers_[layer.running_mean + j] = cache.bn_mean[j];
+                buffers_[layer.running_var + j] = cache.bn_var[j] * unbias;
+            }
+        }
+    }
+}
+
+void StackedMlp::EvaluateLoss(const float* x, const float* y, int64_t batch, StackedWorkspace& ws, double* losses) {
+    std::mt19937 unused;
+    Forward(x, batch, false, ws, unused);
+    Loss(y, batch, ws, false, ws.losses.data());
+    for (int64_t k = 0; k < Trials(); ++k) {
+        losses[k] += ws.losses[k];
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,331 @@
+#include "regdb/core/engine/stream.hpp"
+#include "regdb/core/engine/optimizer.hpp"
+#include "regdb/core/engine/parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+namespace regdb {
+
+namespace {
+
+// 窗口正在被读取, 消费端和预取线程都不能使用
+constexpr int64_t WINDOW_LOADING = -2;
+
+} // namespace
+
+int64_t DatasetSource::Read(int64_t begin, int64_t count, float* x, float* y) {
+    begin = std::min(begin, data_.rows);
+    count = std::min(count, data_.rows - begin);
+    std::memcpy(x, data_.Row(begin), sizeof(float) * count * data_.cols);
+    std::memcpy(y, data_.labels.data() + begin, sizeof(float) * count);
+    return count;
+}
+
+BlockSplit SplitBlocks(int64_t rows, int64_t block_rows, double validation_fraction, uint64_t seed) {
+    if (rows < 2) {
+        throw std::runtime_error("Training data needs at least two rows.");
+    }
+    block_rows = std::max<int64_t>(1, std::min(block_rows, (rows + 1) / 2));
+    const auto blocks = (rows + block_rows - 1) / block_rows;
+    std::vector<int64_t> order(blocks);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937_64 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    auto validation_blocks = static_cast<int64_t>(static_cast<double>(blocks) * validation_fraction);
+    validation_blocks = std::max<int64_t>(1, std::min(validation_blocks, blocks - 1));
+
+    BlockSplit split;
+    split.block_rows = block_rows;
+    split.validation.assign(order.begin(), order.begin() + validation_blocks);
+    split.train.assign(order.begin() + validation_blocks, order.end());
+    // 验证集按存储顺序读取
+    std::sort(split.validation.begin(), split.validation.end());
+    return split;
+}
+
+MinibatchStream::MinibatchStream(BlockSource& source, const std::vector<int64_t>& blocks, int64_t block_rows,
+                                 const StreamOptions& options, bool shuffle, uint64_t seed,
+                                 const Augmenter* augmenter)
+    : source_(source), blocks_(blocks), block_rows_(std::max<int64_t>(1, block_rows)), options_(options),
+      shuffle_(shuffle), seed_(seed), rng_(static_cast<uint32_t>(seed)), augmenter_(augmenter) {
+    options_.window_blocks = std::max<int64_t>(1, options_.window_blocks);
+    permutation_.reserve(options_.window_blocks * block_rows_);
+}
+
+int64_t MinibatchStream::WindowCount() const {
+    const auto blocks = static_cast<int64_t>(blocks_.size());
+    return (blocks + options_.window_blocks - 1) / options_.window_blocks;
+}
+
+void MinibatchStream::Reset() {
+    std::unique_lock<std::mutex> guard(lock_);
+    // 等待正在进行的读取结束, 丢弃上一轮未消费的窗口
+    changed_.wait(guard, [&]() {
+        return windows_[0].index != WINDOW_LOADING && windows_[1].index != WINDOW_LOADING;
+    });
+    if (shuffle_) {
+        // 第一级: 打乱块顺序
+        std::shuffle(blocks_.begin(), blocks_.end(), rng_);
+    }
+    windows_[0].index = -1;
+    windows_[1].index = -1;
+    ++epoch_;
+    next_load_ = 0;
+    current_ = nullptr;
+    current_index_ = -1;
+    cursor_ = 0;
+    changed_.notify_all();
+}
+
+void MinibatchStream::Load(Window& window, int64_t epoch, int64_t index) {
+    const auto cols = source_.Cols();
+    const auto capacity = options_.window_blocks * block_rows_;
+    window.x.resize(capacity * cols);
+    window.y.resize(capacity);
+    window.rows = 0;
+    const auto first = index * options_.window_blocks;
+    const auto last = std::min(first + options_.window_blocks, static_cast<int64_t>(blocks_.size()));
+    for (int64_t b = first; b < last; ++b) {
+        window.rows += source_.Read(blocks_[b] * block_rows_, block_rows_, window.x.data() + window.rows * cols,
+                                    window.y.data() + window.rows);
+    }
+    if (augmenter_) {
+        // 窗口内的行按存储顺序排列, 首尾配对的两行来自本轮被打乱到同一窗口的不同块
+        std::mt19937 rng(Augmenter::Seed(seed_, epoch, index));
+        augmenter_->Apply(window.rows, cols, window.x.data(), window.y.data(), rng);
+    }
+}
+
+MinibatchStream::Window& MinibatchStream::Acquire(int64_t index) {
+    auto& window = windows_[index % 2];
+    std::unique_lock<std::mutex> guard(lock_);
+    changed_.wait(guard, [&]() {
+        return error_ || window.index == index || !prefetching_ || next_load_ <= index;
+    });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    if (window.index == index) {
+        return window;
+    }
+    // 没有预取线程, 或预取线程尚未认领这个窗口: 在训练线程上同步读取
+    changed_.wait(guard, [&]() { return window.index != WINDOW_LOADING; });
+    if (window.index == index) {
+        return window;
+    }
+    window.index = WINDOW_LOADING;
+    next_load_ = std::max(next_load_, index + 1);
+    const auto epoch = epoch_;
+    guard.unlock();
+    try {
+        Load(window, epoch, index);
+    } catch (...) {
+        guard.lock();
+        window.index = -1;
+        changed_.notify_all();
+        throw;
+    }
+    guard.lock();
+    window.index = index;
+    changed_.notify_all();
+    return window;
+}
+
+int64_t MinibatchStream::Next(int64_t batch, float* x, float* y) {
+    const auto cols = source_.Cols();
+    int64_t filled = 0;
+    // minibatch 可以跨越窗口边界, 只有每轮最后一个可能不满
+    while (filled < batch) {
+        if (current_ && cursor_ < current_->rows) {
+            const auto count = std::min(batch - filled, current_->rows - cursor_);
+            for (int64_t i = 0; i < count; ++i) {
+                const auto row = permutation_[cursor_ + i];
+                std::memcpy(x + (filled + i) * cols, current_->x.data() + row * cols, sizeof(float) * cols);
+                y[filled + i] = current_->y[row];
+            }
+            cursor_ += count;
+            filled += count;
+            continue;
+        }
+        if (current_) {
+            std::lock_guard<std::mutex> guard(lock_);
+            current_->index = -1;
+            current_ = nullptr;
+            changed_.notify_all();
+        }
+        if (current_index_ + 1 >= WindowCount()) {
+            break;
+        }
+        current_ = &Acquire(++current_index_);
+        // 第二级: 在已读入内存的窗口内打乱行顺序
+        permutation_.resize(current_->rows);
+        std::iota(permutation_.begin(), permutation_.end(), 0);
+        if (shuffle_) {
+            std::shuffle(permutation_.begin(), permutation_.end(), rng_);
+        }
+        cursor_ = 0;
+    }
+    return filled;
+}
+
+void MinibatchStream::RunPrefetcher() {
+    std::unique_lock<std::mutex> guard(lock_);
+    if (closed_) {
+        return;
+    }
+    prefetching_ = true;
+    changed_.notify_all();
+    while (true) {
+        changed_.wait(guard, [&]() {
+            return closed_ || (next_load_ < WindowCount() && windows_[next_load_ % 2].index == -1);
+        });
+        if (closed_) {
+            break;
+        }
+        const auto index = next_load_++;
+        const auto epoch = epoch_;
+        auto& window = windows_[index % 2];
+        window.index = WINDOW_LOADING;
+        guard.unlock();
+        try {
+            Load(window, epoch, index);
+        } catch (...) {
+            guard.lock();
+            window.index = -1;
+            error_ = std::current_exception();
+            break;
+        }
+        guard.lock();
+        window.index = index;
+        changed_.notify_all();
+    }
+    prefetching_ = false;
+    changed_.notify_all();
+}
+
+void MinibatchStream::Close() {
+    std::lock_guard<std::mutex> guard(lock_);
+    closed_ = true;
+    changed_.notify_all();
+}
+
+TrainResult StreamTrainer::Train(Mlp& model, StopToken& token) const {
+    const Augmenter augmenter(model.Config(), model.IsRegression());
+    MinibatchStream train(source_, split_.train, split_.block_rows, stream_, true, options_.seed,
+                          augmenter.Enabled() ? &augmenter : nullptr);
+    StreamOptions validation_options = stream_;
+    validation_options.window_blocks = 1;
+    MinibatchStream validation(source_, split_.validation, split_.block_rows, validation_options, false,
+                               options_.seed);
+
+    // 借一个线程预取训练窗口, 线程池没有空闲线程时在训练线程上同步读取
+    auto lease = ThreadPool::Instance().Acquire(2);
+    TrainResult result;
+    lease.Run([&](int64_t worker) {
+        if (worker > 0) {
+            train.RunPrefetcher();
+            return;
+        }
+        try {
+            result = TrainLoop(model, token, train, validation);
+        } catch (...) {
+            train.Close();
+            throw;
+        }
+        train.Close();
+    });
+    return result;
+}
+
+TrainResult StreamTrainer::TrainLoop(Mlp& model, StopToken& token, MinibatchStream& train,
+                                     MinibatchStream& validation) const {
+    TrainResult result;
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    const auto interval = std::max<int64_t>(1, options_.preempt_interval);
+
+    MlpWorkspace ws;
+    ws.Reserve(model, std::max(batch_size, options_.eval_batch_size));
+    std::mt19937 rng(static_cast<uint32_t>(options_.seed));
+    Adam optimizer(model, options_.learning_rate);
+    WeightAveraging averaging(model, options_.max_epochs);
+    EarlyStopping early_stop(options_.early_stop, options_.max_epochs, options_.incumbent);
+    result.train_curve.reserve(options_.max_epochs);
+    result.val_curve.reserve(options_.max_epochs);
+
+    for (int64_t epoch = 0; epoch < options_.max_epochs; ++epoch) {
+        train.Reset();
+        double loss_sum = 0.0;
+        int64_t seen = 0;
+        int64_t last = 0;
+        while (true) {
+            if (result.steps % interval == 0 && token.ShouldStop()) {
+                result.preempted = true;
+                break;
+            }
+            const auto count = train.Next(batch_size, ws.x.data(), ws.y.data());
+            if (count == 0) {
+                break;
+            }
+            loss_sum += model.TrainStep(ws.x.data(), ws.y.data(), count, ws, rng) * static_cast<double>(count);
+            optimizer.Step(model);
+            averaging.Step(model, optimizer.Steps());
+            last = count;
+            seen += count;
+            ++result.steps;
+        }
+        if (result.preempted) {
+            result.partial_rows = seen;
+            result.partial_train_loss = seen > 0 ? loss_sum / static_cast<double>(seen) : 0.0;
+            break;
+        }
+        if (seen > 0) {
+            result.train_curve.push_back(loss_sum / static_cast<double>(seen));
+        }
+
+        // 流式数据不能随机访问训练行, BN 统计量在仍留在工作区里的最后一个 minibatch 上重新计算
+        averaging.EndEpoch(model, epoch);
+        if (averaging.Averaged()) {
+            averaging.BeginEvaluate(model, ws.x.data(), last, ws);
+        }
+        const auto val_loss = Validate(model, ws, validation);
+        averaging.EndEvaluate(model);
+        result.val_curve.push_back(val_loss);
+        if (val_loss < result.best_val_loss) {
+            result.best_val_loss = val_loss;
+            result.best_epoch = epoch;
+        }
+        if (early_stop.Update(result.val_curve)) {
+            result.stopped_early = true;
+            break;
+        }
+        // 完整的 epoch 先验证再响应抢占
+        if (epoch + 1 < options_.max_epochs && token.ShouldStop()) {
+            result.preempted = true;
+            break;
+        }
+    }
+    return result;
+}
+
+double StreamTrainer::Validate(Mlp& model, MlpWorkspace& ws, MinibatchStream& validation) const {
+    const auto batch_size = std::max<int64_t>(1, options_.eval_batch_size);
+    ws.Reserve(model, batch_size);
+    validation.Reset();
+    double loss = 0.0;
+    int64_t rows = 0;
+    while (true) {
+        const auto count = validation.Next(batch_size, ws.x.data(), ws.y.data());
+        if (count == 0) {
+            break;
+        }
+        loss += model.EvaluateLoss(ws.x.data(), ws.y.data(), count, ws);
+        rows += count;
+    }
+    return loss / static_cast<double>(std::max<int64_t>(1, rows));
+}
+
+} // namespace regdb
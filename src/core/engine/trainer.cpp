@@ -0,0 +1,599 @@
+#include "regdb/core/engine/trainer.hpp"
+#include "regdb/core/engine/optimizer.hpp"
+#include "regdb/core/engine/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+
+namespace regdb {
+
+namespace {
+
+// 从检查点恢复参数、优化器、权重平均和随机数状态以及已完成的曲线, 重放验证曲线恢复提前停止的计数; 返回下一个 epoch
+int64_t ResumeFrom(const Checkpoint& checkpoint, Mlp& model, Adam& optimizer, WeightAveraging& averaging,
+                   std::mt19937& rng, EarlyStopping& early_stop, TrainResult& result) {
+    checkpoint.Restore(model, optimizer, averaging, rng);
+    result = checkpoint.Progress();
+    std::vector<double> curve;
+    for (auto loss : result.val_curve) {
+        curve.push_back(loss);
+        early_stop.Update(curve);
+    }
+    return checkpoint.epoch + 1;
+}
+
+// 记录被抢占的 epoch 已完成部分, 两条学习曲线只记录完整的 epoch
+void RecordPartial(TrainResult& result, double loss_sum, int64_t seen) {
+    result.partial_rows = seen;
+    result.partial_train_loss = seen > 0 ? loss_sum / static_cast<double>(seen) : 0.0;
+}
+
+// 被抢占时等上一份快照写完, 再保存当前状态; 记为最后一个完整 epoch, 恢复后重做未完成的 epoch
+void SavePreempted(Checkpointer* checkpointer, const Mlp& model, const Adam& optimizer,
+                   const WeightAveraging& averaging, const std::mt19937& rng, const TrainResult& result) {
+    if (!checkpointer) {
+        return;
+    }
+    checkpointer->Flush();
+    checkpointer->Offer(model, optimizer, averaging, rng, result, static_cast<int64_t>(result.val_curve.size()) - 1);
+}
+
+} // namespace
+
+TrainResult Trainer::Train(Mlp& model, StopToken& token) const {
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    // 每个分片至少一行
+    const auto threads = std::min(batch_size, options_.threads);
+    if (threads > 1) {
+        // 线程池没有空闲线程时退回单线程训练
+        auto lease = ThreadPool::Instance().Acquire(threads);
+        if (lease.Workers() > 1) {
+            return options_.hogwild || model.Spec().hogwild ? TrainHogwild(model, token, lease)
+                                                            : TrainDataParallel(model, token, lease);
+        }
+    }
+
+    std::vector<int64_t> order = split_.train;
+    if (!model.Config().use_data_augment) {
+        return TrainLoop(model, token, order, nullptr);
+    }
+    // 借一个线程 gather 并增强下一个 minibatch, 与当前 minibatch 的训练重叠; 没有空闲线程时同步生产
+    const Augmenter augmenter(model.Config(), model.IsRegression());
+    const auto rows = static_cast<int64_t>(order.size());
+    BatchPrefetcher prefetcher(batch_size, data_.cols, [&](int64_t epoch, int64_t index, float* x, float* y) {
+        const auto start = index * batch_size;
+        const auto count = std::min(batch_size, rows - start);
+        GatherRows(data_, order.data() + start, count, x, y);
+        std::mt19937 rng(Augmenter::Seed(options_.seed, epoch, index));
+        augmenter.Apply(count, data_.cols, x, y, rng);
+        return count;
+    });
+    auto lease = ThreadPool::Instance().Acquire(2);
+    TrainResult result;
+    lease.Run([&](int64_t worker) {
+        if (worker > 0) {
+            prefetcher.RunPrefetcher();
+            return;
+        }
+        try {
+            result = TrainLoop(model, token, order, &prefetcher);
+        } catch (...) {
+            prefetcher.Close();
+            throw;
+        }
+        prefetcher.Close();
+    });
+    return result;
+}
+
+TrainResult Trainer::TrainLoop(Mlp& model, StopToken& token, std::vector<int64_t>& order,
+                               BatchPrefetcher* prefetcher) const {
+    TrainResult result;
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    const auto interval = std::max<int64_t>(1, options_.preempt_interval);
+    const auto rows = static_cast<int64_t>(order.size());
+
+    // 工作区、矩缓冲和曲线在训练开始前一次分配好, epoch 内不再分配
+    MlpWorkspace ws;
+    ws.Reserve(model, std::max(batch_size, options_.eval_batch_size));
+    std::mt19937 rng(static_cast<uint32_t>(options_.seed));
+    Adam optimizer(model, options_.learning_rate);
+    WeightAveraging averaging(model, options_.max_epochs);
+    EarlyStopping early_stop(options_.early_stop, options_.max_epochs, options_.incumbent);
+    const auto first_epoch =
+        options_.resume ? ResumeFrom(*options_.resume, model, optimizer, averaging, rng, early_stop, result) : 0;
+    result.train_curve.reserve(options_.max_epochs);
+    result.val_curve.reserve(options_.max_epochs);
+
+    for (int64_t epoch = first_epoch; epoch < options_.max_epochs; ++epoch) {
+        std::shuffle(order.begin(), order.end(), rng);
+        if (prefetcher) {
+            prefetcher->Reset((rows + batch_size - 1) / batch_size);
+        }
+        double loss_sum = 0.0;
+        int64_t seen = 0;
+        for (int64_t start = 0; start < rows; start += batch_size) {
+            // 抢占点: 截止时间或中断时放弃当前 epoch, 保留已有曲线
+            if (result.steps % interval == 0 && token.ShouldStop()) {
+                result.preempted = true;
+                break;
+            }
+            const float* x = ws.x.data();
+            const float* y = ws.y.data();
+            const auto count = std::min(batch_size, rows - start);
+            if (prefetcher) {
+                prefetcher->Next(&x, &y);
+            } else {
+                GatherRows(data_, order.data() + start, count, ws.x.data(), ws.y.data());
+            }
+            loss_sum += model.TrainStep(x, y, count, ws, rng) * static_cast<double>(count);
+            optimizer.Step(model);
+            averaging.Step(model, optimizer.Steps());
+            seen += count;
+            ++result.steps;
+        }
+        if (result.preempted) {
+            RecordPartial(result, loss_sum, seen);
+            SavePreempted(options_.checkpointer, model, optimizer, averaging, rng, result);
+            break;
+        }
+        if (seen > 0) {
+            result.train_curve.push_back(loss_sum / static_cast<double>(seen));
+        }
+
+        averaging.EndEpoch(model, epoch);
+        const auto val_loss = Validate(model, ws, averaging);
+        result.val_curve.push_back(val_loss);
+        if (val_loss < result.best_val_loss) {
+            result.best_val_loss = val_loss;
+            result.best_epoch = epoch;
+        }
+        if (early_stop.Update(result.val_curve)) {
+            result.stopped_early = true;
+            break;
+        }
+        if (options_.checkpointer && options_.checkpointer->Due()) {
+            options_.checkpointer->Offer(model, optimizer, averaging, rng, result, epoch);
+        }
+        // 完整的 epoch 先验证再响应抢占
+        if (epoch + 1 < options_.max_epochs && token.ShouldStop()) {
+            result.preempted = true;
+            SavePreempted(options_.checkpointer, model, optimizer, averaging, rng, result);
+            break;
+        }
+    }
+    return result;
+}
+
+TrainResult Trainer::TrainDataParallel(Mlp& model, StopToken& token, ThreadPool::Lease& lease) const {
+    TrainResult result;
+    const auto threads = lease.Workers();
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    const auto interval = std::max<int64_t>(1, options_.preempt_interval);
+    const auto rows = static_cast<int64_t>(split_.train.size());
+    const auto shard_capacity = (batch_size + threads - 1) / threads;
+
+    // 所有缓冲区在启动前分配好, 训练循环内不再分配内存
+    std::vector<MlpWorkspace> workspaces(threads);
+    std::vector<std::mt19937> rngs;
+    for (int64_t w = 0; w < threads; ++w) {
+        workspaces[w].Reserve(model, w == 0 ? std::max(shard_capacity, options_.eval_batch_size) : shard_capacity);
+        rngs.emplace_back(static_cast<uint32_t>(options_.seed + w));
+    }
+    std::vector<double> shard_losses(threads * CACHE_LINE_FLOATS, 0.0);
+    std::vector<int64_t> order = split_.train;
+    std::mt19937 rng(static_cast<uint32_t>(options_.seed));
+    Adam optimizer(model, options_.learning_rate);
+    WeightAveraging averaging(model, options_.max_epochs);
+    EarlyStopping early_stop(options_.early_stop, options_.max_epochs, options_.incumbent);
+    GradientReducer reducer(static_cast<int64_t>(model.Parameters().size()), threads);
+    const Augmenter augmenter(model.Config(), model.IsRegression());
+    SpinBarrier barrier(threads);
+    const auto first_epoch =
+        options_.resume ? ResumeFrom(*options_.resume, model, optimizer, averaging, rng, early_stop, result) : 0;
+    result.train_curve.reserve(options_.max_epochs);
+    result.val_curve.reserve(options_.max_epochs);
+
+    // 以下状态只在单线程区域 (启动前和屏障的 completion 中) 修改
+    int64_t epoch = first_epoch - 1;
+    int64_t start = rows;
+    int64_t count = 0;
+    int64_t seen = 0;
+    double loss_sum = 0.0;
+    bool done = false;
+
+    // 准备下一个 minibatch: 处理 epoch 边界、验证和抢占点
+    auto advance = [&]() {
+        while (true) {
+            if (start >= rows) {
+                if (epoch >= first_epoch) {
+                    if (seen > 0) {
+                        result.train_curve.push_back(loss_sum / static_cast<double>(seen));
+                    }
+                    averaging.EndEpoch(model, epoch);
+                    const auto val_loss = Validate(model, workspaces[0], averaging);
+                    result.val_curve.push_back(val_loss);
+                    if (val_loss < result.best_val_loss) {
+                        result.best_val_loss = val_loss;
+                        result.best_epoch = epoch;
+                    }
+                    if (early_stop.Update(result.val_curve)) {
+                        result.stopped_early = true;
+                        done = true;
+                        return;
+                    }
+                    if (options_.checkpointer && options_.checkpointer->Due()) {
+                        options_.checkpointer->Offer(model, optimizer, averaging, rng, result, epoch);
+                    }
+                }
+                if (++epoch >= options_.max_epochs) {
+                    done = true;
+                    return;
+                }
+                // 完整的 epoch 先验证再响应抢占
+                if (epoch > first_epoch && token.ShouldStop()) {
+                    result.preempted = true;
+                    SavePreempted(options_.checkpointer, model, optimizer, averaging, rng, result);
+                    done = true;
+                    return;
+                }
+                std::shuffle(order.begin(), order.end(), rng);
+                start = 0;
+                seen = 0;
+                loss_sum = 0.0;
+                if (rows == 0) {
+                    continue;
+                }
+            }
+            if (result.steps % interval == 0 && token.ShouldStop()) {
+                RecordPartial(result, loss_sum, seen);
+                result.preempted = true;
+                SavePreempted(options_.checkpointer, model, optimizer, averaging, rng, result);
+                done = true;
+                return;
+            }
+            count = std::min(batch_size, rows - start);
+            return;
+        }
+    };
+
+    auto train = [&](int64_t w) {
+        const auto chunk = reducer.Chunk(w);
+        auto& ws = workspaces[w];
+        ws.ReserveThreadScratch();
+        while (true) {
+            if (done) {
+                return;
+            }
+            const auto first = count * w / threads;
+            const auto last = count * (w + 1) / threads;
+            float* grads = reducer.Buffer(w);
+            if (last > first) {
+                GatherRows(data_, order.data() + start + first, last - first, ws.x.data(), ws.y.data());
+                // 数据并行时各线程在自己的分片内并行增强; 没有预取线程, gather 和增强在关键路径上
+                augmenter.Apply(last - first, data_.cols, ws.x.data(), ws.y.data(), rngs[w]);
+                // BN 滑动统计量只由 worker 0 的分片更新
+                shard_losses[w * CACHE_LINE_FLOATS] = model.ShardGradient(
+                    ws.x.data(), ws.y.data(), last - first, count, ws, rngs[w], grads, w == 0);
+            } else {
+                std::fill(grads, grads + model.Parameters().size(), 0.0f);
+                shard_losses[w * CACHE_LINE_FLOATS] = 0.0;
+            }
+            barrier.ArriveAndWait([&]() { optimizer.BeginStep(); });
+
+            reducer.Reduce(w);
+            optimizer.StepRange(model, reducer.Result(), chunk.first, chunk.second);
+            averaging.StepRange(model, optimizer.Steps(), chunk.first, chunk.second);
+            barrier.ArriveAndWait([&]() {
+                for (int64_t i = 0; i < threads; ++i) {
+                    loss_sum += shard_losses[i * CACHE_LINE_FLOATS];
+                }
+                seen += count;
+                start += batch_size;
+                ++result.steps;
+                advance();
+            });
+        }
+    };
+
+    // 任一 worker 或 completion 失败时放弃屏障, 其他 worker 不再等待, 原始异常由 Lease::Run 重新抛出
+    auto worker = [&](int64_t w) {
+        try {
+            train(w);
+        } catch (...) {
+            barrier.Abort();
+            throw;
+        }
+    };
+
+    advance();
+    lease.Run(worker);
+    return result;
+}
+
+TrainResult Trainer::TrainHogwild(Mlp& model, StopToken& token, ThreadPool::Lease& lease) const {
+    TrainResult result;
+    const auto threads = lease.Workers();
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    const auto interval = std::max<int64_t>(1, options_.preempt_interval);
+    const auto rows = static_cast<int64_t>(split_.train.size());
+    const auto in_features = model.Spec().in_features;
+
+    std::vector<int64_t> order = split_.train;
+    std::mt19937 rng(static_cast<uint32_t>(options_.seed));
+    Adam optimizer(model, options_.learning_rate);
+    WeightAveraging averaging(model, options_.max_epochs);
+    EarlyStopping early_stop(options_.early_stop, options_.max_epochs, options_.incumbent);
+    const auto first_epoch =
+        options_.resume ? ResumeFrom(*options_.resume, model, optimizer, averaging, rng, early_stop, result) : 0;
+    result.train_curve.reserve(options_.max_epochs);
+    result.val_curve.reserve(options_.max_epochs);
+
+    std::vector<MlpWorkspace> workspaces(threads);
+    std::vector<Buffer<float>> grads;
+    std::vector<std::vector<uint8_t>> active(threads, std::vector<uint8_t>(in_features));
+    std::vector<std::mt19937> rngs;
+    for (int64_t w = 0; w < threads; ++w) {
+        workspaces[w].Reserve(model, w == 0 ? std::max(batch_size, options_.eval_batch_size) : batch_size);
+        // worker 的随机数不进检查点, 恢复后按起始 epoch 换种子, 不重放已用过的 dropout 序列
+        rngs.emplace_back(static_cast<uint32_t>(options_.seed + w + first_epoch * threads));
+        grads.emplace_back(MemoryCategory::WORKSPACE, static_cast<int64_t>(model.Parameters().size()));
+    }
+    std::vector<double> worker_losses(threads * CACHE_LINE_FLOATS, 0.0);
+    std::vector<int64_t> worker_seen(threads * CACHE_LINE_FLOATS, 0);
+    const Augmenter augmenter(model.Config(), model.IsRegression());
+    SpinBarrier barrier(threads);
+    std::atomic<int64_t> cursor{0};
+    std::atomic<int64_t> steps{result.steps};
+    std::atomic<bool> preempted{false};
+
+    int64_t epoch = first_epoch;
+    bool done = epoch >= options_.max_epochs;
+
+    // epoch 边界, 由最后到达屏障的线程执行
+    auto finish_epoch = [&]() {
+        double loss_sum = 0.0;
+        int64_t seen = 0;
+        for (int64_t w = 0; w < threads; ++w) {
+            loss_sum += worker_losses[w * CACHE_LINE_FLOATS];
+            seen += worker_seen[w * CACHE_LINE_FLOATS];
+            worker_losses[w * CACHE_LINE_FLOATS] = 0.0;
+            worker_seen[w * CACHE_LINE_FLOATS] = 0;
+        }
+        // 所有 worker 都停在屏障上, 这里读到的步数是准确的; 写回优化器以便检查点记录
+        result.steps = steps.load();
+        optimizer.SyncSteps(result.steps);
+        // 抢占标记之前其他线程可能已经取完了全部行, 这时仍按完整的 epoch 验证
+        if (seen < rows) {
+            RecordPartial(result, loss_sum, seen);
+            SavePreempted(options_.checkpointer, model, optimizer, averaging, rng, result);
+            done = true;
+            return;
+        }
+        if (seen > 0) {
+            result.train_curve.push_back(loss_sum / static_cast<double>(seen));
+        }
+        // 异步更新没有全局步数, Lookahead 在 epoch 边界同步
+        averaging.Lookahead(model, 0, static_cast<int64_t>(model.Parameters().size()));
+        averaging.EndEpoch(model, epoch);
+        const auto val_loss = Validate(model, workspaces[0], averaging);
+        result.val_curve.push_back(val_loss);
+        if (val_loss < result.best_val_loss) {
+            result.best_val_loss = val_loss;
+            result.best_epoch = epoch;
+        }
+        if (early_stop.Update(result.val_curve)) {
+            result.stopped_early = true;
+            done = true;
+            return;
+        }
+        if (options_.checkpointer && options_.checkpointer->Due()) {
+            options_.checkpointer->Offer(model, optimizer, averaging, rng, result, epoch);
+        }
+        if (++epoch >= options_.max_epochs) {
+            preempted.store(false);
+            done = true;
+            return;
+        }
+        if (preempted.load() || token.ShouldStop()) {
+            preempted.store(true);
+            SavePreempted(options_.checkpointer, model, optimizer, averaging, rng, result);
+            done = true;
+            return;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        cursor.store(0);
+    };
+
+    auto train = [&](int64_t w) {
+        auto& ws = workspaces[w];
+        ws.ReserveThreadScratch();
+        int64_t local_steps = 0;
+        while (!done) {
+            while (!preempted.load(std::memory_order_relaxed) && !barrier.Aborted()) {
+                if (local_steps % interval == 0 && token.ShouldStop()) {
+                    preempted.store(true);
+                    break;
+                }
+                const auto start = cursor.fetch_add(batch_size);
+                if (start >= rows) {
+                    break;
+                }
+                const auto count = std::min(batch_size, rows - start);
+                GatherRows(data_, order.data() + start, count, ws.x.data(), ws.y.data());
+                augmenter.Apply(count, data_.cols, ws.x.data(), ws.y.data(), rngs[w]);
+                // 标记 minibatch 中出现非零值的输入列, 只有这些行的第一层权重梯度非零
+                auto& marks = active[w];
+                std::fill(marks.begin(), marks.end(), 0);
+                for (int64_t i = 0; i < count; ++i) {
+                    const float* row = ws.x.data() + i * data_.cols;
+                    for (int64_t j = 0; j < in_features; ++j) {
+                        marks[j] |= row[j] != 0.0f;
+                    }
+                }
+                // 共享参数在读写期间可能被其他线程修改, Hogwild 容忍这种不一致
+                worker_losses[w * CACHE_LINE_FLOATS] += model.ShardGradient(
+                    ws.x.data(), ws.y.data(), count, count, ws, rngs[w], grads[w].data(), w == 0);
+                worker_seen[w * CACHE_LINE_FLOATS] += count;
+                const auto step = steps.fetch_add(1, std::memory_order_relaxed) + 1;
+                optimizer.HogwildStep(model, grads[w].data(), step, marks.data());
+                ++local_steps;
+            }
+            barrier.ArriveAndWait(finish_epoch);
+        }
+    };
+
+    // 任一 worker 或 completion 失败时放弃屏障, 其他 worker 不再等待, 原始异常由 Lease::Run 重新抛出
+    auto worker = [&](int64_t w) {
+        try {
+            train(w);
+        } catch (...) {
+            barrier.Abort();
+            throw;
+        }
+    };
+
+    std::shuffle(order.begin(), order.end(), rng);
+    if (!done) {
+        lease.Run(worker);
+    }
+    result.steps = steps.load();
+    result.preempted = preempted.load() && !result.stopped_early;
+    return result;
+}
+
+double Trainer::Validate(Mlp& model, MlpWorkspace& ws) const {
+    const auto batch_size = std::max<int64_t>(1, options_.eval_batch_size);
+    ws.Reserve(model, batch_size);
+    float* x = ws.x.data();
+    float* y = ws.y.data();
+    double loss = 0.0;
+    const auto rows = static_cast<int64_t>(split_.validation.size());
+    for (int64_t start = 0; start < rows; start += batch_size) {
+        const auto count = std::min(batch_size, rows - start);
+        GatherRows(data_, split_.validation.data() + start, count, x, y);
+        loss += model.EvaluateLoss(x, y, count, ws);
+    }
+    return loss / static_cast<double>(std::max<int64_t>(1, rows));
+}
+
+double Trainer::Validate(Mlp& model, MlpWorkspace& ws, WeightAveraging& averaging) const {
+    if (averaging.Averaged()) {
+        const auto count = std::min(ws.Capacity(), static_cast<int64_t>(split_.train.size()));
+        GatherRows(data_, split_.train.data(), count, ws.x.data(), ws.y.data());
+        averaging.BeginEvaluate(model, ws.x.data(), count, ws);
+    }
+    const auto loss = Validate(model, ws);
+    averaging.EndEvaluate(model);
+    return loss;
+}
+
+std::vector<TrainResult> Trainer::TrainStacked(StackedMlp& model, StopToken& token) const {
+    const auto trials = model.Trials();
+    std::vector<TrainResult> results(trials);
+    for (auto& result : results) {
+        result.train_curve.reserve(options_.max_epochs);
+        result.val_curve.reserve(options_.max_epochs);
+    }
+    const auto batch_size = std::max<int64_t>(1, options_.batch_size);
+    const auto interval = std::max<int64_t>(1, options_.preempt_interval);
+
+    StackedWorkspace ws;
+    ws.Reserve(model, std::max(batch_size, options_.eval_batch_size));
+    float* x = ws.x.data();
+    float* y = ws.y.data();
+    std::vector<int64_t> order = split_.train;
+    std::mt19937 rng(static_cast<uint32_t>(options_.seed));
+    StackedAdam optimizer(model, options_.learning_rate);
+    StackedWeightAveraging averaging(model, options_.max_epochs);
+    std::vector<double> step_losses(trials);
+    std::vector<double> loss_sums(trials);
+    std::vector<double> val_losses(trials);
+    // 提前停止的 trial 仍留在堆叠中随其他 trial 一起计算, 但不再记录曲线; 全部停止时结束
+    std::vector<EarlyStopping> early_stops(
+        trials, EarlyStopping(options_.early_stop, options_.max_epochs, options_.incumbent));
+    int64_t running = trials;
+    int64_t steps = 0;
+    bool preempted = false;
+
+    for (int64_t epoch = 0; epoch < options_.max_epochs && !preempted && running > 0; ++epoch) {
+        std::shuffle(order.begin(), order.end(), rng);
+        std::fill(loss_sums.begin(), loss_sums.end(), 0.0);
+        int64_t seen = 0;
+        for (int64_t start = 0; start < static_cast<int64_t>(order.size()); start += batch_size) {
+            if (steps % interval == 0 && token.ShouldStop()) {
+                preempted = true;
+                break;
+            }
+            const auto count = std::min<int64_t>(batch_size, static_cast<int64_t>(order.size()) - start);
+            GatherRows(data_, order.data() + start, count, x, y);
+            model.TrainStep(x, y, count, ws, rng, step_losses.data());
+            optimizer.Step(model);
+            ++steps;
+            averaging.Step(model, steps);
+            for (int64_t k = 0; k < trials; ++k) {
+                loss_sums[k] += step_losses[k] * static_cast<double>(count);
+            }
+            seen += count;
+        }
+        if (!preempted) {
+            averaging.EndEpoch(model, epoch);
+            if (averaging.Averaged()) {
+                const auto count = std::min(ws.Capacity(), static_cast<int64_t>(split_.train.size()));
+                GatherRows(data_, split_.train.data(), count, x, y);
+                averaging.BeginEvaluate(model, x, count, ws);
+            }
+            ValidateStacked(model, ws, val_losses.data());
+            averaging.EndEvaluate(model);
+        }
+        for (int64_t k = 0; k < trials; ++k) {
+            auto& result = results[k];
+            if (result.stopped_early) {
+                continue;
+            }
+            result.steps = steps;
+            if (preempted) {
+                RecordPartial(result, loss_sums[k], seen);
+                continue;
+            }
+            if (seen > 0) {
+                result.train_curve.push_back(loss_sums[k] / static_cast<double>(seen));
+            }
+            result.val_curve.push_back(val_losses[k]);
+            if (val_losses[k] < result.best_val_loss) {
+                result.best_val_loss = val_losses[k];
+                result.best_epoch = epoch;
+            }
+            if (early_stops[k].Update(result.val_curve)) {
+                result.stopped_early = true;
+                --running;
+            }
+        }
+        // 完整的 epoch 先验证再响应抢占
+        preempted = preempted || (epoch + 1 < options_.max_epochs && running > 0 && token.ShouldStop());
+    }
+    for (auto& result : results) {
+        result.preempted = preempted && !result.stopped_early;
+    }
+    return results;
+}
+
+void Trainer::ValidateStacked(StackedMlp& model, StackedWorkspace& ws, double* losses) const {
+    const auto batch_size = std::max<int64_t>(1, options_.eval_batch_size);
+    ws.Reserve(model, batch_size);
+    float* x = ws.x.data();
+    float* y = ws.y.data();
+    std::fill(losses, losses + model.Trials(), 0.0);
+    const auto rows = static_cast<int64_t>(split_.validation.size());
+    for (int64_t start = 0; start < rows; start += batch_size) {
+        const auto count = std::min(batch_size, rows - start);
+        GatherRows(data_, split_.validation.data() + start, count, x, y);
+        model.EvaluateLoss(x, y, count, ws, losses);
+    }
+    for (int64_t k = 0; k < model.Trials(); ++k) {
+        losses[k] /= static_cast<double>(std::max<int64_t>(1, rows));
+    }
+}
+
+} // namespace regdb
@@ -0,0 +1,112 @@
+#include "regdb/core/engine/weights.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace regdb {
+
+ModelWeights ModelWeights::FromModel(const std::string& model_name, const std::string& key, const Mlp& model,
+                                     int64_t rows, double train_loss) {
+    ModelWeights weights;
+    weights.model_name = model_name;
+    weights.key = key;
+    weights.spec = model.Spec();
+    weights.config = model.Config();
+    weights.rows = rows;
+    weights.train_loss = train_loss;
+    weights.params.assign(model.Parameters().begin(), model.Parameters().end());
+    weights.buffers.assign(model.Buffers().begin(), model.Buffers().end());
+    weights.slots = model.Slots();
+    return weights;
+}
+
+void ModelWeights::Allocate(bool with_optimizer) {
+    const Mlp layout(spec, config, 0);
+    slots = layout.Slots();
+    params.assign(layout.Parameters().size(), 0.0f);
+    buffers.assign(layout.Buffers().size(), 0.0f);
+    if (with_optimizer) {
+        adam_m.assign(params.size(), 0.0f);
+        adam_v.assign(params.size(), 0.0f);
+    } else {
+        adam_m.clear();
+        adam_v.clear();
+    }
+}
+
+std::vector<WeightTensor> ModelWeights::Tensors() const {
+    std::vector<WeightTensor> tensors;
+    auto add = [&](const std::vector<float>& source, const std::string& kind) {
+        if (source.empty()) {
+            return;
+        }
+        for (const auto& slot : slots) {
+            tensors.push_back({slot.name, kind, source.data() + slot.offset, slot.size});
+        }
+    };
+    add(params, "param");
+    add(adam_m, "adam_m");
+    add(adam_v, "adam_v");
+    if (!buffers.empty()) {
+        tensors.push_back({"buffers", "buffer", buffers.data(), static_cast<int64_t>(buffers.size())});
+    }
+    return tensors;
+}
+
+void ModelWeights::LoadTensor(const std::string& name, const std::string& kind, const float* data, int64_t size) {
+    auto mismatch = [&]() {
+        return std::runtime_error("Stored tensor '" + name + "' (" + kind + ") of model '" + model_name +
+                                  "' does not match its architecture.");
+    };
+    if (kind == "buffer") {
+        if (size != static_cast<int64_t>(buffers.size())) {
+            throw mismatch();
+        }
+        std::copy(data, data + size, buffers.begin());
+        return;
+    }
+    std::vector<float>* target = nullptr;
+    if (kind == "param") {
+        target = &params;
+    } else if (kind == "adam_m") {
+        target = &adam_m;
+    } else if (kind == "adam_v") {
+        target = &adam_v;
+    }
+    if (!target || target->empty()) {
+        throw mismatch();
+    }
+    for (const auto& slot : slots) {
+        if (slot.name == name) {
+            if (slot.size != size) {
+                throw mismatch();
+            }
+            std::copy(data, data + size, target->begin() + slot.offset);
+            return;
+        }
+    }
+    throw mismatch();
+}
+
+void ModelWeights::Restore(Mlp& model) const {
+    if (params.size() != model.Parameters().size() || buffers.size() != model.Buffers().size()) {
+        throw std::runtime_error("Stored weights of model '" + model_name + "' do not match its architecture.");
+    }
+    std::copy(params.begin(), params.end(), model.Parameters().begin());
+    std::copy(buffers.begin(), buffers.end(), model.Buffers().begin());
+}
+
+nlohmann::json ModelWeights::Summary() const {
+    return {
+        {"model", model_name},
+        {"key", key},
+        {"rows", rows},
+        {"train_loss", train_loss},
+        {"params", params.size()},
+        {"adam_steps", adam_steps},
+        {"last_rowid", last_rowid},
+        {"reg_args", config.ToJson()}
+    };
+}
+
+} // namespace regdb
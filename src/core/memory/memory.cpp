@@ -0,0 +1,145 @@
+#include "regdb/core/memory.hpp"
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/cache.hpp"
+#include "duckdb/storage/buffer/buffer_handle.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+namespace regdb {
+
+namespace {
+
+class BufferManagerBlock;
+
+// 一个数据库实例分配出的全部块. 实例关闭前 Shutdown 把仍存活的块搬到进程堆并归还 BufferManager 的块,
+// 之后 manager 为空, 块不再访问 BufferManager
+struct BlockRegistry {
+    std::mutex lock;
+    duckdb::BufferManager* manager = nullptr;
+    std::unordered_set<BufferManagerBlock*> blocks;
+
+    void Shutdown();
+};
+
+// 以 MemoryTag::EXTENSION 注册的 BufferManager 内存块, can_destroy 为 false, 被换出时写入临时文件
+class BufferManagerBlock : public MemoryBlock {
+public:
+    BufferManagerBlock(std::shared_ptr<BlockRegistry> registry, MemoryCategory category, int64_t bytes)
+        : MemoryBlock(category, bytes), registry_(std::move(registry)) {
+        std::lock_guard<std::mutex> guard(registry_->lock);
+        if (!registry_->manager) {
+            throw std::runtime_error("Database instance for regdb memory has been closed.");
+        }
+        // 超过 memory_limit 且无法换出其他块时抛出 OutOfMemoryException
+        handle_ = duckdb::make_uniq<duckdb::BufferHandle>(registry_->manager->Allocate(
+            duckdb::MemoryTag::EXTENSION, static_cast<duckdb::idx_t>(bytes), false));
+        block_ = handle_->GetBlockHandle();
+        registry_->blocks.insert(this);
+    }
+
+    ~BufferManagerBlock() override {
+        std::lock_guard<std::mutex> guard(registry_->lock);
+        registry_->blocks.erase(this);
+        // 实例关闭后 handle_ 和 block_ 已在 Detach 中释放
+        handle_.reset();
+        block_.reset();
+    }
+
+    uint8_t* Data() override {
+        return handle_ ? handle_->Ptr() : heap_.get();
+    }
+
+    void Unpin() override {
+        std::lock_guard<std::mutex> guard(registry_->lock);
+        handle_.reset();
+    }
+
+    void Pin() override {
+        std::lock_guard<std::mutex> guard(registry_->lock);
+        if (handle_ || heap_) {
+            return;
+        }
+        handle_ = duckdb::make_uniq<duckdb::BufferHandle>(registry_->manager->Pin(block_));
+    }
+
+    // 调用方持有 registry 的锁, BufferManager 仍然有效
+    void Detach() {
+        if (!handle_) {
+            handle_ = duckdb::make_uniq<duckdb::BufferHandle>(registry_->manager->Pin(block_));
+        }
+        heap_.reset(new uint8_t[Bytes()]);
+        std::memcpy(heap_.get(), handle_->Ptr(), static_cast<size_t>(Bytes()));
+        handle_.reset();
+        block_.reset();
+    }
+
+private:
+    std::shared_ptr<BlockRegistry> registry_;
+    duckdb::shared_ptr<duckdb::BlockHandle> block_;
+    duckdb::unique_ptr<duckdb::BufferHandle> handle_;
+    std::unique_ptr<uint8_t[]> heap_;       // 实例关闭后块的内容
+};
+
+void BlockRegistry::Shutdown() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto* block : blocks) {
+        block->Detach();
+    }
+    manager = nullptr;
+}
+
+class BufferManagerBackend : public MemoryBackend {
+public:
+    explicit BufferManagerBackend(std::shared_ptr<BlockRegistry> registry) : registry_(std::move(registry)) {}
+
+    std::unique_ptr<MemoryBlock> Allocate(MemoryCategory category, int64_t bytes) override {
+        return std::make_unique<BufferManagerBlock>(registry_, category, bytes);
+    }
+
+private:
+    std::shared_ptr<BlockRegistry> registry_;
+};
+
+// 放在实例的 ObjectCache 中, DatabaseInstance 析构时先于 BufferManager 释放, 借此在关闭前归还全部块
+class MemoryShutdown : public duckdb::ObjectCacheEntry {
+public:
+    MemoryShutdown(std::shared_ptr<BlockRegistry> registry, std::shared_ptr<MemoryBackend> backend)
+        : registry_(std::move(registry)), backend_(std::move(backend)) {}
+
+    ~MemoryShutdown() override {
+        // 跨查询缓存的矩阵和池中空闲的 arena 可能来自这个实例, 先释放; 其他实例的条目之后按需重新加载
+        DatasetCache::Instance().Clear();
+        ArenaPool::Instance().Clear();
+        // 仍被持有的块搬到进程堆, 之后的分配回到进程堆, 除非其他实例已经安装了自己的后端
+        registry_->Shutdown();
+        Memory::ResetBackend(backend_.get());
+    }
+
+    std::string GetObjectType() override {
+        return ObjectType();
+    }
+
+    static std::string ObjectType() {
+        return "regdb_memory_shutdown";
+    }
+
+private:
+    std::shared_ptr<BlockRegistry> registry_;
+    std::shared_ptr<MemoryBackend> backend_;
+};
+
+} // namespace
+
+void BufferManagerMemory::Install(duckdb::DatabaseInstance& db) {
+    auto registry = std::make_shared<BlockRegistry>();
+    registry->manager = &duckdb::BufferManager::GetBufferManager(db);
+    auto backend = std::make_shared<BufferManagerBackend>(registry);
+    db.GetObjectCache().Put(MemoryShutdown::ObjectType(), duckdb::make_shared_ptr<MemoryShutdown>(registry, backend));
+    Memory::SetBackend(std::move(backend));
+}
+
+} // namespace regdb
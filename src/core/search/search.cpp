@@ -0,0 +1,346 @@
+#include "regdb/core/search/search.hpp"
+#include "regdb/core/engine/checkpoint.hpp"
+#include "regdb/core/engine/model_type.hpp"
+#include "regdb/core/engine/stacked_mlp.hpp"
+#include "filesystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace regdb {
+
+namespace {
+
+// 汇总 k 折的训练结果: 只保留所有折都完成的 epoch, 曲线逐 epoch 取平均, 最优 epoch 在平均验证曲线上选取.
+// 各折训练时不提前停止, 停止规则在平均验证曲线上逐 epoch 重放, 停止之后的 epoch 丢弃; 平均损失提供给 incumbent
+TrainResult CombineFolds(const std::vector<TrainResult>& folds, std::vector<double>& fold_losses,
+                         const EarlyStopSpec& early_stop, int64_t max_epochs, Incumbent& incumbent) {
+    TrainResult combined;
+    auto epochs = std::numeric_limits<size_t>::max();
+    auto train_epochs = std::numeric_limits<size_t>::max();
+    for (const auto& fold : folds) {
+        epochs = std::min(epochs, fold.val_curve.size());
+        train_epochs = std::min(train_epochs, fold.train_curve.size());
+        combined.steps += fold.steps;
+        combined.preempted = combined.preempted || fold.preempted;
+    }
+    const auto scale = 1.0 / static_cast<double>(folds.size());
+    combined.val_curve.assign(epochs, 0.0);
+    combined.train_curve.assign(train_epochs, 0.0);
+    for (const auto& fold : folds) {
+        for (size_t epoch = 0; epoch < epochs; ++epoch) {
+            combined.val_curve[epoch] += fold.val_curve[epoch] * scale;
+        }
+        for (size_t epoch = 0; epoch < train_epochs; ++epoch) {
+            combined.train_curve[epoch] += fold.train_curve[epoch] * scale;
+        }
+    }
+    // 各折已经训练完, 外推不再节省时间, 只重放 patience
+    auto patience = early_stop;
+    patience.extrapolate = false;
+    EarlyStopping stopping(patience, max_epochs, nullptr);
+    std::vector<double> prefix;
+    for (size_t epoch = 0; epoch < epochs; ++epoch) {
+        prefix.push_back(combined.val_curve[epoch]);
+        incumbent.Offer(combined.val_curve[epoch]);
+        if (stopping.Update(prefix)) {
+            combined.stopped_early = true;
+            epochs = epoch + 1;
+            combined.val_curve.resize(epochs);
+            combined.train_curve.resize(std::min(train_epochs, epochs));
+            break;
+        }
+    }
+    for (size_t epoch = 0; epoch < epochs; ++epoch) {
+        if (combined.val_curve[epoch] < combined.best_val_loss) {
+            combined.best_val_loss = combined.val_curve[epoch];
+            combined.best_epoch = static_cast<int64_t>(epoch);
+        }
+    }
+    fold_losses.clear();
+    if (combined.best_epoch >= 0) {
+        for (const auto& fold : folds) {
+            fold_losses.push_back(fold.val_curve[combined.best_epoch]);
+        }
+    }
+    return combined;
+}
+
+} // namespace
+
+nlohmann::json SearchResult::ToJson() const {
+    nlohmann::json json;
+    json["stop_reason"] = StopReasonToString(stop_reason);
+    json["elapsed_ms"] = elapsed_ms;
+    json["trials_total"] = trials_total;
+    json["trials_run"] = trials.size();
+    json["trials_preempted"] = std::count_if(trials.begin(), trials.end(),
+                                             [](const TrialResult& trial) { return trial.train.preempted; });
+    json["trials_stopped_early"] = std::count_if(trials.begin(), trials.end(),
+                                                 [](const TrialResult& trial) { return trial.train.stopped_early; });
+    if (best < 0) {
+        json["best"] = nullptr;
+        return json;
+    }
+    const auto& trial = trials[best];
+    json["best"] = {
+        {"trial_id", trial.trial_id},
+        {"reg_args", trial.config.ToJson()},
+        {"val_loss", trial.train.best_val_loss},
+        {"best_epoch", trial.train.best_epoch},
+        {"preempted", trial.train.preempted},
+        {"stopped_early", trial.train.stopped_early},
+        {"val_curve", trial.train.val_curve},
+        {"train_curve", trial.train.train_curve}
+    };
+    if (trial.train.partial_rows > 0) {
+        json["best"]["partial_train_loss"] = trial.train.partial_train_loss;
+    }
+    if (!trial.fold_losses.empty()) {
+        const auto folds = static_cast<double>(trial.fold_losses.size());
+        double variance = 0.0;
+        for (auto loss : trial.fold_losses) {
+            variance += (loss - trial.train.best_val_loss) * (loss - trial.train.best_val_loss) / folds;
+        }
+        json["best"]["folds"] = trial.fold_losses.size();
+        json["best"]["fold_val_loss"] = trial.fold_losses;
+        json["best"]["val_loss_std"] = std::sqrt(variance);
+    }
+    return json;
+}
+
+SearchResult RegSearch::Run(StopToken& token) const {
+    const auto configs = space_.Enumerate();
+    const auto folds = source_ ? 1 : std::max<int64_t>(1, options_.folds);
+    DataSplit split;
+    BlockSplit block_split;
+    // k 折时所有折共享同一个打乱顺序, 每折的行号划分在训练该折时才生成
+    std::vector<int64_t> order;
+    if (source_) {
+        block_split = SplitBlocks(source_->Rows(), options_.stream.block_rows, options_.validation_fraction,
+                                  options_.train.seed);
+    } else if (folds > 1) {
+        order = ShuffleRows(data_->rows, options_.train.seed);
+        SplitFold(order, folds, 0);     // 校验折数
+    } else {
+        split = SplitHoldout(data_->rows, options_.validation_fraction, options_.train.seed);
+    }
+
+    SearchResult result;
+    result.trials_total = static_cast<int64_t>(configs.size());
+
+    auto& pool = ThreadPool::Instance();
+    const auto available = options_.max_threads > 0 ? std::min(options_.max_threads, pool.Threads())
+                                                    : pool.Threads();
+    const auto stack = source_ ? 1 : std::max<int64_t>(1, options_.stack_size);
+    // 相邻的 trial 按 stack 个一组堆叠; 开启增强的 trial 输入各不相同, 不能共享 minibatch, 单独训练
+    std::vector<std::pair<int64_t, int64_t>> packs;
+    for (int64_t first = 0; first < result.trials_total;) {
+        int64_t count = 1;
+        if (!configs[first].use_data_augment) {
+            while (count < stack && first + count < result.trials_total &&
+                   !configs[first + count].use_data_augment) {
+                ++count;
+            }
+        }
+        packs.emplace_back(first, count);
+        first += count;
+    }
+    // 每组的每一折是一个独立的任务, 同一组的各折相邻, 尽早凑齐一个 trial 的全部折
+    const auto tasks = static_cast<int64_t>(packs.size()) * folds;
+    // 流式训练的每个 trial 还要借一个预取线程
+    const auto concurrency = source_ ? available / 2 : available;
+    auto lease = pool.Acquire(std::max<int64_t>(1, std::min<int64_t>(concurrency, tasks)));
+    const auto threads = lease.Workers();
+    // 任务数少于线程数时, 多出的线程用于单个 trial 内的数据并行
+    auto train_options = options_.train;
+    // 提前停止的 trial 让出线程给后面的配置; 外推与所有 trial 至今的最优验证损失比较
+    Incumbent incumbent;
+    train_options.incumbent = &incumbent;
+    if (stack == 1) {
+        train_options.threads = std::max<int64_t>(train_options.threads, available / threads);
+    }
+    // k 折时单折的曲线不代表 trial: 难的一折会被容易的一折 (可能来自同一 trial) 设下的最优值停止, 各折停在不同
+    // epoch 又使平均曲线被截短. 各折不提前停止, 汇总时在平均曲线上判断
+    const auto early_stop = train_options.early_stop;
+    if (folds > 1) {
+        train_options.early_stop = EarlyStopSpec();
+        train_options.incumbent = nullptr;
+    }
+    // 流式数据源没有内存中的 Dataset, 用空数据集占位
+    const Dataset empty;
+    const Trainer trainer(data_ ? *data_ : empty, split, train_options);
+
+    // k 折的中间结果, 一组的最后一折完成时汇总
+    std::vector<std::vector<TrainResult>> fold_results(folds > 1 ? configs.size() : 0);
+    for (auto& results : fold_results) {
+        results.resize(folds);
+    }
+    std::vector<int64_t> pending(packs.size(), folds);
+
+    // 检查点: 每个 trial 的每一折一个子目录; 不续跑时清掉上一次留下的检查点
+    const auto checkpointing = !options_.checkpoint_dir.empty();
+    if (checkpointing && !options_.resume) {
+        std::error_code ignored;
+        std::filesystem::remove_all(options_.checkpoint_dir, ignored);
+    }
+    auto trial_directory = [&](int64_t trial, int64_t fold) {
+        auto name = "trial-" + std::to_string(trial);
+        if (folds > 1) {
+            name += "-fold-" + std::to_string(fold);
+        }
+        return (std::filesystem::path(options_.checkpoint_dir) / name).string();
+    };
+
+    std::atomic<int64_t> next{0};
+    std::mutex lock;
+    std::exception_ptr error;
+    auto worker = [&](int64_t) {
+        try {
+            while (!token.ShouldStop()) {
+                const auto task = next.fetch_add(1);
+                if (task >= tasks) {
+                    break;
+                }
+                const auto pack = task / folds;
+                const auto fold = task % folds;
+                const auto first = packs[pack].first;
+                const auto count = packs[pack].second;
+
+                // 每折只保存行号, 特征矩阵在所有折和 trial 之间共享
+                DataSplit fold_split;
+                if (folds > 1) {
+                    fold_split = SplitFold(order, folds, fold);
+                }
+                const Trainer fold_trainer(data_ ? *data_ : empty, fold_split, train_options);
+                const auto& active = folds > 1 ? fold_trainer : trainer;
+
+                // 续跑时整组 trial 都已完成则直接复用结果; 单个 trial 未完成时从它的检查点继续
+                std::vector<TrainResult> train_results;
+                std::vector<Checkpoint> checkpoints(checkpointing && options_.resume ? count : 0);
+                bool reused = !checkpoints.empty();
+                for (int64_t k = 0; k < static_cast<int64_t>(checkpoints.size()); ++k) {
+                    reused = Checkpoint::Load(trial_directory(first + k, fold), checkpoints[k]) &&
+                             checkpoints[k].finished && reused;
+                }
+                if (reused) {
+                    for (const auto& checkpoint : checkpoints) {
+                        train_results.push_back(checkpoint.Progress());
+                        if (folds == 1) {
+                            incumbent.Offer(train_results.back().best_val_loss);
+                        }
+                    }
+                } else if (count == 1 && !source_ && checkpointing) {
+                    Mlp model(spec_, configs[first], options_.train.seed + first);
+                    Checkpointer checkpointer(trial_directory(first, fold),
+                                              std::chrono::milliseconds(options_.checkpoint_interval_ms));
+                    auto trial_options = train_options;
+                    trial_options.checkpointer = &checkpointer;
+                    if (!checkpoints.empty() && !checkpoints[0].params.empty()) {
+                        trial_options.resume = &checkpoints[0];
+                    }
+                    const Trainer resumable(data_ ? *data_ : empty, folds > 1 ? fold_split : split, trial_options);
+                    train_results.push_back(resumable.Train(model, token));
+                    if (!train_results.back().preempted) {
+                        checkpointer.Finish(train_results.back());
+                    }
+                } else if (count == 1) {
+                    Mlp model(spec_, configs[first], options_.train.seed + first);
+                    train_results.push_back(source_ ? StreamTrainer(*source_, block_split, train_options,
+                                                                    options_.stream).Train(model, token)
+                                                    : active.Train(model, token));
+                } else {
+                    std::vector<RegConfig> pack_configs(configs.begin() + first, configs.begin() + first + count);
+                    std::vector<uint64_t> seeds(count);
+                    for (int64_t k = 0; k < count; ++k) {
+                        seeds[k] = options_.train.seed + first + k;
+                    }
+                    StackedMlp model(spec_, pack_configs, seeds);
+                    train_results = active.TrainStacked(model, token);
+                }
+                // 堆叠和流式训练没有中途检查点, 只记录完成的结果
+                if (checkpointing && !reused && (count > 1 || source_)) {
+                    for (int64_t k = 0; k < count; ++k) {
+                        if (!train_results[k].preempted) {
+                            Checkpointer::WriteResult(trial_directory(first + k, fold), train_results[k]);
+                        }
+                    }
+                }
+
+                std::vector<TrialResult> trials(count);
+                for (int64_t k = 0; k < count; ++k) {
+                    trials[k].trial_id = first + k;
+                    trials[k].config = configs[first + k];
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                if (folds > 1) {
+                    for (int64_t k = 0; k < count; ++k) {
+                        fold_results[first + k][fold] = std::move(train_results[k]);
+                    }
+                    if (--pending[pack] > 0) {
+                        continue;
+                    }
+                    for (int64_t k = 0; k < count; ++k) {
+                        trials[k].train = CombineFolds(fold_results[first + k], trials[k].fold_losses, early_stop,
+                                                       options_.train.max_epochs, incumbent);
+                        fold_results[first + k].clear();
+                    }
+                } else {
+                    for (int64_t k = 0; k < count; ++k) {
+                        trials[k].train = std::move(train_results[k]);
+                    }
+                }
+                for (auto& trial : trials) {
+                    result.trials.push_back(std::move(trial));
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!error) {
+                error = std::current_exception();
+            }
+            // 让其他 trial 尽快退出
+            token.RequestStop(StopReason::INTERRUPTED);
+        }
+    };
+
+    lease.Run(worker);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    for (size_t i = 0; i < result.trials.size(); ++i) {
+        const auto& trial = result.trials[i];
+        if (trial.train.best_epoch >= 0 &&
+            (result.best < 0 || trial.train.best_val_loss < result.trials[result.best].train.best_val_loss)) {
+            result.best = static_cast<int64_t>(i);
+        }
+    }
+    result.stop_reason = token.Reason();
+    result.elapsed_ms = token.GetDeadline().Elapsed().count();
+    return result;
+}
+
+int64_t RegSearch::AutoStackSize(const ModelSpec& spec, int64_t trials, int64_t threads) {
+    // 堆叠工作集 (参数 + 梯度 + Adam 两个矩) 控制在 L2 量级, 超出后 GEMM 反而变慢
+    constexpr int64_t WORKING_SET_BYTES = int64_t(2) << 20;
+    const auto cost = ModelTypeRegistry::Instance().Get(spec.model_type).Cost(spec);
+    int64_t stack = 1;
+    if (cost.widest <= 32) {
+        stack = 16;
+    } else if (cost.widest <= 64) {
+        stack = 4;
+    }
+    const auto trial_bytes = cost.parameters * 4 * static_cast<int64_t>(sizeof(float));
+    stack = std::min(stack, std::max<int64_t>(1, WORKING_SET_BYTES / trial_bytes));
+    const auto per_thread = (trials + std::max<int64_t>(1, threads) - 1) / std::max<int64_t>(1, threads);
+    return std::max<int64_t>(1, std::min(stack, per_thread));
+}
+
+} // namespace regdb
@@ -1,6 +1,7 @@
 #include "regdb/custom_parser/query/model_parser.hpp"
 #include "regdb/core/common.hpp"
 #include "regdb/core/config.hpp"
+#include "regdb/core/engine/spec.hpp"
 #include <sstream>
 #include <stdexcept>
 
@@ -72,14 +73,8 @@ void ModelParser::ParseCreateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
         throw std::runtime_error("Expected json value for the model_args.");
     }
     auto model_args = nlohmann::json::parse(token.value);
-    const std::set<std::string> expected_keys = {"in_features", "out_features", "hidden_features"};
-    std::set<std::string> json_keys;
-    for (auto it = model_args.begin(); it != model_args.end(); ++it) {
-        json_keys.insert(it.key());
-    }
-    if (json_keys != expected_keys) {
-        throw std::runtime_error("Expected keys: in_features, out_features, hidden_features in model_args.");
-    }
+    // 按 model_type 注册的参数表校验, 注册新的 MLP 结构不需要修改解析器
+    ModelSpec::FromJson(model_type, model_args);
     token = tokenizer.NextToken();
     if (token.type != TokenType::PARENTHESIS || token.value != ")") {
         throw std::runtime_error("Expected closing parenthesis ')' after model_args.");
@@ -125,6 +120,7 @@ void ModelParser::ParseUpdateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
     auto token = tokenizer.NextToken();
     auto value = duckdb::StringUtil::Upper(token.value);
     // UPDATE MODEL <model_name> TO [GLOABL|LOCAL];
+    // UPDATE MODEL <model_name> PARTIAL FIT ON <table> [SINCE <rowid>|'<predicate>'];
     // UPDATE MODEL ( <model_name>, <model_type>, <model_args_json>)
     if (token.type != TokenType::KEYWORD || value != "MODEL") {
         throw std::runtime_error("Expected 'MODEL' after 'UPDATE'.");
@@ -133,8 +129,12 @@ void ModelParser::ParseUpdateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
     if (token.type == TokenType::STRING_LITERAL) {
         auto model_name = token.value;
         token = tokenizer.NextToken();
+        if (token.type == TokenType::KEYWORD && duckdb::StringUtil::Upper(token.value) == "PARTIAL") {
+            ParsePartialFit(tokenizer, model_name, statement);
+            return;
+        }
         if (token.type != TokenType::KEYWORD || duckdb::StringUtil::Upper(token.value) != "TO") {
-            throw std::runtime_error("Expect 'TO' after model name.");
+            throw std::runtime_error("Expect 'TO' or 'PARTIAL FIT' after model name.");
         }
         token = tokenizer.NextToken();
         value = duckdb::StringUtil::Upper(token.value);
@@ -181,14 +181,7 @@ void ModelParser::ParseUpdateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
             throw std::runtime_error("Expected json value for the model args.");
         }
         auto new_model_args = nlohmann::json::parse(token.value);
-        const std::set<std::string> expected_keys = {"in_features", "out_features", "hidden_features"};
-        std::set<std::string> json_keys;
-        for (auto it = new_model_args.begin(); it != new_model_args.end(); ++it) {
-            json_keys.insert(it.key());
-        }
-        if (json_keys != expected_keys) {
-            throw std::runtime_error("Expected keys: in_features, out_features, hidden_features in model_args.");
-        }
+        ModelSpec::FromJson(model_type, new_model_args);
         token = tokenizer.NextToken();
         if (token.type != TokenType::PARENTHESIS || token.value != ")") {
             throw std::runtime_error("Expected closing parenthesis ')' after new max_output_tokens.");
@@ -207,6 +200,45 @@ void ModelParser::ParseUpdateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
     }
 }
 
+void ModelParser::ParsePartialFit(Tokenizer& tokenizer, const std::string& model_name,
+                                  std::unique_ptr<QueryStatement>& statement) {
+    auto token = tokenizer.NextToken();
+    if (token.type != TokenType::KEYWORD || duckdb::StringUtil::Upper(token.value) != "FIT") {
+        throw std::runtime_error("Expected 'FIT' after 'PARTIAL'.");
+    }
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::KEYWORD || duckdb::StringUtil::Upper(token.value) != "ON") {
+        throw std::runtime_error("Expected 'ON' after 'PARTIAL FIT'.");
+    }
+    token = tokenizer.NextToken();
+    if ((token.type != TokenType::KEYWORD && token.type != TokenType::STRING_LITERAL) || token.value.empty()) {
+        throw std::runtime_error("Expected a table name after 'ON'.");
+    }
+    auto fit_statement = std::make_unique<PartialFitModelStatement>();
+    fit_statement->model_name = model_name;
+    fit_statement->table_name = token.value;
+
+    token = tokenizer.NextToken();
+    if (token.type == TokenType::KEYWORD && duckdb::StringUtil::Upper(token.value) == "SINCE") {
+        token = tokenizer.NextToken();
+        if (token.type == TokenType::NUMBER) {
+            fit_statement->since = "rowid >= " + token.value;
+        } else if (token.type == TokenType::STRING_LITERAL && !token.value.empty()) {
+            fit_statement->since = token.value;
+        } else {
+            throw std::runtime_error("Expected a rowid or a string literal predicate after 'SINCE'.");
+        }
+        token = tokenizer.NextToken();
+    }
+    if (token.type == TokenType::SYMBOL && token.value == ";") {
+        token = tokenizer.NextToken();
+    }
+    if (token.type != TokenType::END_OF_FILE) {
+        throw std::runtime_error("Unexpected characters after PARTIAL FIT. Only a semicolon is allowed.");
+    }
+    statement = std::move(fit_statement);
+}
+
 void ModelParser::ParseGetModel(Tokenizer &tokenizer, std::unique_ptr<QueryStatement>& statement) {
     auto token = tokenizer.NextToken();
     auto value = duckdb::StringUtil::Upper(token.value);
@@ -331,6 +363,14 @@ std::string ModelParser::ToSQL(const QueryStatement& statement) const {
                                    update_stmt.catalog == "regdb_storage." ? "" : "regdb_storage.",
                                    update_stmt.model_name);
         break;
+    }
+	case StatementType::PARTIAL_FIT_MODEL: {
+        const auto& fit_stmt = static_cast<const PartialFitModelStatement&>(statement);
+        // 训练在 partial_fit_model 中执行, 返回一行 JSON 摘要
+        query = duckdb_fmt::format(" SELECT partial_fit_model('{}', '{}', '{}') AS partial_fit; ",
+                                   EscapeQuotes(fit_stmt.model_name), EscapeQuotes(fit_stmt.table_name),
+                                   EscapeQuotes(fit_stmt.since));
+        break;
     }
 	case StatementType::GET_MODEL: {
         const auto& get_stmt = static_cast<const GetModelStatement&>(statement);
@@ -0,0 +1,144 @@
+#include "regdb/custom_parser/query/predict_parser.hpp"
+
+#include "regdb/core/common.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace regdb {
+
+namespace {
+
+// 标识符加双引号, 内部的双引号加倍
+std::string QuoteIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (auto c : name) {
+        quoted += c;
+        if (c == '"') {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+void PredictParser::Parse(const std::string& query, std::unique_ptr<QueryStatement>& statement) {
+    Tokenizer tokenizer(query);
+    const char* const expected[] = {"PREDICT", "USING"};
+    for (const auto* keyword : expected) {
+        auto token = tokenizer.NextToken();
+        if (token.type != TokenType::KEYWORD || duckdb::StringUtil::Upper(token.value) != keyword) {
+            throw std::runtime_error(duckdb_fmt::format("Expected '{}' but got '{}'.", keyword, token.value));
+        }
+    }
+
+    // USING MODEL 'model' 或 USING ENSEMBLE 'model', 'model', ...
+    auto token = tokenizer.NextToken();
+    const auto kind = duckdb::StringUtil::Upper(token.value);
+    if (token.type != TokenType::KEYWORD || (kind != "MODEL" && kind != "ENSEMBLE")) {
+        throw std::runtime_error("Expected 'MODEL' or 'ENSEMBLE' after 'USING'.");
+    }
+    auto predict_statement = std::make_unique<PredictStatement>();
+    predict_statement->ensemble = kind == "ENSEMBLE";
+    while (true) {
+        token = tokenizer.NextToken();
+        if (predict_statement->ensemble && predict_statement->model_names.empty() &&
+            token.type == TokenType::KEYWORD && duckdb::StringUtil::Upper(token.value) == "FROM") {
+            throw std::runtime_error("Expected at least one model after 'ENSEMBLE'.");
+        }
+        if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+            throw std::runtime_error("Expected non-empty string literal for model_name.");
+        }
+        // 同一成员出现两次会让它在平均中占双倍权重, 多半是笔误
+        const auto& names = predict_statement->model_names;
+        if (std::find(names.begin(), names.end(), token.value) != names.end()) {
+            throw std::runtime_error(duckdb_fmt::format("Model '{}' appears more than once in the ensemble.",
+                                                        token.value));
+        }
+        predict_statement->model_names.push_back(token.value);
+        token = tokenizer.NextToken();
+        if (!predict_statement->ensemble || token.type != TokenType::SYMBOL || token.value != ",") {
+            break;
+        }
+    }
+
+    if (token.type != TokenType::KEYWORD || duckdb::StringUtil::Upper(token.value) != "FROM") {
+        throw std::runtime_error("Expected 'FROM' after the model name.");
+    }
+
+    // FROM 之后是任意 SQL, 原样交给 DuckDB. 用 tokenizer 扫过全部 token 并记下各自在 source 中的位置,
+    // 只识别末尾的 INTO 表名和分号, 字符串字面量里的 INTO 不会被误认
+    const auto source = tokenizer.Remaining();
+    std::vector<std::pair<Token, size_t>> tokens;
+    while (true) {
+        const auto offset = source.size() - tokenizer.Remaining().size();
+        token = tokenizer.NextToken();
+        if (token.type == TokenType::END_OF_FILE) {
+            break;
+        }
+        tokens.emplace_back(token, offset);
+    }
+    auto end = tokens.size();
+    while (end > 0 && tokens[end - 1].first.type == TokenType::SYMBOL && tokens[end - 1].first.value == ";") {
+        --end;
+    }
+    if (end >= 1 && tokens[end - 1].first.type == TokenType::KEYWORD &&
+        duckdb::StringUtil::Upper(tokens[end - 1].first.value) == "INTO") {
+        throw std::runtime_error("Expected a table name after 'INTO'.");
+    }
+    if (end >= 2 && tokens[end - 2].first.type == TokenType::KEYWORD &&
+        duckdb::StringUtil::Upper(tokens[end - 2].first.value) == "INTO") {
+        const auto& target = tokens[end - 1].first;
+        // schema.table 按 '.' 拆开, 字符串字面量整体作为一个名字
+        if (target.type == TokenType::KEYWORD) {
+            predict_statement->into = duckdb::StringUtil::Split(target.value, '.');
+        } else if (target.type == TokenType::STRING_LITERAL && !target.value.empty()) {
+            predict_statement->into = {target.value};
+        } else {
+            throw std::runtime_error("Expected a table name after 'INTO'.");
+        }
+        end -= 2;
+    }
+    if (end == 0) {
+        throw std::runtime_error("Expected a table name or query after 'FROM'.");
+    }
+    predict_statement->table = end == 1 && tokens[0].first.type == TokenType::KEYWORD;
+    auto text = source.substr(0, end < tokens.size() ? tokens[end].second : source.size());
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.pop_back();
+    }
+    predict_statement->source = std::move(text);
+    statement = std::move(predict_statement);
+}
+
+std::string PredictParser::ToSQL(const QueryStatement& statement) const {
+    if (statement.type != StatementType::PREDICT) {
+        throw std::runtime_error("Unknown statement type.");
+    }
+    const auto& predict_statement = static_cast<const PredictStatement&>(statement);
+    // 单个表名按 FROM 表名 扫描, 其余原样作为子查询
+    const auto& source = predict_statement.source;
+    const auto subquery = predict_statement.table ? "FROM " + source : source;
+    // 集成传入模型名列表, 由 regdb_predict 在一次扫描中对全部成员打分
+    std::string models;
+    for (const auto& model_name : predict_statement.model_names) {
+        models += (models.empty() ? "'" : ", '") + EscapeQuotes(model_name) + "'";
+    }
+    if (predict_statement.ensemble) {
+        models = "[" + models + "]";
+    }
+    const auto select = duckdb_fmt::format("SELECT * FROM regdb_predict(({}), {})", subquery, models);
+    if (predict_statement.into.empty()) {
+        return select + ";";
+    }
+    std::string into;
+    for (const auto& part : predict_statement.into) {
+        into += (into.empty() ? "" : ".") + QuoteIdentifier(part);
+    }
+    return duckdb_fmt::format("CREATE TABLE {} AS {};", into, select);
+}
+
+} // namespace regdb
@@ -11,6 +11,11 @@ std::string QueryParser::ParseQuery(const std::string& query  ) {
     Tokenizer tokenizer(query);
     auto token = tokenizer.NextToken();
     auto value = duckdb::StringUtil::Upper(token.value);
+    if (token.type == TokenType::KEYWORD && value == "PREDICT") {
+        PredictParser predict_parser;
+        predict_parser.Parse(query, statement);
+        return predict_parser.ToSQL(*statement);
+    }
     if (token.type != TokenType::KEYWORD ||
         (value != "CREATE" && value != "DELETE" && value != "UPDATE" && value != "GET")) {
         throw std::runtime_error(duckdb_fmt::format("Unknown keyword: {}", token.value));
@@ -20,6 +20,12 @@ std::string Tokenizer::GetQuery() {
     return query_;
 }
 
+// 当前位置之后未解析的原始文本, 用于把嵌入的 SQL 原样交给 DuckDB
+std::string Tokenizer::Remaining() {
+    SkipWhitespace();
+    return query_.substr(position_);
+}
+
 // 解析一个字符串
 Token Tokenizer::ParseStringLiteral() {
     if (query_[position_] != '\'') {
@@ -60,10 +66,11 @@ Token Tokenizer::ParseJson() {
     return {TokenType::JSON, value};
 }
 
-// 解析关键词
+// 解析关键词, 首字符之后允许数字和 '.', 表名可以写成 schema.table_2024
 Token Tokenizer::ParseKeyword() {
     auto start = position_;
-    while (position_ < static_cast<int>(query_.size()) && (std::isalpha(query_[position_]) || query_[position_] == '_')) {
+    while (position_ < static_cast<int>(query_.size()) &&
+           (std::isalnum(query_[position_]) || query_[position_] == '_' || query_[position_] == '.')) {
         ++position_;
     }
     auto value = query_.substr(start, position_ - start);
@@ -114,6 +121,8 @@ Token Tokenizer::GetNextToken() {
     } else if (std::isdigit(ch)) {
         return ParseNumber();
     } else {
+        // 跳过无法识别的字符, 扫描嵌入的 SQL 时运算符等字符不会卡住
+        ++position_;
         return {TokenType::UNKNOWN, std::string(1, ch)};
     }
 }
@@ -147,4 +156,15 @@ std::string TokenTypeToString(TokenType type) {
     }
 }
 
+std::string EscapeQuotes(const std::string& text) {
+    std::string escaped;
+    for (auto c : text) {
+        escaped += c;
+        if (c == '\'') {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
 } // namespace regdb
\ No newline at end of file
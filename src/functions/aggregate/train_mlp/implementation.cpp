@@ -0,0 +1,197 @@
+#include "regdb/functions/aggregate/train_mlp.hpp"
+#include "regdb/core/catalog.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace regdb {
+
+void PendingWeights::Add(ModelWeights weights) {
+    std::lock_guard<std::mutex> guard(lock_);
+    const auto id = std::make_pair(weights.model_name, weights.key);
+    if (std::find(query_keys_.begin(), query_keys_.end(), id) != query_keys_.end()) {
+        throw std::runtime_error(duckdb_fmt::format(
+            "train_mlp: more than one group trained model '{}' with weights_key '{}'; pass a key that differs "
+            "per group, e.g. the GROUP BY columns.", weights.model_name, weights.key));
+    }
+    query_keys_.push_back(id);
+    for (auto& entry : weights_) {
+        if (entry.model_name == weights.model_name && entry.key == weights.key) {
+            entry = std::move(weights);
+            return;
+        }
+    }
+    weights_.push_back(std::move(weights));
+}
+
+void PendingWeights::QueryBegin(duckdb::ClientContext&) {
+    std::lock_guard<std::mutex> guard(lock_);
+    query_keys_.clear();
+}
+
+// 在查询所在事务真正提交之前调用, 写入失败时异常使这次提交失败
+void PendingWeights::TransactionCommit(duckdb::MetaTransaction&, duckdb::ClientContext&) {
+    std::vector<ModelWeights> weights;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        weights.swap(weights_);
+    }
+    Catalog::SaveWeights(weights);
+}
+
+void PendingWeights::TransactionRollback(duckdb::MetaTransaction&, duckdb::ClientContext&) {
+    std::lock_guard<std::mutex> guard(lock_);
+    weights_.clear();
+}
+
+duckdb::unique_ptr<duckdb::FunctionData> TrainMlp::BindData::Copy() const {
+    return duckdb::make_uniq<BindData>(*this);
+}
+
+bool TrainMlp::BindData::Equals(const duckdb::FunctionData& other) const {
+    return model == other.Cast<BindData>().model;
+}
+
+// 模型名必须是常量, 结构在绑定时读取一次; 之后从参数中去掉, 执行时不再物化这一列
+duckdb::unique_ptr<duckdb::FunctionData> TrainMlp::Bind(duckdb::ClientContext& context,
+                                                        duckdb::AggregateFunction& function,
+                                                        duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
+    if (!arguments[0]->IsFoldable()) {
+        throw std::runtime_error("train_mlp expects a constant model name.");
+    }
+    auto data = duckdb::make_uniq<BindData>();
+    data->model = duckdb::ExpressionExecutor::EvaluateScalar(context, *arguments[0]).ToString();
+    data->spec = Catalog::GetModelSpec(data->model);
+    data->pending = context.registered_state->GetOrCreate<PendingWeights>(PendingWeights::NAME);
+    duckdb::Function::EraseArgument(function, arguments, 0);
+    return std::move(data);
+}
+
+duckdb::idx_t TrainMlp::StateSize(const duckdb::AggregateFunction&) {
+    return sizeof(State);
+}
+
+void TrainMlp::Initialize(const duckdb::AggregateFunction&, duckdb::data_ptr_t state) {
+    new (state) State{nullptr, nullptr};
+}
+
+// 输入为 features, label [, key]; 特征或标签为 NULL 的行跳过, 与 SQL 聚合函数的惯例一致
+void TrainMlp::Update(duckdb::Vector inputs[], duckdb::AggregateInputData& aggr_input_data, duckdb::idx_t input_count,
+                      duckdb::Vector& state_vector, duckdb::idx_t count) {
+    const auto& bind = aggr_input_data.bind_data->Cast<BindData>();
+    const auto in_features = bind.spec.in_features;
+
+    duckdb::UnifiedVectorFormat sdata;
+    state_vector.ToUnifiedFormat(count, sdata);
+    auto states = duckdb::UnifiedVectorFormat::GetData<State*>(sdata);
+
+    auto& features = inputs[0];
+    duckdb::UnifiedVectorFormat fdata;
+    features.ToUnifiedFormat(count, fdata);
+    const auto entries = duckdb::UnifiedVectorFormat::GetData<duckdb::list_entry_t>(fdata);
+    auto& child = duckdb::ListVector::GetEntry(features);
+    duckdb::UnifiedVectorFormat cdata;
+    child.ToUnifiedFormat(duckdb::ListVector::GetListSize(features), cdata);
+    const auto values = duckdb::UnifiedVectorFormat::GetData<float>(cdata);
+
+    duckdb::UnifiedVectorFormat ldata;
+    inputs[1].ToUnifiedFormat(count, ldata);
+    const auto labels = duckdb::UnifiedVectorFormat::GetData<float>(ldata);
+
+    duckdb::UnifiedVectorFormat kdata;
+    if (input_count > 2) {
+        inputs[2].ToUnifiedFormat(count, kdata);
+    }
+
+    std::vector<float> row(in_features);
+    for (duckdb::idx_t i = 0; i < count; ++i) {
+        const auto fidx = fdata.sel->get_index(i);
+        const auto lidx = ldata.sel->get_index(i);
+        if (!fdata.validity.RowIsValid(fidx) || !ldata.validity.RowIsValid(lidx)) {
+            continue;
+        }
+        const auto& entry = entries[fidx];
+        if (static_cast<int64_t>(entry.length) != in_features) {
+            throw std::runtime_error(duckdb_fmt::format("train_mlp: model '{}' expects {} features, got {}.",
+                                                        bind.model, in_features, entry.length));
+        }
+        for (int64_t j = 0; j < in_features; ++j) {
+            const auto cidx = cdata.sel->get_index(entry.offset + j);
+            if (!cdata.validity.RowIsValid(cidx)) {
+                throw std::runtime_error("train_mlp: feature lists must not contain NULL values.");
+            }
+            row[j] = values[cidx];
+        }
+
+        auto& state = *states[sdata.sel->get_index(i)];
+        if (!state.trainer) {
+            state.trainer = new IncrementalTrainer(bind.spec, bind.config, bind.options);
+        }
+        if (input_count > 2 && !state.key) {
+            const auto kidx = kdata.sel->get_index(i);
+            if (kdata.validity.RowIsValid(kidx)) {
+                state.key = new std::string(duckdb::UnifiedVectorFormat::GetData<duckdb::string_t>(kdata)[kidx].GetString());
+            }
+        }
+        state.trainer->Add(row.data(), labels[lidx]);
+    }
+}
+
+// 局部状态合并: 目标为空时直接接管源状态, 否则按训练行数加权平均参数
+void TrainMlp::Combine(duckdb::Vector& source, duckdb::Vector& target, duckdb::AggregateInputData&,
+                       duckdb::idx_t count) {
+    auto sources = duckdb::FlatVector::GetData<State*>(source);
+    auto targets = duckdb::FlatVector::GetData<State*>(target);
+    for (duckdb::idx_t i = 0; i < count; ++i) {
+        auto& from = *sources[i];
+        auto& to = *targets[i];
+        if (!to.key) {
+            std::swap(to.key, from.key);
+        }
+        if (!from.trainer) {
+            continue;
+        }
+        if (!to.trainer) {
+            std::swap(to.trainer, from.trainer);
+            continue;
+        }
+        to.trainer->Merge(*from.trainer);
+    }
+}
+
+// 权重暂存到连接的 PendingWeights, 由查询所在事务提交时统一写入
+void TrainMlp::Finalize(duckdb::Vector& state_vector, duckdb::AggregateInputData& aggr_input_data,
+                        duckdb::Vector& result, duckdb::idx_t count, duckdb::idx_t offset) {
+    const auto& bind = aggr_input_data.bind_data->Cast<BindData>();
+    duckdb::UnifiedVectorFormat sdata;
+    state_vector.ToUnifiedFormat(count, sdata);
+    auto states = duckdb::UnifiedVectorFormat::GetData<State*>(sdata);
+    auto results = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+
+    for (duckdb::idx_t i = 0; i < count; ++i) {
+        auto& state = *states[sdata.sel->get_index(i)];
+        if (!state.trainer) {
+            duckdb::FlatVector::SetNull(result, i + offset, true);
+            continue;
+        }
+        auto weights = state.trainer->Weights(bind.model, state.key ? *state.key : "");
+        results[i + offset] = duckdb::StringVector::AddString(result, weights.Summary().dump());
+        bind.pending->Add(std::move(weights));
+    }
+}
+
+void TrainMlp::Destroy(duckdb::Vector& state_vector, duckdb::AggregateInputData&, duckdb::idx_t count) {
+    duckdb::UnifiedVectorFormat sdata;
+    state_vector.ToUnifiedFormat(count, sdata);
+    auto states = duckdb::UnifiedVectorFormat::GetData<State*>(sdata);
+    for (duckdb::idx_t i = 0; i < count; ++i) {
+        auto& state = *states[sdata.sel->get_index(i)];
+        delete state.trainer;
+        delete state.key;
+        state.trainer = nullptr;
+        state.key = nullptr;
+    }
+}
+
+} // namespace regdb
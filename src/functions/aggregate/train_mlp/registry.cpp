@@ -0,0 +1,29 @@
+#include "regdb/functions/aggregate/train_mlp.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void AggregateRegistry::RegisterTrainMlp(duckdb::ExtensionLoader& loader) {
+    duckdb::AggregateFunctionSet set("train_mlp");
+    for (const bool keyed : {false, true}) {
+        duckdb::vector<duckdb::LogicalType> arguments = {
+            duckdb::LogicalType::VARCHAR,                               // model
+            duckdb::LogicalType::LIST(duckdb::LogicalType::FLOAT),      // features
+            duckdb::LogicalType::FLOAT                                  // label
+        };
+        if (keyed) {
+            arguments.push_back(duckdb::LogicalType::VARCHAR);         // 权重表中的 weights_key, 通常为分组列
+        }
+        duckdb::AggregateFunction function(arguments, duckdb::LogicalType::VARCHAR, TrainMlp::StateSize,
+                                           TrainMlp::Initialize, TrainMlp::Update, TrainMlp::Combine,
+                                           TrainMlp::Finalize);
+        function.bind = TrainMlp::Bind;
+        function.destructor = TrainMlp::Destroy;
+        // 训练结果写入权重表, 不能被当作无副作用的表达式优化掉
+        function.stability = duckdb::FunctionStability::VOLATILE;
+        set.AddFunction(function);
+    }
+    loader.RegisterFunction(set);
+}
+
+} // namespace regdb
@@ -0,0 +1,105 @@
+#include "regdb/functions/scalar/partial_fit_model.hpp"
+#include "regdb/core/catalog.hpp"
+#include "regdb/core/engine/incremental.hpp"
+#include "regdb/core/engine/prune.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace regdb {
+
+// 参数校验
+void PartialFitModel::ValidateArguments(duckdb::DataChunk& args) {
+    if (args.ColumnCount() != 3) {
+        throw std::runtime_error("PartialFitModel expects exactly three arguments.");
+    }
+    for (duckdb::idx_t col = 0; col < args.ColumnCount(); ++col) {
+        if (args.data[col].GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
+            throw std::runtime_error(duckdb_fmt::format("Argument {} must be of type VARCHAR.", col));
+        }
+    }
+}
+
+// 逻辑实现: 新增行的上界在开始时固定为当前最大 rowid, 训练期间追加的行留给下一次;
+// 没有保存过权重时从初始化开始训练, 之后每次只写回发生变化的张量
+std::vector<std::string> PartialFitModel::Operation(duckdb::DataChunk& args, duckdb::ClientContext& context) {
+    ValidateArguments(args);
+
+    auto model_name = args.data[0].GetValue(0).ToString();
+    auto table_name = args.data[1].GetValue(0).ToString();
+    auto since = args.data[2].GetValue(0).ToString();
+
+    auto spec = Catalog::GetModelSpec(model_name);
+    ModelWeights previous;
+    const auto exists = Catalog::FindWeights(model_name, "", previous);
+    if (exists && (previous.spec.in_features != spec.in_features || previous.spec.out_features != spec.out_features ||
+                   !IsPrunedFrom(previous.spec, spec))) {
+        throw std::runtime_error(duckdb_fmt::format("Model '{}' changed since its weights were saved; retrain it first.",
+                                                    model_name));
+    }
+
+    // 预处理统计量第一次拟合后随权重保存, 之后的增量训练沿用同样的变换
+    std::unique_ptr<Preprocessor> preprocessor;
+    if (!spec.preprocess.is_null()) {
+        preprocessor = std::make_unique<Preprocessor>(exists && !previous.preprocess.is_null()
+                                                      ? Preprocessor::FromJson(previous.preprocess)
+                                                      : Catalog::FitPreprocessor(table_name, spec));
+    }
+
+    const auto last_rowid = Catalog::MaxRowid(table_name);
+    auto filter = since.empty() ? duckdb_fmt::format("rowid > {}", exists ? previous.last_rowid : -1)
+                                : "(" + since + ")";
+    filter += duckdb_fmt::format(" AND rowid <= {}", last_rowid);
+
+    TrainOptions options;
+    options.max_epochs = EPOCHS;
+    // 每次在不同的种子上打乱新增行
+    options.seed += static_cast<uint64_t>(exists ? previous.last_rowid + 1 : 0);
+    auto trainer = exists ? std::make_unique<IncrementalTrainer>(previous, options)
+                          : std::make_unique<IncrementalTrainer>(spec, RegConfig(), options);
+    const auto new_rows = Catalog::ScanRows(table_name, spec.in_features, preprocessor.get(), filter,
+                                            [&](const float* x, const float* y, int64_t rows) {
+        if (context.interrupted) {
+            throw duckdb::InterruptException();
+        }
+        for (int64_t row = 0; row < rows; ++row) {
+            trainer->Add(x + row * spec.in_features, y[row]);
+        }
+    });
+
+    auto weights = trainer->Weights(model_name, "", true);
+    weights.last_rowid = exists ? std::max(previous.last_rowid, last_rowid) : last_rowid;
+    if (preprocessor) {
+        weights.preprocess = preprocessor->ToJson();
+    }
+    // 量化和块稀疏张量原样带上: 参数没有变化时保留, 变化时由 UpdateWeights 判为过期删除
+    weights.quantized = previous.quantized;
+    weights.sparse = previous.sparse;
+    const auto tensors = static_cast<int64_t>(weights.Tensors().size());
+    int64_t written = tensors;
+    if (exists) {
+        written = Catalog::UpdateWeights(weights, previous);
+    } else {
+        Catalog::SaveWeights({weights});
+    }
+
+    auto json = weights.Summary();
+    json["table"] = table_name;
+    json["filter"] = filter;
+    json["new_rows"] = new_rows;
+    json["tensors"] = tensors;
+    json["tensors_written"] = written;
+    std::vector<std::string> results;
+    results.emplace_back(json.dump());
+    return results;
+}
+
+void PartialFitModel::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
+    const auto responses = PartialFitModel::Operation(args, state.GetContext());
+    duckdb::idx_t pos = 0;
+    for (const auto &res : responses) {
+        result.SetValue(pos++, duckdb::Value(res));
+    }
+}
+
+} // namespace regdb
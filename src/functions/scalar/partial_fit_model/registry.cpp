@@ -0,0 +1,22 @@
+#include "regdb/functions/scalar/partial_fit_model.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void ScalarRegistry::RegisterPartialFitModel(duckdb::ExtensionLoader& loader) {
+    auto function = duckdb::ScalarFunction(
+        "partial_fit_model",
+        {
+            duckdb::LogicalType::VARCHAR,    // model
+            duckdb::LogicalType::VARCHAR,    // training table
+            duckdb::LogicalType::VARCHAR,    // 新增行的过滤条件, 为空时按上次记录的 rowid
+        },
+        duckdb::LogicalType::VARCHAR,
+        PartialFitModel::Execute
+    );
+    // 训练和写回权重都有副作用, 只能在执行阶段运行
+    function.stability = duckdb::FunctionStability::VOLATILE;
+    loader.RegisterFunction(function);
+}
+
+} // namespace regdb
@@ -0,0 +1,111 @@
+#include "regdb/functions/scalar/prune_model.hpp"
+#include "regdb/core/catalog.hpp"
+#include "regdb/core/engine/prune.hpp"
+
+#include <memory>
+#include <random>
+
+namespace regdb {
+
+// 参数校验
+void PruneModel::ValidateArguments(duckdb::DataChunk& args) {
+    if (args.ColumnCount() != 4) {
+        throw std::runtime_error("PruneModel expects exactly four arguments.");
+    }
+    for (duckdb::idx_t col = 0; col < args.ColumnCount(); ++col) {
+        const auto expected = col == 2 ? duckdb::LogicalTypeId::DOUBLE : duckdb::LogicalTypeId::VARCHAR;
+        if (args.data[col].GetType().id() != expected) {
+            throw std::runtime_error(duckdb_fmt::format("Argument {} must be of type {}.", col,
+                                                        col == 2 ? "DOUBLE" : "VARCHAR"));
+        }
+    }
+}
+
+// 逻辑实现: 剪枝只作用于 weights_key 为空的权重; 已有的量化张量随之删除.
+// neuron 改变了参数的形状, 整体重写权重; magnitude 只写回变化的张量和新的块稀疏张量
+std::vector<std::string> PruneModel::Operation(duckdb::DataChunk& args, duckdb::ClientContext& context) {
+    ValidateArguments(args);
+
+    auto model_name = args.data[0].GetValue(0).ToString();
+    auto method = PruneMethodFromString(args.data[1].GetValue(0).ToString());
+    auto sparsity = args.data[2].GetValue(0).GetValue<double>();
+    auto table_name = args.data[3].GetValue(0).ToString();
+
+    const auto previous = Catalog::GetWeights(model_name);
+    std::unique_ptr<Preprocessor> preprocessor;
+    if (!previous.preprocess.is_null()) {
+        preprocessor = std::make_unique<Preprocessor>(Preprocessor::FromJson(previous.preprocess));
+    }
+    const auto in_features = previous.spec.in_features;
+    const auto sample = duckdb_fmt::format("(SELECT * FROM {} USING SAMPLE reservoir({} ROWS) REPEATABLE (42)) AS sample",
+                                           table_name, SAMPLE_ROWS);
+    std::vector<float> x;
+    std::vector<float> y;
+    const auto rows = Catalog::ScanRows(sample, in_features, preprocessor.get(), "",
+                                        [&](const float* chunk_x, const float* chunk_y, int64_t chunk_rows) {
+        if (context.interrupted) {
+            throw duckdb::InterruptException();
+        }
+        x.insert(x.end(), chunk_x, chunk_x + chunk_rows * in_features);
+        y.insert(y.end(), chunk_y, chunk_y + chunk_rows);
+    });
+
+    Mlp model(previous.spec, previous.config, 0);
+    previous.Restore(model);
+    auto weights = method == PruneMethod::NEURON ? PruneNeurons(previous, sparsity) : PruneBlocks(previous, sparsity);
+    Mlp pruned(weights.spec, weights.config, 0);
+    weights.Restore(pruned);
+
+    auto json = weights.Summary();
+    json["method"] = PruneMethodToString(method);
+    json["sparsity"] = sparsity;
+    json["table"] = table_name;
+    json["evaluation_rows"] = rows;
+    CompressionReport report;
+    if (method == PruneMethod::NEURON) {
+        MlpWorkspace ws;
+        std::mt19937 unused;
+        int64_t bytes = 0;
+        for (const auto& layer : pruned.Layers()) {
+            bytes += layer.in * layer.out * static_cast<int64_t>(sizeof(float));
+        }
+        report = CompareCompressed(model, [&](const float* batch, int64_t count) {
+            pruned.Forward(batch, count, false, ws, unused);
+            return static_cast<const float*>(ws.logits.data());
+        }, bytes, x.data(), y.data(), rows);
+        json["hidden_features_before"] = previous.spec.hidden_features;
+        json["hidden_features"] = weights.spec.hidden_features;
+        Catalog::SaveWeights({weights});
+        json["tensors_written"] = weights.Tensors().size();
+    } else {
+        SparseMlp sparse(pruned);
+        SparseWorkspace ws;
+        report = CompareCompressed(model, [&](const float* batch, int64_t count) {
+            return sparse.Forward(batch, count, ws);
+        }, sparse.WeightBytes(), x.data(), y.data(), rows);
+        json["density"] = sparse.Density();
+        weights.sparse = sparse.Tensors();
+        json["tensors_written"] = Catalog::UpdateWeights(weights, previous);
+    }
+    json["fp32_loss"] = report.fp32_loss;
+    json["pruned_loss"] = report.compressed_loss;
+    json[weights.spec.out_features == 1 ? "mean_abs_diff" : "argmax_mismatch"] = report.prediction_delta;
+    json["fp32_rows_per_second"] = report.fp32_rows_per_second;
+    json["pruned_rows_per_second"] = report.compressed_rows_per_second;
+    json["speedup"] = report.Speedup();
+    json["fp32_weight_bytes"] = report.fp32_bytes;
+    json["pruned_weight_bytes"] = report.compressed_bytes;
+    std::vector<std::string> results;
+    results.emplace_back(json.dump());
+    return results;
+}
+
+void PruneModel::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
+    const auto responses = PruneModel::Operation(args, state.GetContext());
+    duckdb::idx_t pos = 0;
+    for (const auto &res : responses) {
+        result.SetValue(pos++, duckdb::Value(res));
+    }
+}
+
+} // namespace regdb
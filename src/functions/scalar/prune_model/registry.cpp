@@ -0,0 +1,23 @@
+#include "regdb/functions/scalar/prune_model.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void ScalarRegistry::RegisterPruneModel(duckdb::ExtensionLoader& loader) {
+    auto function = duckdb::ScalarFunction(
+        "prune_model",
+        {
+            duckdb::LogicalType::VARCHAR,    // model
+            duckdb::LogicalType::VARCHAR,    // 方法: magnitude / neuron
+            duckdb::LogicalType::DOUBLE,     // 剪掉的比例, [0, 1)
+            duckdb::LogicalType::VARCHAR,    // 用于对比的训练表
+        },
+        duckdb::LogicalType::VARCHAR,
+        PruneModel::Execute
+    );
+    // 写回权重有副作用, 只能在执行阶段运行
+    function.stability = duckdb::FunctionStability::VOLATILE;
+    loader.RegisterFunction(function);
+}
+
+} // namespace regdb
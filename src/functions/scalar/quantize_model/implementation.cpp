@@ -0,0 +1,107 @@
+#include "regdb/functions/scalar/quantize_model.hpp"
+#include "regdb/core/catalog.hpp"
+#include "regdb/core/engine/kernels.hpp"
+#include "regdb/core/engine/quantize.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace regdb {
+
+// 参数校验
+void QuantizeModel::ValidateArguments(duckdb::DataChunk& args) {
+    if (args.ColumnCount() != 3) {
+        throw std::runtime_error("QuantizeModel expects exactly three arguments.");
+    }
+    for (duckdb::idx_t col = 0; col < args.ColumnCount(); ++col) {
+        if (args.data[col].GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
+            throw std::runtime_error(duckdb_fmt::format("Argument {} must be of type VARCHAR.", col));
+        }
+    }
+}
+
+// 逻辑实现: 固定种子的蓄水池样本, 前一半校准激活尺度, 后一半对比 fp32 与量化推理;
+// 只写回量化张量, fp32 参数保持不变, 所以随时可以换回 fp32
+std::vector<std::string> QuantizeModel::Operation(duckdb::DataChunk& args, duckdb::ClientContext& context) {
+    ValidateArguments(args);
+
+    auto model_name = args.data[0].GetValue(0).ToString();
+    auto precision = PrecisionFromString(args.data[1].GetValue(0).ToString());
+    auto table_name = args.data[2].GetValue(0).ToString();
+
+    const auto previous = Catalog::GetWeights(model_name);
+    // 量化与块稀疏推理二选一, 量化之后剪枝的块仍为 0, 按稠密的量化内核计算
+    auto weights = previous;
+    weights.quantized.clear();
+    weights.sparse.clear();
+    auto json = weights.Summary();
+    json["precision"] = PrecisionToString(precision);
+    if (precision == Precision::FP32) {
+        json["tensors_written"] = Catalog::UpdateWeights(weights, previous);
+        std::vector<std::string> results;
+        results.emplace_back(json.dump());
+        return results;
+    }
+
+    std::unique_ptr<Preprocessor> preprocessor;
+    if (!weights.preprocess.is_null()) {
+        preprocessor = std::make_unique<Preprocessor>(Preprocessor::FromJson(weights.preprocess));
+    }
+    const auto in_features = weights.spec.in_features;
+    const auto sample = duckdb_fmt::format("(SELECT * FROM {} USING SAMPLE reservoir({} ROWS) REPEATABLE (42)) AS calibration",
+                                           table_name, SAMPLE_ROWS);
+    std::vector<float> x;
+    std::vector<float> y;
+    const auto rows = Catalog::ScanRows(sample, in_features, preprocessor.get(), "",
+                                        [&](const float* chunk_x, const float* chunk_y, int64_t chunk_rows) {
+        if (context.interrupted) {
+            throw duckdb::InterruptException();
+        }
+        x.insert(x.end(), chunk_x, chunk_x + chunk_rows * in_features);
+        y.insert(y.end(), chunk_y, chunk_y + chunk_rows);
+    });
+    if (rows < 2) {
+        throw std::runtime_error(duckdb_fmt::format("Table '{}' needs at least two rows to calibrate model '{}'.",
+                                                    table_name, model_name));
+    }
+
+    // 样本少时两半至少各有一行
+    const auto calibration_rows = rows / 2;
+    Mlp model(weights.spec, weights.config, 0);
+    weights.Restore(model);
+    QuantizedMlp quantized(model, precision, x.data(), calibration_rows);
+    QuantizedWorkspace ws;
+    const auto report = CompareCompressed(model, [&](const float* batch, int64_t count) {
+        return quantized.Forward(batch, count, ws);
+    }, quantized.WeightBytes(), x.data() + calibration_rows * in_features, y.data() + calibration_rows,
+       rows - calibration_rows);
+    weights.quantized = quantized.Tensors();
+    const auto written = Catalog::UpdateWeights(weights, previous);
+
+    json["isa"] = kernels::QuantizedKernelIsa();
+    json["table"] = table_name;
+    json["calibration_rows"] = calibration_rows;
+    json["evaluation_rows"] = rows - calibration_rows;
+    json["fp32_loss"] = report.fp32_loss;
+    json["quantized_loss"] = report.compressed_loss;
+    json[weights.spec.out_features == 1 ? "mean_abs_diff" : "argmax_mismatch"] = report.prediction_delta;
+    json["fp32_rows_per_second"] = report.fp32_rows_per_second;
+    json["quantized_rows_per_second"] = report.compressed_rows_per_second;
+    json["speedup"] = report.Speedup();
+    json["fp32_weight_bytes"] = report.fp32_bytes;
+    json["quantized_weight_bytes"] = report.compressed_bytes;
+    json["tensors_written"] = written;
+    std::vector<std::string> results;
+    results.emplace_back(json.dump());
+    return results;
+}
+
+void QuantizeModel::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
+    const auto responses = QuantizeModel::Operation(args, state.GetContext());
+    duckdb::idx_t pos = 0;
+    for (const auto &res : responses) {
+        result.SetValue(pos++, duckdb::Value(res));
+    }
+}
+
+} // namespace regdb
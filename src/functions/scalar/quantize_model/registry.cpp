@@ -0,0 +1,22 @@
+#include "regdb/functions/scalar/quantize_model.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void ScalarRegistry::RegisterQuantizeModel(duckdb::ExtensionLoader& loader) {
+    auto function = duckdb::ScalarFunction(
+        "quantize_model",
+        {
+            duckdb::LogicalType::VARCHAR,    // model
+            duckdb::LogicalType::VARCHAR,    // 精度: fp32 / bf16 / int8, fp32 删除已有的量化张量
+            duckdb::LogicalType::VARCHAR,    // 校准用的训练表
+        },
+        duckdb::LogicalType::VARCHAR,
+        QuantizeModel::Execute
+    );
+    // 写回权重有副作用, 只能在执行阶段运行
+    function.stability = duckdb::FunctionStability::VOLATILE;
+    loader.RegisterFunction(function);
+}
+
+} // namespace regdb
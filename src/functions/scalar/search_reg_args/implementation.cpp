@@ -1,44 +1,116 @@
 #include "regdb/functions/scalar/search_reg_args.hpp"
+#include "regdb/core/catalog.hpp"
+#include "regdb/core/config.hpp"
+#include "regdb/core/engine/cache.hpp"
+#include "regdb/core/engine/deadline.hpp"
+#include "regdb/core/engine/model_type.hpp"
+#include "regdb/core/search/search.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+#include <functional>
 
 namespace regdb {
 
 // 参数校验
 void SearchRegArgs::ValidateArguments(duckdb::DataChunk& args) {
-    if (args.ColumnCount() != 3) {
-        throw std::runtime_error("SearchRegArgs expects exactly three arguments.");
-    }
-    if (args.data[0].GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
-        throw std::runtime_error("Argument 0 must be of type VARCHAR.");
+    if (args.ColumnCount() != 4 && args.ColumnCount() != 5) {
+        throw std::runtime_error("SearchRegArgs expects four arguments and an optional options string.");
     }
-    if (args.data[1].GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
-        throw std::runtime_error("Argument 1 must be of type VARCHAR.");
-    }
-    if (args.data[2].GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
-        throw std::runtime_error("Argument 2 must be of type VARCHAR.");
+    for (duckdb::idx_t col = 0; col < args.ColumnCount(); ++col) {
+        if (args.data[col].GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
+            throw std::runtime_error(duckdb_fmt::format("Argument {} must be of type VARCHAR.", col));
+        }
     }
 }
 
 // 逻辑实现
-std::vector<std::string> SearchRegArgs::Operation(duckdb::DataChunk& args) {
+std::vector<std::string> SearchRegArgs::Operation(duckdb::DataChunk& args, duckdb::ClientContext& context) {
     ValidateArguments(args);
 
-    // 取第一行的三个参数
-    auto v1 = args.data[0].GetValue(0).ToString();
-    auto v2 = args.data[1].GetValue(0).ToString();
-    auto v3 = args.data[2].GetValue(0).ToString();
+    // 取第一行的四个参数
+    auto model_name = args.data[0].GetValue(0).ToString();
+    auto reg_space = args.data[1].GetValue(0).ToString();
+    auto time_threshold = args.data[2].GetValue(0).ToString();
+    auto table_name = args.data[3].GetValue(0).ToString();
+    // 第五个参数为选项, 目前只有 RESUME: 复用上一次同一搜索已完成的 trial, 未完成的从检查点继续
+    bool resume = false;
+    if (args.ColumnCount() == 5) {
+        const auto option = duckdb::StringUtil::Upper(args.data[4].GetValue(0).ToString());
+        if (option == "RESUME") {
+            resume = true;
+        } else if (!option.empty()) {
+            throw std::runtime_error(duckdb_fmt::format("Unknown search option '{}'.", option));
+        }
+    }
+
+    // 时间预算从解析参数开始计算, 读取数据也计入预算
+    Deadline deadline(ParseTimeThreshold(time_threshold));
+    StopToken token(deadline, &context.interrupted);
+
+    auto spec = Catalog::GetModelSpec(model_name);
+    auto reg_args = Catalog::GetRegArgs(reg_space);
+    auto space = RegSpace::FromJson(reg_args);
+    // 由结构决定的开关 (如 RESNET_MLP 的 use_skip) 不参与搜索, 避免重复的 trial
+    for (const auto& flag : ModelTypeRegistry::Instance().Get(spec.model_type).FixedRegFlags()) {
+        space.Fix(flag.first, flag.second);
+    }
+
+    SearchOptions options;
+    options.max_threads = Config::ConfigureThreads(context);
+    options.folds = spec.folds;
+    options.train.early_stop = spec.early_stopping;
+    options.stack_size = RegSearch::AutoStackSize(spec, static_cast<int64_t>(space.Enumerate().size()) * spec.folds,
+                                                  options.max_threads);
+    // 检查点按模型、正则化空间和表的内容区分, 表追加或删除行之后不会续跑旧的搜索
+    const auto fingerprint = duckdb_fmt::format("{}|{}|{}|{}|{}", model_name, spec.ToJson().dump(),
+                                                reg_args.dump(), table_name,
+                                                Catalog::TableVersion(table_name));
+    options.checkpoint_dir = (Config::get_checkpoint_path() /
+                              duckdb_fmt::format("search-{:016x}", std::hash<std::string>()(fingerprint))).string();
+    options.resume = resume;
+
+    // 预处理统计量在训练前拟合一次, 随搜索结果返回, 预测时按同样的变换处理输入
+    std::unique_ptr<Preprocessor> preprocessor;
+    if (!spec.preprocess.is_null()) {
+        preprocessor = std::make_unique<Preprocessor>(Catalog::FitPreprocessor(table_name, spec));
+    }
 
+    // float32 数据超过 memory_limit 的一半时不整体载入, 按块流式读取
+    const auto rows = Catalog::CountRows(table_name);
+    const auto data_bytes = rows * (spec.in_features + 1) * static_cast<int64_t>(sizeof(float));
+    const auto memory_limit = static_cast<int64_t>(duckdb::BufferManager::GetBufferManager(context).GetMaxMemory());
+    SearchResult search_result;
+    if (data_bytes > memory_limit / 2) {
+        auto source = Catalog::OpenTable(table_name, spec.in_features, preprocessor.get());
+        search_result = RegSearch(spec, space, *source, options).Run(token);
+    } else {
+        // 缓存的矩阵由所有 trial 和后续搜索共享, 缓存总量不超过 memory_limit 的一半
+        DatasetCache::Instance().SetCapacity(memory_limit / 2);
+        auto data = Catalog::GetDataset(table_name, spec.in_features, preprocessor.get());
+        search_result = RegSearch(spec, space, *data, options).Run(token);
+    }
+    if (search_result.stop_reason == StopReason::INTERRUPTED) {
+        throw duckdb::InterruptException();
+    }
+
+    auto json = search_result.ToJson();
+    json["model"] = model_name;
+    json["reg_space"] = reg_space;
+    if (preprocessor) {
+        json["preprocess"] = preprocessor->ToJson();
+    }
     std::vector<std::string> results;
-    results.emplace_back(v1 + "_" + v2 + "_" + v3);
+    results.emplace_back(json.dump());
     return results;
 }
 
 void SearchRegArgs::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
     // valid -> operation
-    const auto responses = SearchRegArgs::Operation(args);
+    const auto responses = SearchRegArgs::Operation(args, state.GetContext());
     duckdb::idx_t pos = 0;
     for (const auto &res : responses) {
         result.SetValue(pos++, duckdb::Value(res));
     }
 }
 
-} // namespace regdb
\ No newline at end of file
+} // namespace regdb
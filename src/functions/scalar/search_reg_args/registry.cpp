@@ -4,18 +4,24 @@
 namespace regdb {
 
 void ScalarRegistry::RegisterSearchRegArgs(duckdb::ExtensionLoader& loader) {
-    loader.RegisterFunction(
-        duckdb::ScalarFunction(
-            "search_reg_args",
-            {
-                duckdb::LogicalType::VARCHAR,    // model
-                duckdb::LogicalType::VARCHAR,    // regspace
-                duckdb::LogicalType::VARCHAR,    // time threshold  120s/5m/1h
-            },
-            duckdb::LogicalType::VARCHAR,
-            SearchRegArgs::Execute
-        )
+    duckdb::ScalarFunctionSet set("search_reg_args");
+    auto function = duckdb::ScalarFunction(
+        {
+            duckdb::LogicalType::VARCHAR,    // model
+            duckdb::LogicalType::VARCHAR,    // regspace
+            duckdb::LogicalType::VARCHAR,    // time threshold  120s/5m/1h
+            duckdb::LogicalType::VARCHAR,    // training table
+        },
+        duckdb::LogicalType::VARCHAR,
+        SearchRegArgs::Execute
     );
+    // 搜索需要在执行阶段运行, 避免被常量折叠提前到优化阶段, 从而可以响应中断
+    function.stability = duckdb::FunctionStability::VOLATILE;
+    set.AddFunction(function);
+    // 带选项的重载: 'RESUME' 从上一次被打断的同一搜索继续
+    function.arguments.push_back(duckdb::LogicalType::VARCHAR);
+    set.AddFunction(function);
+    loader.RegisterFunction(set);
 }
 
 } // namespace regdb
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "regdb/functions/table/benchmark.hpp"
+#include "regdb/core/catalog.hpp"
+#include "regdb/core/config.hpp"
+
+namespace regdb {
+
+duckdb::unique_ptr<duckdb::FunctionData> RegdbBenchmark::Bind(duckdb::ClientContext& context,
+                                                              duckdb::TableFunctionBindInput& input,
+                                                              duckdb::vector<duckdb::LogicalType>& return_types,
+                                                              duckdb::vector<std::string>& names) {
+    auto data = duckdb::make_uniq<BindData>();
+    data->name = input.inputs[0].ToString();
+    data->model = input.inputs.size() > 1 ? input.inputs[1].ToString() : "default";
+
+    names = {"benchmark", "variant", "threads", "value", "unit"};
+    return_types = {
+        duckdb::LogicalType::VARCHAR,
+        duckdb::LogicalType::VARCHAR,
+        duckdb::LogicalType::BIGINT,
+        duckdb::LogicalType::DOUBLE,
+        duckdb::LogicalType::VARCHAR
+    };
+    return std::move(data);
+}
+
+duckdb::unique_ptr<duckdb::GlobalTableFunctionState> RegdbBenchmark::Init(duckdb::ClientContext& context,
+                                                                          duckdb::TableFunctionInitInput& input) {
+    auto state = duckdb::make_uniq<State>();
+    const auto& data = input.bind_data->Cast<BindData>();
+    state->rows = Operation(data.name, data.model, Config::ConfigureThreads(context));
+    return std::move(state);
+}
+
+// 逻辑实现
+std::vector<BenchmarkRow> RegdbBenchmark::Operation(const std::string& name, const std::string& model,
+                                                    int64_t threads) {
+    auto spec = Catalog::GetModelSpec(model);
+    // 线程数从 1 翻倍到 64, 不超过 DuckDB 的 threads 设置
+    std::vector<int64_t> sweep;
+    for (int64_t count = 1; count <= std::min<int64_t>(64, threads); count *= 2) {
+        sweep.push_back(count);
+    }
+    if (name == "data_parallel") {
+        return Benchmark::DataParallel(spec, sweep);
+    }
+    if (name == "hogwild") {
+        return Benchmark::Hogwild(spec, sweep);
+    }
+    if (name == "arena") {
+        return Benchmark::ArenaAllocations(spec);
+    }
+    if (name == "layer_width") {
+        return Benchmark::LayerWidths(spec);
+    }
+    throw std::runtime_error(duckdb_fmt::format("Unknown benchmark '{}'.", name));
+}
+
+void RegdbBenchmark::Execute(duckdb::ClientContext& context, duckdb::TableFunctionInput& input,
+                             duckdb::DataChunk& output) {
+    auto& state = input.global_state->Cast<State>();
+    duckdb::idx_t count = 0;
+    while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+        const auto& row = state.rows[state.offset++];
+        output.SetValue(0, count, duckdb::Value(row.benchmark));
+        output.SetValue(1, count, duckdb::Value(row.variant));
+        output.SetValue(2, count, duckdb::Value::BIGINT(row.threads));
+        output.SetValue(3, count, duckdb::Value::DOUBLE(row.value));
+        output.SetValue(4, count, duckdb::Value(row.unit));
+        ++count;
+    }
+    output.SetCardinality(count);
+}
+
+} // namespace regdb
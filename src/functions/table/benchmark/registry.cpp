@@ -0,0 +1,18 @@
+#include "regdb/functions/table/benchmark.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void TableRegistry::RegisterBenchmark(duckdb::ExtensionLoader& loader) {
+    duckdb::TableFunctionSet set("regdb_benchmark");
+    // regdb_benchmark(name), 使用 default 模型
+    set.AddFunction(duckdb::TableFunction(
+        {duckdb::LogicalType::VARCHAR}, RegdbBenchmark::Execute, RegdbBenchmark::Bind, RegdbBenchmark::Init));
+    // regdb_benchmark(name, model)
+    set.AddFunction(duckdb::TableFunction(
+        {duckdb::LogicalType::VARCHAR, duckdb::LogicalType::VARCHAR},
+        RegdbBenchmark::Execute, RegdbBenchmark::Bind, RegdbBenchmark::Init));
+    loader.RegisterFunction(set);
+}
+
+} // namespace regdb
@@ -0,0 +1,64 @@
+#include "regdb/functions/table/memory.hpp"
+#include "regdb/core/engine/arena.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+namespace regdb {
+
+duckdb::unique_ptr<duckdb::FunctionData> RegdbMemory::Bind(duckdb::ClientContext& context,
+                                                           duckdb::TableFunctionBindInput& input,
+                                                           duckdb::vector<duckdb::LogicalType>& return_types,
+                                                           duckdb::vector<std::string>& names) {
+    names = {"category", "bytes", "peak_bytes", "blocks"};
+    return_types = {
+        duckdb::LogicalType::VARCHAR,
+        duckdb::LogicalType::BIGINT,
+        duckdb::LogicalType::BIGINT,
+        duckdb::LogicalType::BIGINT
+    };
+    return duckdb::make_uniq<duckdb::TableFunctionData>();
+}
+
+duckdb::unique_ptr<duckdb::GlobalTableFunctionState> RegdbMemory::Init(duckdb::ClientContext& context,
+                                                                       duckdb::TableFunctionInitInput& input) {
+    auto state = duckdb::make_uniq<State>();
+    state->rows = Operation(context);
+    return std::move(state);
+}
+
+// 逻辑实现
+std::vector<RegdbMemory::Row> RegdbMemory::Operation(duckdb::ClientContext& context) {
+    std::vector<Row> rows;
+    int64_t total = 0;
+    int64_t blocks = 0;
+    for (const auto& usage : Memory::Report()) {
+        rows.push_back({MemoryCategoryToString(usage.category), usage.bytes, usage.peak_bytes, usage.blocks});
+        total += usage.bytes;
+        blocks += usage.blocks;
+    }
+    rows.push_back({"total", total, total, blocks});
+
+    // DuckDB 侧的视角: 全部已用内存和 memory_limit, regdb 的块以 MemoryTag::EXTENSION 计入其中
+    auto& buffer_manager = duckdb::BufferManager::GetBufferManager(context);
+    const auto used = static_cast<int64_t>(buffer_manager.GetUsedMemory());
+    const auto limit = static_cast<int64_t>(buffer_manager.GetMaxMemory());
+    rows.push_back({"duckdb_used", used, used, 0});
+    rows.push_back({"duckdb_limit", limit, limit, 0});
+    return rows;
+}
+
+void RegdbMemory::Execute(duckdb::ClientContext& context, duckdb::TableFunctionInput& input,
+                          duckdb::DataChunk& output) {
+    auto& state = input.global_state->Cast<State>();
+    duckdb::idx_t count = 0;
+    while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+        const auto& row = state.rows[state.offset++];
+        output.SetValue(0, count, duckdb::Value(row.category));
+        output.SetValue(1, count, duckdb::Value::BIGINT(row.bytes));
+        output.SetValue(2, count, duckdb::Value::BIGINT(row.peak_bytes));
+        output.SetValue(3, count, duckdb::Value::BIGINT(row.blocks));
+        ++count;
+    }
+    output.SetCardinality(count);
+}
+
+} // namespace regdb
@@ -0,0 +1,12 @@
+#include "regdb/functions/table/memory.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void TableRegistry::RegisterMemory(duckdb::ExtensionLoader& loader) {
+    loader.RegisterFunction(
+        duckdb::TableFunction("regdb_memory", {}, RegdbMemory::Execute, RegdbMemory::Bind, RegdbMemory::Init)
+    );
+}
+
+} // namespace regdb
@@ -0,0 +1,211 @@
+#include "regdb/functions/table/predict.hpp"
+#include "regdb/core/catalog.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/execution/execution_context.hpp"
+
+#include <algorithm>
+
+namespace regdb {
+
+duckdb::unique_ptr<duckdb::FunctionData> RegdbPredict::Bind(duckdb::ClientContext& context,
+                                                            duckdb::TableFunctionBindInput& input,
+                                                            duckdb::vector<duckdb::LogicalType>& return_types,
+                                                            duckdb::vector<std::string>& names) {
+    auto data = duckdb::make_uniq<BindData>();
+    std::vector<std::string> models;
+    if (input.inputs[0].type().id() == duckdb::LogicalTypeId::LIST) {
+        for (const auto& value : duckdb::ListValue::GetChildren(input.inputs[0])) {
+            if (std::find(models.begin(), models.end(), value.ToString()) != models.end()) {
+                throw std::runtime_error(duckdb_fmt::format("Model '{}' appears more than once in the ensemble.",
+                                                            value.ToString()));
+            }
+            models.push_back(value.ToString());
+        }
+        if (models.empty()) {
+            throw std::runtime_error("regdb_predict needs at least one model.");
+        }
+    } else {
+        models.push_back(input.inputs[0].ToString());
+    }
+    data->model = duckdb::StringUtil::Join(models, ", ");
+    // 权重只在这里读取一次, 执行期间不再访问目录表
+    std::vector<ModelWeights> members;
+    for (const auto& model : models) {
+        members.push_back(Catalog::GetWeights(model));
+        if (members.back().preprocess != members[0].preprocess) {
+            throw std::runtime_error(duckdb_fmt::format("Models '{}' and '{}' use different preprocessing.",
+                                                        models[0], model));
+        }
+    }
+    const auto& weights = members[0];
+    data->predictor = std::make_shared<const Predictor>(members);
+
+    const auto& columns = input.input_table_names;
+    if (!weights.preprocess.is_null()) {
+        data->preprocessor = std::make_shared<const Preprocessor>(Preprocessor::FromJson(weights.preprocess));
+        for (const auto& column : data->preprocessor->Columns()) {
+            duckdb::idx_t index = 0;
+            while (index < columns.size() && !duckdb::StringUtil::CIEquals(columns[index], column.name)) {
+                ++index;
+            }
+            if (index == columns.size()) {
+                throw std::runtime_error(duckdb_fmt::format("Model '{}' needs input column '{}'.", data->model,
+                                                            column.name));
+            }
+            data->features.push_back(index);
+        }
+    } else {
+        const auto in_features = data->predictor->InFeatures();
+        if (static_cast<int64_t>(columns.size()) < in_features) {
+            throw std::runtime_error(duckdb_fmt::format("Model '{}' needs {} feature columns, the input has {}.",
+                                                        data->model, in_features, columns.size()));
+        }
+        for (int64_t col = 0; col < in_features; ++col) {
+            data->features.push_back(static_cast<duckdb::idx_t>(col));
+        }
+    }
+
+    names = columns;
+    return_types = input.input_table_types;
+    names.push_back("prediction");
+    return_types.push_back(data->predictor->IsRegression() ? duckdb::LogicalType::FLOAT
+                                                           : duckdb::LogicalType::BIGINT);
+    return std::move(data);
+}
+
+duckdb::unique_ptr<duckdb::LocalTableFunctionState> RegdbPredict::InitLocal(duckdb::ExecutionContext& context,
+                                                                            duckdb::TableFunctionInitInput& input,
+                                                                            duckdb::GlobalTableFunctionState* global) {
+    const auto& data = input.bind_data->Cast<BindData>();
+    auto state = duckdb::make_uniq<LocalState>();
+    const auto capacity = Predictor::BATCH_ROWS + static_cast<int64_t>(STANDARD_VECTOR_SIZE);
+    state->x.reserve(capacity * data.predictor->InFeatures());
+    state->predictions.reserve(capacity);
+    return std::move(state);
+}
+
+void RegdbPredict::Absorb(duckdb::ClientContext& context, const BindData& bind, LocalState& state,
+                          duckdb::DataChunk& input) {
+    const auto rows = static_cast<int64_t>(input.size());
+    auto chunk = duckdb::make_uniq<duckdb::DataChunk>();
+    chunk->Initialize(duckdb::Allocator::Get(context), input.GetTypes(), input.size());
+    input.Copy(*chunk);
+
+    const auto in_features = bind.predictor->InFeatures();
+    state.x.resize((state.rows + rows) * in_features);
+    float* x = state.x.data() + state.rows * in_features;
+    std::vector<uint8_t> valid(rows);
+    std::vector<std::string_view> strings(rows);
+    for (size_t col = 0; col < bind.features.size(); ++col) {
+        auto& source = chunk->data[bind.features[col]];
+        const bool categorical = bind.preprocessor && !bind.preprocessor->Columns()[col].Numeric();
+        duckdb::Vector vector(categorical ? duckdb::LogicalType::VARCHAR : duckdb::LogicalType::FLOAT, input.size());
+        duckdb::VectorOperations::Cast(context, source, vector, input.size());
+        vector.Flatten(input.size());
+        auto& validity = duckdb::FlatVector::Validity(vector);
+
+        if (!bind.preprocessor) {
+            const auto values = duckdb::FlatVector::GetData<float>(vector);
+            for (int64_t row = 0; row < rows; ++row) {
+                if (!validity.RowIsValid(row)) {
+                    throw std::runtime_error(duckdb_fmt::format("Input of model '{}' contains NULL features.",
+                                                                bind.model));
+                }
+                x[row * in_features + col] = values[row];
+            }
+            continue;
+        }
+        if (col == 0) {
+            std::fill(x, x + rows * in_features, 0.0f);
+        }
+        const uint8_t* mask = nullptr;
+        if (!validity.AllValid()) {
+            for (int64_t row = 0; row < rows; ++row) {
+                valid[row] = validity.RowIsValid(row);
+            }
+            mask = valid.data();
+        }
+        if (!categorical) {
+            bind.preprocessor->TransformNumeric(col, duckdb::FlatVector::GetData<float>(vector), mask, rows, x);
+            continue;
+        }
+        const auto values = duckdb::FlatVector::GetData<duckdb::string_t>(vector);
+        for (int64_t row = 0; row < rows; ++row) {
+            strings[row] = std::string_view(values[row].GetData(), values[row].GetSize());
+        }
+        bind.preprocessor->TransformCategorical(col, strings.data(), mask, rows, x);
+    }
+    state.rows += rows;
+    state.chunks.push_back(std::move(chunk));
+}
+
+bool RegdbPredict::Emit(const BindData& bind, LocalState& state, duckdb::DataChunk& output) {
+    if (!state.scored) {
+        state.predictions.resize(state.rows);
+        bind.predictor->Predict(state.x.data(), state.rows, state.ws, state.predictions.data());
+        state.scored = true;
+    }
+    int64_t offset = 0;
+    for (duckdb::idx_t i = 0; i < state.emitted; ++i) {
+        offset += static_cast<int64_t>(state.chunks[i]->size());
+    }
+    auto& chunk = *state.chunks[state.emitted++];
+    const auto count = chunk.size();
+    for (duckdb::idx_t col = 0; col < chunk.ColumnCount(); ++col) {
+        output.data[col].Reference(chunk.data[col]);
+    }
+    auto& prediction = output.data[chunk.ColumnCount()];
+    const float* values = state.predictions.data() + offset;
+    if (bind.predictor->IsRegression()) {
+        std::copy(values, values + count, duckdb::FlatVector::GetData<float>(prediction));
+    } else {
+        auto classes = duckdb::FlatVector::GetData<int64_t>(prediction);
+        for (duckdb::idx_t row = 0; row < count; ++row) {
+            classes[row] = static_cast<int64_t>(values[row]);
+        }
+    }
+    output.SetCardinality(count);
+
+    if (state.emitted < state.chunks.size()) {
+        return true;
+    }
+    // 输出向量引用的是 chunk 的缓冲区, 释放 chunk 不影响已输出的结果
+    state.chunks.clear();
+    state.x.clear();
+    state.rows = 0;
+    state.emitted = 0;
+    state.scored = false;
+    return false;
+}
+
+// 积攒到 BATCH_ROWS 行后打分, 之后每次调用输出一个输入 chunk; 有剩余输出时不接收新的输入
+duckdb::OperatorResultType RegdbPredict::Execute(duckdb::ExecutionContext& context, duckdb::TableFunctionInput& data,
+                                                 duckdb::DataChunk& input, duckdb::DataChunk& output) {
+    const auto& bind = data.bind_data->Cast<BindData>();
+    auto& state = data.local_state->Cast<LocalState>();
+    if (!state.scored) {
+        if (input.size() > 0) {
+            Absorb(context.client, bind, state, input);
+        }
+        if (state.rows < Predictor::BATCH_ROWS) {
+            return duckdb::OperatorResultType::NEED_MORE_INPUT;
+        }
+    }
+    return Emit(bind, state, output) ? duckdb::OperatorResultType::HAVE_MORE_OUTPUT
+                                     : duckdb::OperatorResultType::NEED_MORE_INPUT;
+}
+
+// 输入结束时为不足一批的剩余行打分
+duckdb::OperatorFinalizeResultType RegdbPredict::Finalize(duckdb::ExecutionContext& context,
+                                                          duckdb::TableFunctionInput& data,
+                                                          duckdb::DataChunk& output) {
+    const auto& bind = data.bind_data->Cast<BindData>();
+    auto& state = data.local_state->Cast<LocalState>();
+    if (state.chunks.empty()) {
+        return duckdb::OperatorFinalizeResultType::FINISHED;
+    }
+    return Emit(bind, state, output) ? duckdb::OperatorFinalizeResultType::HAVE_MORE_OUTPUT
+                                     : duckdb::OperatorFinalizeResultType::FINISHED;
+}
+
+} // namespace regdb
@@ -0,0 +1,20 @@
+#include "regdb/functions/table/predict.hpp"
+#include "regdb/registry/registry.hpp"
+
+namespace regdb {
+
+void TableRegistry::RegisterPredict(duckdb::ExtensionLoader& loader) {
+    duckdb::TableFunctionSet set("regdb_predict");
+    // regdb_predict((query), model) 与集成 regdb_predict((query), [model, ...]), 第一个参数为子查询,
+    // 规划为 PhysicalTableInOutFunction 随输入管道并行执行
+    for (const auto& models : {duckdb::LogicalType::VARCHAR, duckdb::LogicalType::LIST(duckdb::LogicalType::VARCHAR)}) {
+        duckdb::TableFunction function({duckdb::LogicalType::TABLE, models}, nullptr, RegdbPredict::Bind, nullptr,
+                                       RegdbPredict::InitLocal);
+        function.in_out_function = RegdbPredict::Execute;
+        function.in_out_function_final = RegdbPredict::Finalize;
+        set.AddFunction(function);
+    }
+    loader.RegisterFunction(set);
+}
+
+} // namespace regdb
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/core/engine/dataset.hpp"
+#include "regdb/core/engine/memory.hpp"
+#include "regdb/core/engine/preprocess.hpp"
+#include "regdb/core/engine/spec.hpp"
+#include "regdb/core/engine/stream.hpp"
+#include "regdb/core/engine/weights.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+// 从配置表与用户表读取训练所需的信息, 先查本地再查全局存储
+class Catalog {
+public:
+	static ModelSpec GetModelSpec(const std::string& model_name);							// 读取模型结构
+	static nlohmann::json GetRegArgs(const std::string& reg_space);							// 读取正则化空间参数
+	static Dataset LoadDataset(const std::string& table_name, int64_t in_features, const Preprocessor* preprocessor = nullptr,
+							   MemoryCategory category = MemoryCategory::DATASET);					// 读取训练数据, 无预处理时前 in_features 列为特征, 最后一列为标签
+	static std::shared_ptr<const Dataset> GetDataset(const std::string& table_name, int64_t in_features,
+													 const Preprocessor* preprocessor = nullptr);		// 经 DatasetCache 读取训练数据, 表未变化时复用已转换的矩阵
+	static Preprocessor FitPreprocessor(const std::string& table_name, const ModelSpec& spec);				// 按 spec.preprocess 拟合特征预处理, 输出 in_features 列
+	static std::string TableVersion(const std::string& table_name);											// 表的版本标识 (行数和最大 rowid), 用于缓存失效
+	static int64_t CountRows(const std::string& table_name);													// 表的行数
+	static std::unique_ptr<BlockSource> OpenTable(const std::string& table_name, int64_t in_features,
+												  const Preprocessor* preprocessor = nullptr);			// 按 rowid 区间流式读取训练数据, 表必须是基本表
+	static int64_t MaxRowid(const std::string& table_name);													// 最大 rowid, 空表为 -1, 表必须是基本表
+	static int64_t ScanRows(const std::string& table_name, int64_t in_features, const Preprocessor* preprocessor,
+							const std::string& filter,
+							const std::function<void(const float* x, const float* y, int64_t rows)>& consume);	// 按 filter 逐 chunk 读取训练数据, 返回行数
+	static void SaveWeights(const std::vector<ModelWeights>& weights);										// 在一个事务中写入本地权重表和张量表, 同一 (model, key) 覆盖
+	static int64_t UpdateWeights(const ModelWeights& weights, const ModelWeights& previous);				// 只写回与 previous 不同的张量, 返回写入的张量数
+	static bool FindWeights(const std::string& model_name, const std::string& key, ModelWeights& weights);	// 读取本地权重, 不存在时返回 false
+	static ModelWeights GetWeights(const std::string& model_name, const std::string& key = "");			// 读取本地权重, 不存在时报错
+
+}; // class Catalog
+
+} // namespace regdb
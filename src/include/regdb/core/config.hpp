@@ -24,17 +24,22 @@ public:
 	static void ConfigureLocal(duckdb::DatabaseInstance& db);									// 对临时内存模式实例进行配置
 	static void ConfigureGlobal();																// 对全局存储模式实例进行配置
 	static void ConfigureTables(duckdb::Connection& con, ConfigType type);						// 对表进行配置
+	static int64_t ConfigureThreads(duckdb::ClientContext& context);							// 按 DuckDB threads 设置调整 regdb 的计算线程池, 返回线程数
 
 	static std::string get_schema_name();														// 获取 schema 名称
 	static std::filesystem::path get_global_storage_path();										// 获取全局存储模型路径
+	static std::filesystem::path get_checkpoint_path();											// 获取训练检查点目录, 位于全局存储目录下
 	static std::string get_modelarch_table_name();												// 获取模型表名称
 	static std::string get_regspace_table_name();												// 获取正则化表名称
+	static std::string get_weights_table_name();												// 获取模型权重表名称
+	static std::string get_tensors_table_name();												// 获取权重张量表名称
 
 private:
 	static void SetupGlobalStorageLocation();																// 设置全局存储路径
 	static void ConfigSchema(duckdb::Connection& con, std::string& schema_name);							// 配置 schema 名称
 	static void ConfigModelArchTable(duckdb::Connection& con, std::string& schema_name, ConfigType type);	// 配置模型空间表
 	static void ConfigRegSpaceTable(duckdb::Connection& con, std::string& schema_name, ConfigType type);	// 配置正则化空间表
+	static void ConfigWeightsTable(duckdb::Connection& con, std::string& schema_name);						// 配置模型权重表和张量表
 
 }; // class Config
 
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "regdb/core/engine/memory.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace regdb {
+
+// 指向 arena 内存的定长视图, 不拥有内存
+template <class T>
+class Span {
+public:
+    Span() = default;
+    Span(T* data, int64_t size) : data_(data), size_(size) {}
+
+    T* data() const { return data_; }
+    int64_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T& operator[](int64_t i) const { return data_[i]; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+private:
+    T* data_ = nullptr;
+    int64_t size_ = 0;
+};
+
+// 单块 64 字节对齐内存上的顺序分配器, 只能整体 Reset.
+// 默认构造的 arena 不持有内存, 只累计所需字节数, 用于按同样的切分顺序预先计算容量
+class Arena {
+public:
+    static constexpr int64_t ALIGNMENT = 64;
+
+    Arena() = default;
+    Arena(int64_t bytes, MemoryCategory category);
+
+    int64_t Capacity() const { return capacity_; }
+    int64_t Used() const { return used_; }
+    bool Measuring() const { return !block_; }
+    void Reset() { used_ = 0; }
+    // 空闲时允许后端换出, 重新借出前 Pin 回来, 之前切出的视图全部失效
+    void Unpin();
+    void Pin();
+    void SetCategory(MemoryCategory category);
+
+    // 分配 count 个元素, 内容未初始化, T 必须可平凡析构; 测量模式下返回空视图
+    template <class T>
+    Span<T> Allocate(int64_t count) {
+        const auto bytes = (count * static_cast<int64_t>(sizeof(T)) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        auto* data = Take(bytes);
+        return Span<T>(reinterpret_cast<T*>(data), data ? count : 0);
+    }
+
+private:
+    uint8_t* Take(int64_t bytes);
+
+    std::unique_ptr<MemoryBlock> block_;
+    uint8_t* base_ = nullptr;
+    int64_t capacity_ = 0;
+    int64_t used_ = 0;
+};
+
+// 进程内的 arena 池: 同形状 trial 的工作区所需字节数相同, 前一个 trial 归还的 arena 直接复用
+class ArenaPool {
+public:
+    // 借出的 arena, 析构时归还给池
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+        ~Handle();
+
+        Arena* operator->() const { return arena_.get(); }
+        Arena& operator*() const { return *arena_; }
+        explicit operator bool() const { return static_cast<bool>(arena_); }
+
+    private:
+        friend class ArenaPool;
+        Handle(ArenaPool* pool, std::unique_ptr<Arena> arena) : pool_(pool), arena_(std::move(arena)) {}
+
+        ArenaPool* pool_ = nullptr;
+        std::unique_ptr<Arena> arena_;
+    };
+
+    static ArenaPool& Instance();
+
+    // 返回容量不小于 bytes 的 arena (已 Reset), 优先复用池中最小的合适 arena;
+    // 池中空闲的 arena 记为 MemoryCategory::POOL 并允许换出
+    Handle Acquire(int64_t bytes, MemoryCategory category);
+    // 释放池中所有空闲 arena
+    void Clear();
+    int64_t IdleBytes() const;
+
+private:
+    static constexpr size_t MAX_IDLE = 256;
+
+    void Release(std::unique_ptr<Arena> arena);
+
+    mutable std::mutex lock_;
+    std::vector<std::unique_ptr<Arena>> idle_;
+};
+
+} // namespace regdb
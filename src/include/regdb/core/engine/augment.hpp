@@ -0,0 +1,84 @@
+#pragma once
+
+#include "regdb/core/engine/memory.hpp"
+#include "regdb/core/engine/spec.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <random>
+
+namespace regdb {
+
+// use_data_augment: 在 minibatch 缓冲内就地增强. 第 i 行与第 rows - 1 - i 行配对 (minibatch 已打乱, 相当于随机配对),
+// 每对同时改写, 不需要额外的行缓冲. 分类标签是类别下标不能混合, 保留混合后占比较大的一方 (自身) 的标签
+class Augmenter {
+public:
+    Augmenter(const RegConfig& config, bool regression);
+
+    bool Enabled() const { return enabled_; }
+    // 标量随机数 (mixup 系数、Philox key) 取自 rng, 逐元素随机数由 Philox 按块生成
+    void Apply(int64_t rows, int64_t cols, float* x, float* y, std::mt19937& rng) const;
+
+    // 由种子和 (epoch, minibatch 序号) 派生增强用的随机数种子, 结果与在哪个线程上生产无关
+    static uint32_t Seed(uint64_t seed, int64_t epoch, int64_t index);
+
+private:
+    void Mixup(int64_t rows, int64_t cols, float* x, float* y, std::mt19937& rng) const;
+    void Cutmix(int64_t rows, int64_t cols, float* x, float* y, uint64_t key) const;
+    void Noise(int64_t rows, int64_t cols, float* x, uint64_t key) const;
+
+    bool enabled_;
+    AugmentOp op_;
+    float strength_;
+    bool regression_;
+};
+
+// 双缓冲的 minibatch 预取: 预取线程按序号生产下一个 minibatch (gather + 增强), 训练线程消费当前的;
+// 没有预取线程, 或预取线程尚未认领某个 minibatch 时, 在 Next 中同步生产
+class BatchPrefetcher {
+public:
+    // produce(epoch, index, x, y) 把第 epoch 轮的第 index 个 minibatch 写入 x/y, 返回行数
+    using Producer = std::function<int64_t(int64_t epoch, int64_t index, float* x, float* y)>;
+
+    BatchPrefetcher(int64_t batch, int64_t cols, Producer produce);
+
+    // 开始新的一轮, 共 count 个 minibatch; 只能在上一轮读完或尚未开始时调用
+    void Reset(int64_t count);
+    // 取下一个 minibatch, 返回行数, 本轮结束时返回 0; 指针在下一次调用 Next 之前有效
+    int64_t Next(const float** x, const float** y);
+
+    // 在借来的线程上运行预取循环, 直到 Close
+    void RunPrefetcher();
+    void Close();
+
+private:
+    struct Slot {
+        Buffer<float> x{MemoryCategory::WORKSPACE};
+        Buffer<float> y{MemoryCategory::WORKSPACE};
+        int64_t index = -1;         // 本轮中的 minibatch 序号, -1 表示空闲
+        int64_t rows = 0;
+    };
+
+    // 等待 (或同步生产) 序号为 index 的 minibatch
+    Slot& Acquire(int64_t index);
+
+    Producer produce_;
+    std::mutex lock_;
+    std::condition_variable changed_;
+    Slot slots_[2];
+    int64_t epoch_ = -1;
+    int64_t count_ = 0;
+    int64_t next_load_ = 0;
+    bool prefetching_ = false;
+    bool closed_ = false;
+    std::exception_ptr error_;
+
+    // 消费端状态, 只由训练线程访问
+    Slot* current_ = nullptr;
+    int64_t current_index_ = -1;
+};
+
+} // namespace regdb
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "regdb/core/engine/spec.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+struct BenchmarkRow {
+    std::string benchmark;
+    std::string variant;
+    int64_t threads = 1;
+    double value = 0.0;
+    std::string unit;
+};
+
+// 训练引擎的基准测试, 使用合成数据, 不依赖具体的表
+class Benchmark {
+public:
+    // 单个 trial 数据并行的扩展性: 对每个线程数测 steps/s 和相对单线程的加速比
+    static std::vector<BenchmarkRow> DataParallel(const ModelSpec& spec, const std::vector<int64_t>& threads);
+    // 宽稀疏输入 (in_features 扩到 WIDE_FEATURES, 每行 ACTIVE_FEATURES 个 one-hot 列) 下
+    // Hogwild 与同步数据并行的对比: steps/s 以及一个 epoch 后的训练损失
+    static std::vector<BenchmarkRow> Hogwild(const ModelSpec& spec, const std::vector<int64_t>& threads);
+    // HeapCounter 计数的堆分配次数: 第一个 trial、复用 arena 的同形状 trial, 以及每多训练一个 epoch 的增量 (应为 0)
+    static std::vector<BenchmarkRow> ArenaAllocations(const ModelSpec& spec);
+    // 宽度 64/128/256/512 以及模型中其他隐藏层宽度的方阵线性层 (BATCH_SIZE 行): 通用 GEMM 与 kernels::Linear
+    // 选中的内核 (特化宽度为 fixed_<isa>, 其余为 fallback) 的 GFLOP/s 和加速比
+    static std::vector<BenchmarkRow> LayerWidths(const ModelSpec& spec);
+
+    static constexpr int64_t BATCH_SIZE = 512;
+    static constexpr int64_t STEPS = 8;
+    static constexpr int64_t WIDE_FEATURES = 4096;
+    static constexpr int64_t ACTIVE_FEATURES = 32;
+    static constexpr double KERNEL_SECONDS = 0.2;   // 每个内核至少重复运行的时长
+};
+
+} // namespace regdb
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "regdb/core/engine/dataset.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace regdb {
+
+// 跨查询共享的特征矩阵缓存. key 标识数据源 (读取查询的哈希), version 为数据源当前版本,
+// 版本变化时旧条目作废并重新加载; 同一 key 的并发请求只加载一次, 其余请求等待结果.
+// 总字节数超过容量时按最近最少使用淘汰, 被淘汰的矩阵在仍被使用时继续有效
+class DatasetCache {
+public:
+    using Loader = std::function<Dataset()>;
+
+    static DatasetCache& Instance();
+
+    std::shared_ptr<const Dataset> Get(uint64_t key, const std::string& version, const Loader& load);
+    void SetCapacity(int64_t bytes);
+    // 丢弃全部条目, 仍被使用的矩阵继续有效
+    void Clear();
+    int64_t Bytes() const;
+
+private:
+    struct Entry {
+        std::string version;
+        std::shared_future<std::shared_ptr<const Dataset>> dataset;
+        int64_t bytes = 0;          // 加载完成前为 0
+        uint64_t last_use = 0;
+    };
+
+    // 调用方持有 lock_
+    void Evict();
+
+    mutable std::mutex lock_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    int64_t capacity_ = std::numeric_limits<int64_t>::max();
+    int64_t bytes_ = 0;
+    uint64_t clock_ = 0;
+};
+
+} // namespace regdb
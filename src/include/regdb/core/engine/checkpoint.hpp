@@ -0,0 +1,104 @@
+#pragma once
+
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/optimizer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+struct TrainResult;
+
+// 从检查点读回的训练状态, epoch 为最后一个完整 epoch 的下标
+struct Checkpoint {
+    int64_t epoch = -1;
+    int64_t adam_steps = 0;
+    std::string rng;                    // std::mt19937 的文本状态
+    bool finished = false;              // trial 已经结束, 只保留结果, 没有张量
+    std::vector<double> train_curve;
+    std::vector<double> val_curve;
+    int64_t steps = 0;
+    bool stopped_early = false;
+    std::vector<float> params;
+    std::vector<float> buffers;
+    std::vector<float> adam_m;
+    std::vector<float> adam_v;
+    std::vector<float> lookahead_slow;  // 未开启 use_lookahead 时为空
+    std::vector<float> swa_average;     // 未开启 use_swa 时为空
+    int64_t swa_samples = 0;
+
+    // 目录下没有完整的检查点时返回 false; 块文件的哈希与清单不一致时报错
+    static bool Load(const std::string& directory, Checkpoint& checkpoint);
+    // 恢复参数、BN 统计量、Adam 状态、Lookahead/SWA 状态和随机数状态
+    void Restore(Mlp& model, Adam& optimizer, WeightAveraging& averaging, std::mt19937& generator) const;
+    // 已完成部分的训练结果, 最优 epoch 在验证曲线上重新选取
+    TrainResult Progress() const;
+};
+
+// 训练检查点: 训练线程在 epoch 边界把参数、BN 统计量、Adam 矩和权重平均的状态复制进快照,
+// 交给 ThreadPool 的一个空闲线程按 BLOCK_FLOATS 切块计算哈希, 只写内容变化的块, 最后原子地替换清单.
+// 块文件名包含哈希, 清单替换之前旧块始终有效, 写到一半崩溃时仍可从上一份清单恢复.
+// 上一份快照还在写时跳过这次检查点; 池已达到 threads 上限时由训练线程自己写, 不额外占用 CPU
+class Checkpointer {
+public:
+    static constexpr int64_t BLOCK_FLOATS = 16384;
+    static constexpr int ARRAYS = 6;
+
+    Checkpointer(std::string directory, std::chrono::milliseconds interval);
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // 距上次快照超过间隔且没有正在写的快照时为真
+    bool Due() const;
+    // 在 epoch 边界复制一份快照并写入, 上一份还在写时返回 false
+    bool Offer(const Mlp& model, const Adam& optimizer, const WeightAveraging& averaging, const std::mt19937& rng,
+               const TrainResult& progress, int64_t epoch);
+    // 等待正在写的快照写完
+    void Flush();
+    // trial 结束: 写入只含结果的清单并删除张量块
+    void Finish(const TrainResult& result);
+
+    const std::string& Directory() const { return directory_; }
+    int64_t Written() const { return written_blocks_; }    // 已写入的块数, 不含未变化而跳过的块
+
+    // 同步写入只含结果的清单, 用于不做中途检查点的 trial (例如堆叠训练)
+    static void WriteResult(const std::string& directory, const TrainResult& result);
+
+private:
+    struct Snapshot {
+        int64_t epoch = -1;
+        int64_t adam_steps = 0;
+        std::string rng;
+        std::vector<double> train_curve;
+        std::vector<double> val_curve;
+        int64_t steps = 0;
+        int64_t swa_samples = 0;
+        std::vector<float> arrays[ARRAYS];  // params, buffers, adam_m, adam_v, lookahead_slow, swa_average
+    };
+
+    // 写入 front_ 并清除 busy_, 在池线程或训练线程上运行
+    void WriteFront();
+    void Write(const Snapshot& snapshot);
+
+    std::string directory_;
+    std::chrono::milliseconds interval_;
+    std::chrono::steady_clock::time_point last_;
+    Snapshot back_;                     // 训练线程填写
+    Snapshot front_;                    // 写入线程读取
+    std::vector<std::vector<std::string>> files_;   // 当前清单中每个数组的块文件名
+    std::atomic<int64_t> written_blocks_{0};
+    mutable std::mutex lock_;
+    std::condition_variable idle_;
+    bool busy_ = false;
+};
+
+} // namespace regdb
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "regdb/core/engine/memory.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace regdb {
+
+// 训练数据, 特征为 [rows, cols] 行主序 float32, 每行一个标签
+struct Dataset {
+    int64_t rows = 0;
+    int64_t cols = 0;
+    Buffer<float> features{MemoryCategory::DATASET};
+    Buffer<float> labels{MemoryCategory::DATASET};
+
+    const float* Row(int64_t row) const { return features.data() + row * cols; }
+};
+
+// 训练/验证划分, 只保存行号, 不复制数据
+struct DataSplit {
+    std::vector<int64_t> train;
+    std::vector<int64_t> validation;
+};
+
+// 按固定种子打乱的全部行号
+std::vector<int64_t> ShuffleRows(int64_t rows, uint64_t seed);
+
+// 按固定种子打乱后留出 validation_fraction 作为验证集
+DataSplit SplitHoldout(int64_t rows, double validation_fraction, uint64_t seed);
+
+// k 折划分的第 fold 折: order 中第 fold 段作为验证集, 其余作为训练集; 各折共享同一个 order 和特征矩阵
+DataSplit SplitFold(const std::vector<int64_t>& order, int64_t folds, int64_t fold);
+
+// 按行号把样本收集到连续缓冲区
+void GatherRows(const Dataset& data, const int64_t* rows, int64_t count, float* x, float* y);
+
+} // namespace regdb
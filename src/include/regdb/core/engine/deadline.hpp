@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace regdb {
+
+using Clock = std::chrono::steady_clock;
+
+// 解析时间阈值, 支持 500ms / 120s / 5m / 1h, 纯数字按秒处理
+std::chrono::milliseconds ParseTimeThreshold(const std::string& threshold);
+
+// 停止原因
+enum class StopReason {
+    NONE,           // 未停止
+    DEADLINE,       // 到达时间预算
+    INTERRUPTED     // 用户中断 (Ctrl-C)
+};
+
+std::string StopReasonToString(StopReason reason);
+
+// 截止时间
+class Deadline {
+public:
+    explicit Deadline(std::chrono::milliseconds budget);
+
+    bool Expired() const { return Clock::now() >= end_; }
+    std::chrono::milliseconds Elapsed() const;
+    std::chrono::milliseconds Remaining() const;
+    std::chrono::milliseconds Budget() const { return budget_; }
+
+private:
+    Clock::time_point start_;
+    Clock::time_point end_;
+    std::chrono::milliseconds budget_;
+};
+
+// 协作式抢占令牌, 训练循环在抢占点调用 ShouldStop
+// 一旦触发停止, 所有共享该令牌的 trial 都会在下一个抢占点退出
+class StopToken {
+public:
+    explicit StopToken(const Deadline& deadline, const std::atomic<bool>* interrupted = nullptr)
+        : deadline_(deadline), interrupted_(interrupted) {}
+
+    bool ShouldStop();
+    void RequestStop(StopReason reason);
+    StopReason Reason() const { return reason_.load(std::memory_order_acquire); }
+    const Deadline& GetDeadline() const { return deadline_; }
+
+private:
+    const Deadline& deadline_;
+    const std::atomic<bool>* interrupted_;   // 指向 ClientContext::interrupted
+    std::atomic<StopReason> reason_{StopReason::NONE};
+};
+
+} // namespace regdb
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "regdb/core/engine/spec.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace regdb {
+
+// 搜索中所有 trial 共享的当前最优验证损失, 每个 epoch 验证后更新
+class Incumbent {
+public:
+    void Offer(double loss);
+    double Best() const { return best_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> best_{std::numeric_limits<double>::infinity()};
+};
+
+// 用幂律 a + b * t^-c 和指数 a + b * exp(-c * t) 拟合验证曲线 (t 从 1 计), 返回两者外推到第 epochs 个 epoch 的
+// 较低预测值; 只拟合单调下降的形状, 拟合不出下降趋势时返回曲线最小值
+double ExtrapolateCurve(const std::vector<double>& curve, int64_t epochs);
+
+// 单个 trial 的提前停止判断, 每个 epoch 验证之后调用
+class EarlyStopping {
+public:
+    static constexpr int64_t EXTRAPOLATE_MIN_EPOCHS = 3;   // 少于这么多点不做外推
+    static constexpr double EXTRAPOLATE_MARGIN = 0.05;     // 外推值比当前最优差出这个比例才停止, 抵消曲线噪声
+
+    EarlyStopping(const EarlyStopSpec& spec, int64_t max_epochs, Incumbent* incumbent)
+        : spec_(spec), max_epochs_(max_epochs), incumbent_(incumbent) {}
+
+    // curve 为截至当前 epoch 的验证曲线, 返回 true 时停止训练
+    bool Update(const std::vector<double>& curve);
+
+private:
+    EarlyStopSpec spec_;
+    int64_t max_epochs_;
+    Incumbent* incumbent_;
+    double best_ = std::numeric_limits<double>::infinity();
+    int64_t stale_ = 0;
+};
+
+} // namespace regdb
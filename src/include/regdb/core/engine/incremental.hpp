@@ -0,0 +1,50 @@
+#pragma once
+
+#include "regdb/core/engine/dataset.hpp"
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/optimizer.hpp"
+#include "regdb/core/engine/trainer.hpp"
+#include "regdb/core/engine/weights.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace regdb {
+
+// 增量训练: 行先进入缓冲, 每满 FLUSH_ROWS 行在缓冲上训练 max_epochs 个 epoch 后清空, 模型和 Adam 状态在多次训练之间保留.
+// 内存只随缓冲行数增长, 用于聚合函数的局部状态
+class IncrementalTrainer {
+public:
+    static constexpr int64_t FLUSH_ROWS = 16384;
+
+    IncrementalTrainer(const ModelSpec& spec, const RegConfig& config, const TrainOptions& options);
+    // 从已保存的权重继续训练, 保存了优化器状态时一并恢复 Adam 矩和步数
+    IncrementalTrainer(const ModelWeights& weights, const TrainOptions& options);
+
+    void Add(const float* x, float y);
+    // 在缓冲的行上训练后清空缓冲
+    void Flush();
+    // 两边先各自训练完缓冲, 再按训练行数加权平均参数和 BN 统计量, 结果留在 this
+    void Merge(IncrementalTrainer& other);
+
+    Mlp& Model() { return model_; }
+    int64_t Rows() const { return rows_ + buffer_.rows; }
+    // 每次训练最后一个 epoch 的平均损失, 按行数加权
+    double Loss() const { return loss_; }
+    // with_optimizer 时带上 Adam 状态, 供之后的 PARTIAL FIT 继续训练
+    ModelWeights Weights(const std::string& model_name, const std::string& key, bool with_optimizer = false);
+
+private:
+    Mlp model_;
+    TrainOptions options_;
+    Adam optimizer_;
+    MlpWorkspace ws_;
+    std::mt19937 rng_;
+    Dataset buffer_;
+    std::vector<int64_t> order_;
+    int64_t rows_ = 0;
+    double loss_ = 0.0;
+};
+
+} // namespace regdb
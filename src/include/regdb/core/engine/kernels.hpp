@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+
+namespace regdb {
+namespace kernels {
+
+// 行主序通用矩阵乘 C[M, N] = alpha * op(A) * op(B) + beta * C
+// trans_a: A 按 [K, M] 存储; trans_b: B 按 [N, K] 存储
+void Gemm(bool trans_a, bool trans_b, int64_t m, int64_t n, int64_t k, float alpha,
+          const float* a, int64_t lda, const float* b, int64_t ldb, float beta, float* c, int64_t ldc);
+
+// 预留当前线程的 GEMM 打包缓冲 (trans_b 时需要 N * K 个 float), 使之后的 Gemm 调用不再分配内存
+void ReservePackScratch(int64_t count);
+
+// 线性层 z[rows, out] = x[rows, in] * weight[in, out] + bias. out 为 64/128/256/512 时使用按宽度在编译期特化的内核
+// (x86-64 上按 CPU 选择 AVX-512、AVX2 或通用版本), 累加器留在寄存器中; 其余宽度走 LinearGemm
+void Linear(int64_t rows, int64_t in, int64_t out, const float* x, const float* weight, const float* bias, float* z);
+// 带行跨度的版本, 用于堆叠模型中按 trial 取出的列块; x / weight / z 的相邻两行分别相隔 ldx / ldw / ldz 个元素
+void Linear(int64_t rows, int64_t in, int64_t out, const float* x, int64_t ldx, const float* weight, int64_t ldw,
+            const float* bias, float* z, int64_t ldz);
+// 不按宽度特化的通用路径, 偏置作为 GEMM 累加的初值写入, 不再单独遍历输出
+void LinearGemm(int64_t rows, int64_t in, int64_t out, const float* x, const float* weight, const float* bias,
+                float* z);
+void LinearGemm(int64_t rows, int64_t in, int64_t out, const float* x, int64_t ldx, const float* weight,
+                int64_t ldw, const float* bias, float* z, int64_t ldz);
+// Linear 对该输出宽度是否使用特化的内核
+bool IsFixedWidth(int64_t out);
+// 特化内核选中的版本名, 编译器不支持向量扩展时为 none
+const char* DenseKernelIsa();
+
+// 按列求和 out[:] += sum_i x[i, :]
+void ColumnSum(int64_t rows, int64_t cols, const float* x, float* out);
+
+// dropout: 第 e 个元素由 Philox(key, counter) 的第 e 个随机数决定保留 (乘 1 / (1 - rate)) 或置 0,
+// 使用 Philox::Counters(count) 个计数器; 掩码按 64 个元素一块在栈上生成后立即使用, 不写回内存
+void Dropout(int64_t count, float rate, uint64_t key, uint64_t counter, float* x);
+
+// 以下矩阵均为 [rows, cols] 的视图, 行距为 ld, 便于在堆叠的多 trial 激活上按列块调用
+
+// 隐藏层 Linear 之后的融合前向 [BN] -> [LN] -> ReLU -> [dropout] -> [+skip], 空指针表示跳过对应步骤.
+// 逐行处理, 每行读一次线性层输出, 在 L1 内完成全部步骤后写出 act (和 out), 线性层输出不再写回
+struct NormActForwardArgs {
+    const float* bn_mean = nullptr;     // 非空时做 BN: 训练时为 batch 统计, 评估时为滑动均值
+    const float* bn_istd = nullptr;
+    const float* bn_gamma = nullptr;
+    const float* bn_beta = nullptr;
+    float* bn_xhat = nullptr;           // 训练时保存
+    const float* ln_gamma = nullptr;    // 非空时做 LN
+    const float* ln_beta = nullptr;
+    float* ln_xhat = nullptr;           // 训练时保存
+    float* ln_istd = nullptr;           // 每行一个
+    float dropout_rate = 0.0f;          // 大于 0 时做 dropout, 第 i 行使用从 dropout_counter + i * Philox::Counters(cols) 开始的计数器
+    uint64_t dropout_key = 0;
+    uint64_t dropout_counter = 0;
+    const float* skip = nullptr;        // 残差输入, 非空时写 out = act + skip
+    float* act = nullptr;
+    float* out = nullptr;
+};
+
+void NormActForward(int64_t rows, int64_t cols, int64_t ld, const float* z, const NormActForwardArgs& args);
+
+// BN 的 batch 统计: 以第一行为偏移累加一阶和二阶和, 只遍历一次; running_* 为空时不更新滑动统计量
+void BatchNormStatistics(int64_t rows, int64_t cols, int64_t ld, const float* z, float* mean, float* var,
+                         float* istd, float* running_mean, float* running_var, float momentum);
+
+// 与 NormActForward 对应的融合反向, d 就地改写为线性层输出的梯度. dropout、ReLU 和 LN 逐行完成,
+// 同一遍内累加 BN 的 dgamma/dbeta 和列统计; BN 的输入梯度依赖整列统计, 再遍历一次.
+// dropout 掩码不需要保存: 被丢弃的位置 act 为 0, 与 ReLU 的零梯度合并, 保留的位置乘 dropout_scale
+struct NormActBackwardArgs {
+    float dropout_scale = 0.0f;         // 大于 0 时做 dropout 反向
+    const float* act = nullptr;
+    const float* ln_xhat = nullptr;     // 非空时做 LN 反向
+    const float* ln_istd = nullptr;
+    const float* ln_gamma = nullptr;
+    float* ln_dgamma = nullptr;
+    float* ln_dbeta = nullptr;
+    const float* bn_xhat = nullptr;     // 非空时做 BN 反向
+    const float* bn_istd = nullptr;
+    const float* bn_gamma = nullptr;
+    float* bn_dgamma = nullptr;
+    float* bn_dbeta = nullptr;
+    float* bn_sum = nullptr;            // 长度 cols 的临时空间
+    float* bn_dot = nullptr;
+};
+
+void NormActBackward(int64_t rows, int64_t cols, int64_t ld, float* d, const NormActBackwardArgs& args);
+
+// 推理时把 BN 折叠进前一层: weight[:, j] *= s_j, bias_j = (bias_j - mean_j) * s_j + beta_j, s_j = gamma_j / sqrt(var_j + eps).
+// weight 和 folded_weight 的行距为 ld, 便于折叠堆叠权重中单个 trial 的列块
+void FoldBatchNorm(int64_t in, int64_t out, int64_t ld, const float* weight, const float* bias, const float* gamma,
+                   const float* beta, const float* running_mean, const float* running_var, float* folded_weight,
+                   float* folded_bias);
+
+// 量化和稀疏推理内核在 x86-64 上各编译 AVX-512 VNNI、AVX2 和通用三个版本, 首次调用时按 CPU 选择; 返回选中的版本名
+const char* QuantizedKernelIsa();
+
+// 激活量化为 uint8: q = clamp(round(v / scale), -127, 127) + 128
+void QuantizeActivations(int64_t count, const float* x, float scale, uint8_t* q);
+
+// int8 线性层 z[rows, out] = (q * weight - 128 * weight_sum) * x_scale * weight_scale + bias.
+// q 为 QuantizeActivations 的输出 [rows, in], weight 为按输出通道量化的 int8 [out, in], weight_sum 为其每行之和.
+// 点积写成 uint8 x int8 累加到 int32, 支持 VNNI 的 CPU 上编译为 vpdpbusd
+void LinearInt8(int64_t rows, int64_t in, int64_t out, const uint8_t* q, float x_scale, const int8_t* weight,
+                const int32_t* weight_sum, const float* weight_scale, const float* bias, float* z);
+
+// bf16 线性层, weight 为 [in, out] 的 bf16 (fp32 的高 16 位), 在寄存器中展开为 fp32 累加, 权重读取的字节数减半
+void LinearBf16(int64_t rows, int64_t in, int64_t out, const float* x, const uint16_t* weight, const float* bias,
+                float* z);
+
+// 块稀疏权重的列块宽度, 一个 AVX-512 向量
+constexpr int64_t SPARSE_BLOCK = 16;
+
+// 块稀疏线性层. 权重 [in, out] 的每行按 SPARSE_BLOCK 列分块, 只保存非零块 (BSR):
+// 第 p 行的块为 row_start[p] .. row_start[p + 1], block_col 为块的起始列 / SPARSE_BLOCK,
+// values 每块 SPARSE_BLOCK 个 fp32, 最后一列不足一块时补 0. 计算量与非零块数成正比
+void LinearBlockSparse(int64_t rows, int64_t in, int64_t out, const float* x, const int32_t* row_start,
+                       const int32_t* block_col, const float* values, const float* bias, float* z);
+
+// 均方误差总和, dpred 非空时写入 batch 平均损失的梯度
+double MseLoss(int64_t rows, const float* pred, int64_t ld, const float* y, float* dpred);
+
+// softmax 交叉熵总和, 标签为类别下标
+double SoftmaxCrossEntropy(int64_t rows, int64_t classes, const float* logits, int64_t ld, const float* y,
+                           float* dlogits);
+
+} // namespace kernels
+} // namespace regdb
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace regdb {
+
+// 引擎内存的分类, regdb_memory() 按此汇总
+enum class MemoryCategory {
+    DATASET,        // 训练数据
+    WEIGHTS,        // 模型参数、梯度和 BN 滑动统计量
+    WORKSPACE,      // 训练工作区 arena、梯度归约缓冲
+    OPTIMIZER,      // 优化器状态
+    CACHE,          // 跨查询缓存
+    POOL            // arena 池中空闲、可被换出的 arena
+};
+
+constexpr int64_t MEMORY_CATEGORY_COUNT = 6;
+
+std::string MemoryCategoryToString(MemoryCategory category);
+
+// 一块按分类计数的内存. 未 Pin 时内容可能被后端换出, Data() 无效
+class MemoryBlock {
+public:
+    MemoryBlock(MemoryCategory category, int64_t bytes);
+    virtual ~MemoryBlock();
+    MemoryBlock(const MemoryBlock&) = delete;
+    MemoryBlock& operator=(const MemoryBlock&) = delete;
+
+    virtual uint8_t* Data() = 0;
+    // 允许/禁止后端在内存压力下换出这块内存, 重新 Pin 后地址可能变化
+    virtual void Unpin() {}
+    virtual void Pin() {}
+
+    int64_t Bytes() const { return bytes_; }
+    MemoryCategory Category() const { return category_; }
+    void SetCategory(MemoryCategory category);
+
+private:
+    MemoryCategory category_;
+    int64_t bytes_;
+};
+
+// 内存后端, 扩展加载时替换为 DuckDB BufferManager, 使 memory_limit 覆盖引擎内存
+class MemoryBackend {
+public:
+    virtual ~MemoryBackend() = default;
+    virtual std::unique_ptr<MemoryBlock> Allocate(MemoryCategory category, int64_t bytes) = 0;
+};
+
+struct MemoryUsage {
+    MemoryCategory category;
+    int64_t bytes = 0;
+    int64_t peak_bytes = 0;
+    int64_t blocks = 0;
+};
+
+class Memory {
+public:
+    // 分配至少 bytes 字节, 超出后端限制时由后端抛出异常
+    static std::unique_ptr<MemoryBlock> Allocate(MemoryCategory category, int64_t bytes);
+    // nullptr 恢复为进程堆
+    static void SetBackend(std::shared_ptr<MemoryBackend> backend);
+    // 当前后端是 backend 时恢复为进程堆; 数据库关闭时使用, 之后安装的其他后端不受影响
+    static void ResetBackend(const MemoryBackend* backend);
+    static std::vector<MemoryUsage> Report();
+};
+
+// 存活期间统计进程内 operator new 的调用次数. 计数来自替换的全局 operator new, 包括 std::vector、thread_local
+// 缓冲和 arena 块的分配; 同一进程中其他线程的分配也计入, 基准测试中应单独运行
+class HeapCounter {
+public:
+    HeapCounter();
+    ~HeapCounter();
+    HeapCounter(const HeapCounter&) = delete;
+    HeapCounter& operator=(const HeapCounter&) = delete;
+
+    // 构造以来的分配次数
+    int64_t Count() const;
+
+private:
+    int64_t begin_;
+};
+
+// 由 Memory 分配的定长数组, 接口与 std::vector 的常用部分一致; T 必须可平凡复制
+template <class T>
+class Buffer {
+    static_assert(std::is_trivially_copyable<T>::value, "Buffer requires trivially copyable elements.");
+
+public:
+    explicit Buffer(MemoryCategory category) : category_(category) {}
+    Buffer(MemoryCategory category, int64_t size, T value = T()) : category_(category) {
+        assign(size, value);
+    }
+    Buffer(const Buffer& other) : category_(other.category_) {
+        Reallocate(other.size_);
+        size_ = other.size_;
+        if (size_ > 0) {
+            std::memcpy(data_, other.data_, size_ * sizeof(T));
+        }
+    }
+    Buffer& operator=(const Buffer& other) {
+        if (this != &other) {
+            Buffer copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    Buffer(Buffer&& other) noexcept
+        : category_(other.category_), block_(std::move(other.block_)), data_(other.data_), size_(other.size_),
+          capacity_(other.capacity_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+    Buffer& operator=(Buffer&& other) noexcept {
+        if (this != &other) {
+            category_ = other.category_;
+            block_ = std::move(other.block_);
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.capacity_ = 0;
+        }
+        return *this;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return static_cast<size_t>(size_); }
+    bool empty() const { return size_ == 0; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+    void reserve(size_t capacity) {
+        if (static_cast<int64_t>(capacity) > capacity_) {
+            Reallocate(static_cast<int64_t>(capacity));
+        }
+    }
+    void resize(size_t size, T value = T()) {
+        const auto count = static_cast<int64_t>(size);
+        if (count > capacity_) {
+            Reallocate(std::max(count, capacity_ * 2));
+        }
+        std::fill(data_ + std::min(size_, count), data_ + count, value);
+        size_ = count;
+    }
+    void assign(size_t size, T value) {
+        size_ = 0;
+        resize(size, value);
+    }
+    void push_back(T value) {
+        resize(size() + 1, value);
+    }
+
+private:
+    void Reallocate(int64_t capacity) {
+        auto block = capacity > 0 ? Memory::Allocate(category_, capacity * static_cast<int64_t>(sizeof(T))) : nullptr;
+        T* data = block ? reinterpret_cast<T*>(block->Data()) : nullptr;
+        if (size_ > 0) {
+            std::memcpy(data, data_, std::min(size_, capacity) * sizeof(T));
+        }
+        block_ = std::move(block);
+        data_ = data;
+        capacity_ = capacity;
+        size_ = std::min(size_, capacity);
+    }
+
+    MemoryCategory category_;
+    std::unique_ptr<MemoryBlock> block_;
+    T* data_ = nullptr;
+    int64_t size_ = 0;
+    int64_t capacity_ = 0;
+};
+
+} // namespace regdb
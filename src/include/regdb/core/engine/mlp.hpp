@@ -0,0 +1,135 @@
+#pragma once
+
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/spec.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+// 参数张量在连续参数存储中的位置
+struct TensorSlot {
+    std::string name;
+    int64_t offset;
+    int64_t size;
+    bool decay;     // 是否参与 weight decay
+};
+
+// 单层结构, 偏移量指向 Mlp 的参数存储, -1 表示该层没有对应张量
+struct LayerShape {
+    int64_t in = 0;
+    int64_t out = 0;
+    bool hidden = true;
+    bool skip = false;              // in == out 且开启 use_skip (或结构为残差结构) 时有残差连接
+    int64_t weight = -1;            // [in, out] 行主序
+    int64_t bias = -1;
+    int64_t bn_gamma = -1;
+    int64_t bn_beta = -1;
+    int64_t ln_gamma = -1;
+    int64_t ln_beta = -1;
+    int64_t running_mean = -1;      // 指向非训练缓冲区
+    int64_t running_var = -1;
+};
+
+// 单层前向缓存, 指向工作区 arena 内的切片
+struct LayerCache {
+    Span<float> z;                  // 线性层输出, 融合内核只读不写回
+    Span<float> bn_xhat;
+    Span<float> bn_mean;            // 反向时复用为按列求和的临时空间
+    Span<float> bn_var;
+    Span<float> bn_istd;
+    Span<float> ln_xhat;
+    Span<float> ln_istd;
+    Span<float> act;                // relu + dropout 之后
+    Span<float> out;                // 加上残差之后, 无残差时不使用
+};
+
+class Mlp;
+
+// 前向/反向工作区, 按最大 batch 一次算出所需字节数, 从 ArenaPool 借一块对齐的 arena 切分, 每个线程独占;
+// 训练循环内不再有堆分配
+class MlpWorkspace {
+public:
+    // 容量不足时重新借用 arena 并切分, 否则不做任何事
+    void Reserve(const Mlp& model, int64_t batch);
+    // 在 arena 上按固定顺序切分, 测量模式的 arena 只累计字节数
+    void Bind(const Mlp& model, int64_t batch, Arena& arena);
+    static int64_t Bytes(const Mlp& model, int64_t batch);
+    // 预留当前线程的 GEMM 打包缓冲, 在 worker 线程上训练前调用
+    void ReserveThreadScratch() const;
+    int64_t Capacity() const { return capacity_; }
+    // 把 BN 折叠进前一层线性层写入 folded, 开销约为一行输入的前向
+    void FoldBatchNorm(const Mlp& model);
+
+    Span<LayerCache> layers;
+    Span<float> logits;
+    Span<float> dlogits;
+    Span<float> grad_a;
+    Span<float> grad_b;
+    Span<float> x;                  // minibatch 特征暂存 [capacity, in_features]
+    Span<float> y;                  // minibatch 标签暂存 [capacity]
+    Span<float> folded;             // use_bn 时分配, 与参数存储同布局
+
+private:
+    int64_t capacity_ = 0;
+    int64_t pack_floats_ = 0;
+    ArenaPool::Handle arena_;
+};
+
+// 多层感知机: Linear -> [BN] -> [LN] -> ReLU -> [Dropout] -> [+skip], 最后一层为线性输出.
+// Linear 之后的各步骤由融合内核逐行完成, 评估时 BN 折叠进 Linear
+// out_features == 1 时为回归 (MSE), 否则为分类 (softmax 交叉熵, 标签为类别下标)
+class Mlp {
+public:
+    Mlp(const ModelSpec& spec, const RegConfig& config, uint64_t seed);
+
+    const ModelSpec& Spec() const { return spec_; }
+    const RegConfig& Config() const { return config_; }
+    const std::vector<LayerShape>& Layers() const { return layers_; }
+    const std::vector<TensorSlot>& Slots() const { return slots_; }
+
+    Buffer<float>& Parameters() { return params_; }
+    const Buffer<float>& Parameters() const { return params_; }
+    Buffer<float>& Gradients() { return grads_; }
+    Buffer<float>& Buffers() { return buffers_; }
+    const Buffer<float>& Buffers() const { return buffers_; }
+    int64_t MaxWidth() const { return max_width_; }
+    bool IsRegression() const { return spec_.out_features == 1; }
+
+    // 前向, 结果写入 ws.logits; update_stats 为假时不更新 BN 滑动统计量
+    void Forward(const float* x, int64_t batch, bool training, MlpWorkspace& ws, std::mt19937& rng,
+                 bool update_stats = true);
+    // 反向, 读取 ws.dlogits, 梯度覆盖写入 Gradients() 或 grads
+    void Backward(const float* x, int64_t batch, MlpWorkspace& ws);
+    void Backward(const float* x, int64_t batch, MlpWorkspace& ws, float* grads);
+    // 损失总和, dlogits 非空时写入 batch 平均损失的梯度
+    double Loss(const float* logits, const float* y, int64_t batch, float* dlogits) const;
+
+    // 一次训练步 (前向 + 损失 + 反向), 返回 batch 平均损失
+    double TrainStep(const float* x, const float* y, int64_t batch, MlpWorkspace& ws, std::mt19937& rng);
+    // 在 batch_rows 行 minibatch 的 rows 行分片上计算梯度, 按整个 minibatch 的平均损失缩放后写入 grads,
+    // 返回分片损失总和; 数据并行时各分片只读共享参数
+    double ShardGradient(const float* x, const float* y, int64_t rows, int64_t batch_rows, MlpWorkspace& ws,
+                         std::mt19937& rng, float* grads, bool update_stats);
+    // 评估模式下的损失总和
+    double EvaluateLoss(const float* x, const float* y, int64_t batch, MlpWorkspace& ws);
+    // 在 x 上做一次训练模式前向, 用这一批的统计量覆盖 BN 滑动统计量 (SWA 换入平均权重之后调用)
+    void RecomputeBatchNorm(const float* x, int64_t batch, MlpWorkspace& ws);
+
+private:
+    int64_t AddSlot(const std::string& name, int64_t size, bool decay);
+
+    ModelSpec spec_;
+    RegConfig config_;
+    std::vector<LayerShape> layers_;
+    std::vector<TensorSlot> slots_;
+    Buffer<float> params_{MemoryCategory::WEIGHTS};
+    Buffer<float> grads_{MemoryCategory::WEIGHTS};
+    Buffer<float> buffers_{MemoryCategory::WEIGHTS};
+    int64_t max_width_ = 0;
+};
+
+} // namespace regdb
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "regdb/core/engine/spec.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+// model_args 中的一个键
+struct ModelArg {
+    std::string name;
+    bool required = false;
+    std::string description;
+};
+
+// 按结构估算的单个模型开销
+struct ModelCost {
+    int64_t parameters = 0;         // 线性层权重和偏置的个数, 不含 BN/LN
+    int64_t flops_per_row = 0;      // 一行前向的浮点运算次数
+    int64_t widest = 0;             // 最宽一层的宽度, 含输出层
+};
+
+// 模型结构类型, 对应 REGDB_MODEL_ARCH_TABLE.model_type. 类型只在解析 model_args 时使用:
+// 校验参数并把结构特性写进 ModelSpec; 层循环读取构造时算好的 LayerShape 中的运行时标志, 不经过虚调用,
+// 也不按类型特化. 所有类型共用 MLP 的层, 类型不提供模型或内核
+class ModelType {
+public:
+    virtual ~ModelType() = default;
+
+    virtual const std::string& Name() const = 0;
+    virtual const std::string& Description() const = 0;
+    // 全部可用的键, 包括各类型共用的键
+    virtual const std::vector<ModelArg>& Args() const = 0;
+    // 由结构决定、不参与正则化搜索的开关及其取值
+    virtual const std::vector<std::pair<std::string, bool>>& FixedRegFlags() const = 0;
+    // 补充 ModelSpec::FromJson 解析出的 spec 并校验, 不合法时报错
+    virtual void Configure(ModelSpec& spec) const = 0;
+    virtual ModelCost Cost(const ModelSpec& spec) const = 0;
+
+    // 缺少必需的键或有未知的键时报错
+    void CheckArgs(const nlohmann::json& model_args) const;
+};
+
+// 各类型共用的键: in_features / out_features / hidden_features / hogwild / folds / early_stopping / preprocess
+const std::vector<ModelArg>& CommonModelArgs();
+// Linear 层堆叠的开销, MLP 一族的结构共用
+ModelCost LinearStackCost(const ModelSpec& spec);
+
+// 由结构描述类 Arch 生成的模型类型, 描述只在解析时读取, Arch 提供:
+//   static constexpr const char* NAME, DESCRIPTION
+//   static constexpr bool RESIDUAL                      为真时 in == out 的隐藏层总有残差连接
+//   static std::vector<ModelArg> ExtraArgs()            类型特有的键
+//   static std::vector<std::pair<std::string, bool>> FixedRegFlags()
+//   static void Validate(const ModelSpec& spec)
+//   static ModelCost Cost(const ModelSpec& spec)
+template <class Arch>
+class ArchModelType final : public ModelType {
+public:
+    ArchModelType() : name_(Arch::NAME), description_(Arch::DESCRIPTION), args_(CommonModelArgs()),
+                      fixed_(Arch::FixedRegFlags()) {
+        for (auto& arg : Arch::ExtraArgs()) {
+            args_.push_back(std::move(arg));
+        }
+    }
+
+    const std::string& Name() const override { return name_; }
+    const std::string& Description() const override { return description_; }
+    const std::vector<ModelArg>& Args() const override { return args_; }
+    const std::vector<std::pair<std::string, bool>>& FixedRegFlags() const override { return fixed_; }
+
+    void Configure(ModelSpec& spec) const override {
+        spec.model_type = name_;
+        spec.residual = Arch::RESIDUAL;
+        Arch::Validate(spec);
+    }
+
+    ModelCost Cost(const ModelSpec& spec) const override { return Arch::Cost(spec); }
+
+private:
+    std::string name_;
+    std::string description_;
+    std::vector<ModelArg> args_;
+    std::vector<std::pair<std::string, bool>> fixed_;
+};
+
+// 模型类型注册表, 内置 MLP 和 RESNET_MLP. 能用 MLP 的层和 LayerShape 标志表达的结构注册之后 CREATE MODEL
+// 即可使用, 不需要修改解析器; 类型没有前向/反向的钩子, 新的层要修改 Mlp / StackedMlp
+class ModelTypeRegistry {
+public:
+    static ModelTypeRegistry& Instance();
+
+    // 名字已注册时报错
+    void Register(std::unique_ptr<ModelType> type);
+    template <class Arch>
+    void Register() {
+        Register(std::make_unique<ArchModelType<Arch>>());
+    }
+
+    // 名字不区分大小写; 未注册时 Find 返回 nullptr, Get 报错
+    const ModelType* Find(const std::string& name) const;
+    const ModelType& Get(const std::string& name) const;
+    std::vector<std::string> Names() const;
+
+private:
+    ModelTypeRegistry();
+
+    mutable std::mutex lock_;
+    std::vector<std::unique_ptr<ModelType>> types_;     // 注册后不再移除, 返回的指针一直有效
+};
+
+} // namespace regdb
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/stacked_mlp.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace regdb {
+
+// Adam, 开启 use_weight_decay 时为解耦的 AdamW, 只衰减 TensorSlot::decay 为真的张量
+class Adam {
+public:
+    Adam(const Mlp& model, float learning_rate);
+
+    void Step(Mlp& model);
+    int64_t Steps() const { return steps_; }
+
+    // 数据并行时拆成两步: BeginStep 由一个线程调用, 之后各线程对不相交的参数区间 [begin, end) 调用 StepRange
+    void BeginStep();
+    void StepRange(Mlp& model, const float* grads, int64_t begin, int64_t end);
+    // Hogwild: 多个线程不加锁地并发调用, 参数和矩直接读改写, 偏差修正使用调用方自己的步数;
+    // active_rows 非空时第一层权重只更新被标记的输入行 (该行的输入在 minibatch 中全为 0 时梯度为 0)
+    void HogwildStep(Mlp& model, const float* grads, int64_t step, const uint8_t* active_rows);
+    // Hogwild 的步数由调用方计数, 保存检查点之前写回
+    void SyncSteps(int64_t steps) { steps_ = steps; }
+
+    // 导出/恢复一阶二阶矩和步数, 增量训练时随权重一起持久化
+    void SaveState(std::vector<float>& m, std::vector<float>& v) const;
+    void LoadState(const std::vector<float>& m, const std::vector<float>& v, int64_t steps);
+
+private:
+    float learning_rate_;
+    float beta1_ = 0.9f;
+    float beta2_ = 0.999f;
+    float eps_ = 1e-8f;
+    int64_t steps_ = 0;
+    float step_size_ = 0.0f;
+    float inv_sqrt_correction2_ = 1.0f;
+    ArenaPool::Handle state_;       // 一阶/二阶矩所在的 arena
+    Span<float> m_;
+    Span<float> v_;
+};
+
+// 堆叠训练使用的 Adam, 一阶/二阶矩本身按元素独立, 每个 trial 的列块使用各自的 weight decay
+class StackedAdam {
+public:
+    StackedAdam(const StackedMlp& model, float learning_rate);
+
+    void Step(StackedMlp& model);
+
+private:
+    float learning_rate_;
+    float beta1_ = 0.9f;
+    float beta2_ = 0.999f;
+    float eps_ = 1e-8f;
+    int64_t steps_ = 0;
+    ArenaPool::Handle state_;
+    Span<float> m_;
+    Span<float> v_;
+};
+
+// use_lookahead / use_swa 的权重平均, 包在 Adam 外面使用. 慢权重、SWA 平均和 BN 统计量备份在构造时
+// 从 arena 池一次借好, 训练循环内不再分配; 插值、平均和换入换出都是对连续参数存储的一次逐元素遍历
+class WeightAveraging {
+public:
+    static constexpr int64_t LOOKAHEAD_STEPS = 5;       // 每 k 步同步一次慢权重
+    static constexpr float LOOKAHEAD_ALPHA = 0.5f;
+    static constexpr double SWA_START = 0.75;           // 从 max_epochs 的这个比例开始平均
+
+    WeightAveraging(const Mlp& model, int64_t max_epochs);
+
+    // 优化器第 steps 步之后调用, 每 LOOKAHEAD_STEPS 步做一次 Lookahead
+    void Step(Mlp& model, int64_t steps);
+    // 数据并行时各线程对自己的参数区间调用
+    void StepRange(Mlp& model, int64_t steps, int64_t begin, int64_t end);
+    // 无条件地对 [begin, end) 做一次 Lookahead: slow += alpha * (fast - slow), fast = slow
+    void Lookahead(Mlp& model, int64_t begin, int64_t end);
+    // epoch 结束时调用, 从起始 epoch 开始把当前参数并入 SWA 平均
+    void EndEpoch(Mlp& model, int64_t epoch);
+
+    // SWA 已有平均时为真, 此时验证应使用平均权重
+    bool Averaged() const { return swa_samples_ > 0; }
+    // 换入平均权重, 在训练数据 x 上做一次批量前向重新计算 BN 统计量
+    void BeginEvaluate(Mlp& model, const float* x, int64_t batch, MlpWorkspace& ws);
+    // 换回训练中的参数和 BN 统计量
+    void EndEvaluate(Mlp& model);
+
+    // 导出/恢复慢权重、SWA 平均和采样次数, 随检查点一起持久化; 未开启的部分为空.
+    // 检查点中没有慢权重时 (旧的检查点) 以恢复后的参数作为慢权重
+    void SaveState(std::vector<float>& slow, std::vector<float>& average, int64_t& samples) const;
+    void LoadState(const Mlp& model, const std::vector<float>& slow, const std::vector<float>& average,
+                   int64_t samples);
+
+private:
+    bool lookahead_;
+    bool swa_;
+    int64_t swa_start_;
+    int64_t swa_samples_ = 0;
+    bool swapped_ = false;
+    ArenaPool::Handle state_;
+    Span<float> slow_;
+    Span<float> average_;
+    Span<float> buffers_;
+};
+
+// 堆叠训练的权重平均, 只作用在开启对应开关的 trial 的列块上
+class StackedWeightAveraging {
+public:
+    StackedWeightAveraging(const StackedMlp& model, int64_t max_epochs);
+
+    void Step(StackedMlp& model, int64_t steps);
+    void EndEpoch(StackedMlp& model, int64_t epoch);
+    bool Averaged() const { return swa_samples_ > 0; }
+    void BeginEvaluate(StackedMlp& model, const float* x, int64_t batch, StackedWorkspace& ws);
+    void EndEvaluate(StackedMlp& model);
+
+private:
+    // 对 flags[k] 为真的 trial 的每个列块调用 f(offset, width)
+    template <class F>
+    void ForEachBlock(const StackedMlp& model, const std::vector<bool>& flags, F&& f) const;
+
+    std::vector<bool> lookahead_;
+    std::vector<bool> swa_;
+    bool any_lookahead_ = false;
+    bool any_swa_ = false;
+    int64_t swa_start_;
+    int64_t swa_samples_ = 0;
+    bool swapped_ = false;
+    ArenaPool::Handle state_;
+    Span<float> slow_;
+    Span<float> average_;
+    Span<float> buffers_;
+};
+
+} // namespace regdb
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "regdb/core/engine/memory.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace regdb {
+
+constexpr int64_t CACHE_LINE_BYTES = 64;
+constexpr int64_t CACHE_LINE_FLOATS = CACHE_LINE_BYTES / static_cast<int64_t>(sizeof(float));
+
+// 屏障被放弃时等待中和之后到达的线程抛出, Lease::Run 优先重新抛出引起放弃的原始异常
+class BarrierAborted : public std::runtime_error {
+public:
+    BarrierAborted() : std::runtime_error("A parallel worker failed.") {}
+};
+
+// 自旋屏障, 最后一个到达的线程执行 completion 后放行其他线程, 不使用互斥锁.
+// worker 或 completion 抛出异常时调用 Abort (completion 的异常在这里处理), 其他线程不会永远等待
+class SpinBarrier {
+public:
+    explicit SpinBarrier(int64_t parties) : parties_(parties) {}
+
+    template <class F>
+    void ArriveAndWait(F&& completion) {
+        if (Aborted()) {
+            throw BarrierAborted();
+        }
+        const auto generation = generation_.load(std::memory_order_acquire);
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == parties_) {
+            try {
+                completion();
+            } catch (...) {
+                Abort();
+                throw;
+            }
+            waiting_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        // 先自旋, 等待过久时让出时间片, 线程数超过核数时也能推进
+        int64_t spins = 0;
+        while (generation_.load(std::memory_order_acquire) == generation) {
+            if (Aborted()) {
+                throw BarrierAborted();
+            }
+            if (++spins > SPIN_LIMIT) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void ArriveAndWait() {
+        ArriveAndWait([]() {});
+    }
+
+    // 放弃屏障, 之后所有 ArriveAndWait 都抛出 BarrierAborted
+    void Abort() { aborted_.store(true, std::memory_order_release); }
+    bool Aborted() const { return aborted_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr int64_t SPIN_LIMIT = 1024;
+
+    const int64_t parties_;
+    alignas(CACHE_LINE_BYTES) std::atomic<int64_t> waiting_{0};
+    alignas(CACHE_LINE_BYTES) std::atomic<int64_t> generation_{0};
+    std::atomic<bool> aborted_{false};
+};
+
+// 数据并行的梯度归约: 每个 worker 独占一块按 cache line 对齐的梯度缓冲区,
+// 参数区间按 cache line 切成 workers 块, worker i 对第 i 块在所有缓冲区上做两两树形求和, 结果落在缓冲区 0;
+// 各 worker 写入互不相交的 cache line, 不需要锁, 求和顺序固定, 结果与线程调度无关
+class GradientReducer {
+public:
+    GradientReducer(int64_t size, int64_t workers);
+
+    int64_t Workers() const { return workers_; }
+    float* Buffer(int64_t worker) { return base_ + worker * stride_; }
+    const float* Result() const { return base_; }
+    // worker 负责归约和更新的参数区间 [begin, end)
+    std::pair<int64_t, int64_t> Chunk(int64_t worker) const;
+    // 归约 worker 负责的区间, 调用前所有 worker 的梯度必须已写完
+    void Reduce(int64_t worker);
+
+private:
+    int64_t size_;
+    int64_t workers_;
+    int64_t stride_;    // 缓冲区间距, cache line 整数倍
+    int64_t chunk_;     // 每个 worker 负责的区间长度, cache line 整数倍
+    regdb::Buffer<float> storage_{MemoryCategory::WORKSPACE};
+    float* base_ = nullptr;
+};
+
+// 进程内共享的计算线程池, 大小跟随 DuckDB 的 threads 设置, 搜索、训练、预取和检查点写入都从这里借线程,
+// regdb 的总并发不超过 Threads(). 扩展用 Attach 把池接到 DuckDB 的 TaskScheduler 上: 池的线程是占住
+// DuckDB worker 的任务, 与其他查询的任务共用 threads 个线程; 没有接入时 (引擎单独使用) 自建线程.
+// 借出的线程在 Lease 存续期间独占, 而且只借出已经在运行的线程, 因此一次 Run 的所有 worker 保证同时运行,
+// 可以在 worker 之间使用 SpinBarrier; 嵌套借用只能拿到剩余的空闲线程, 不会超订
+class ThreadPool {
+public:
+    // 安排 fn 在一个外部线程上运行, 不能安排时返回 false
+    using Launcher = std::function<bool(std::function<void()>)>;
+
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        // 实际并发 worker 数, 包括调用方线程
+        int64_t Workers() const { return static_cast<int64_t>(threads_.size()) + 1; }
+        // 并发执行 fn(0..Workers()-1), worker 0 在调用方线程上运行, 阻塞直到全部完成, 重新抛出第一个异常;
+        // BarrierAborted 只在没有其他异常时抛出
+        void Run(const std::function<void(int64_t)>& fn);
+
+    private:
+        friend class ThreadPool;
+        Lease(ThreadPool* pool, std::vector<int64_t> threads) : pool_(pool), threads_(std::move(threads)) {}
+
+        ThreadPool* pool_;
+        std::vector<int64_t> threads_;
+    };
+
+    static ThreadPool& Instance();
+
+    ThreadPool();
+    ~ThreadPool();
+
+    // 设置总并发数 (包括调用方线程), 由扩展按 DuckDB 的 threads 设置调用
+    void Resize(int64_t threads);
+    int64_t Threads() const;
+    // 之后新启动的线程由 launcher 在外部线程上运行, 空闲超过 LINGER 后退出, 把外部线程还回去;
+    // 传入空函数时恢复为自建线程
+    void Attach(Launcher launcher);
+    // 借用最多 workers - 1 个空闲线程, 拿不到时 Workers() 可能小于 workers, 最少为 1 (只有调用方).
+    // 接入外部线程时, 运行中的线程不够则请求启动并最多等待 LAUNCH_WAIT, 迟到的线程留给之后的借用
+    Lease Acquire(int64_t workers);
+    // 在一个空闲线程上异步运行 task, task 返回之前占用一个并发名额; 没有空闲名额时不等待, 返回 false.
+    // task 不能抛出异常
+    bool Submit(std::function<void()> task);
+
+private:
+    static constexpr std::chrono::milliseconds LAUNCH_WAIT{20};
+    static constexpr std::chrono::milliseconds LINGER{50};
+
+    struct Slot {
+        std::function<void()> task;
+        bool stop = false;
+        bool alive = true;          // 外部线程退出后为 false, 槽位可以复用
+        bool external = false;
+        std::condition_variable ready;
+    };
+
+    // 持有 lock_ 调用, 借出最多 wanted 个线程并计入 leased_; launch 为假时不请求启动外部线程
+    std::vector<int64_t> Take(std::unique_lock<std::mutex>& guard, int64_t wanted, bool launch);
+    int64_t NewSlot(bool external);
+    void Loop(int64_t index);
+    void Release(const std::vector<int64_t>& threads);
+
+    mutable std::mutex lock_;
+    int64_t limit_ = 1;
+    int64_t leased_ = 0;
+    Launcher launcher_;
+    int64_t starting_ = 0;          // 已请求启动、还没开始运行的外部线程
+    int64_t external_running_ = 0;
+    std::condition_variable arrived_;
+    std::condition_variable exited_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<std::thread> threads_;
+    std::vector<int64_t> idle_;
+};
+
+} // namespace regdb
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/prune.hpp"
+#include "regdb/core/engine/quantize.hpp"
+#include "regdb/core/engine/stacked_mlp.hpp"
+#include "regdb/core/engine/weights.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace regdb {
+
+// Predictor::Predict 的线程局部工作区
+class PredictWorkspace {
+private:
+    friend class Predictor;
+    std::vector<MlpWorkspace> singles;
+    std::vector<QuantizedWorkspace> quantized;
+    std::vector<SparseWorkspace> sparse;
+    std::vector<StackedWorkspace> groups;
+    std::vector<float> sum;             // 集成成员输出的累加, [TILE_ROWS, out_features]
+};
+
+// 推理: 由保存的权重构造一次模型, 之后只做评估前向. 评估前向不改写模型, 多个线程各用自己的工作区并发调用.
+// 多个成员时为集成: 结构相同的成员堆叠为一个 StackedMlp, 第一层合并为一次 GEMM;
+// 每个 TILE_ROWS 行的输入块依次经过全部成员, 输出就地累加, 回归取平均, 分类对 softmax 概率取平均后取 argmax.
+// 权重带有量化或块稀疏张量的成员以 QuantizedMlp / SparseMlp 推理, 不参与堆叠
+class Predictor {
+public:
+    // 一次前向的行数, 大于 DuckDB 的 2048 行向量, 让 GEMM 的打包开销摊到更多行上
+    static constexpr int64_t BATCH_ROWS = 8192;
+    // 集成时每块的行数, 输入块在各成员之间留在缓存中
+    static constexpr int64_t TILE_ROWS = 1024;
+
+    explicit Predictor(const ModelWeights& weights);
+    // 成员的 in_features 和 out_features 必须相同, 否则报错
+    explicit Predictor(const std::vector<ModelWeights>& members);
+
+    int64_t Members() const { return members_; }
+    bool IsRegression() const { return spec_.out_features == 1; }
+    int64_t InFeatures() const { return spec_.in_features; }
+
+    // 单个模型时为其推理精度, 集成时为 FP32
+    Precision GetPrecision() const;
+
+    // x 为 rows 行输入, 回归写入预测值, 分类写入 argmax 类别下标
+    void Predict(const float* x, int64_t rows, PredictWorkspace& ws, float* out) const;
+
+private:
+    // 把一块行的输出累加到 sum, 分类累加 softmax 概率
+    void Accumulate(const float* logits, int64_t rows, int64_t stride, float* sum) const;
+    // 单独推理的第 i 个成员的前向, 返回 logits
+    const float* Forward(size_t i, const float* x, int64_t rows, PredictWorkspace& ws) const;
+    void AddSingle(const ModelWeights& weights);
+
+    ModelSpec spec_;
+    int64_t members_ = 0;
+    mutable std::vector<std::unique_ptr<Mlp>> singles_;
+    std::vector<std::unique_ptr<QuantizedMlp>> quantized_;     // 与 singles_ 对应, fp32 推理的成员为空
+    std::vector<std::unique_ptr<SparseMlp>> sparse_;           // 与 singles_ 对应, 稠密推理的成员为空
+    mutable std::vector<std::unique_ptr<StackedMlp>> groups_;
+};
+
+} // namespace regdb
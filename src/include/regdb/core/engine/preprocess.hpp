@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+enum class FeatureTransform {
+    ZSCORE,         // (v - mean) / stddev
+    MINMAX,         // (v - min) / (max - min)
+    ONEHOT,         // 每个类别一列, 未见过的类别和 NULL 全为 0
+    HASH            // murmur3 哈希到共享的 hash_buckets 列, 哈希的一位决定 +1/-1
+};
+
+std::string FeatureTransformToString(FeatureTransform transform);
+FeatureTransform FeatureTransformFromString(const std::string& name);
+
+// 一个输入列的变换, 数值变换统一为 (v - shift) * scale
+struct ColumnTransform {
+    std::string name;
+    FeatureTransform transform = FeatureTransform::ZSCORE;
+    float shift = 0.0f;
+    float scale = 1.0f;
+    std::vector<std::string> categories;
+    int64_t offset = 0;             // 输出的第一列, HASH 列为共享哈希区的起点
+
+    bool Numeric() const { return transform == FeatureTransform::ZSCORE || transform == FeatureTransform::MINMAX; }
+};
+
+uint32_t MurmurHash3(const void* data, size_t length, uint32_t seed);
+
+// 拟合好的特征预处理: 把表的特征列变换为 Width() 列 float32, 与模型一起保存, 预测时按同样的变换处理输入.
+// 输出按列顺序排布, 所有 HASH 列共享末尾的 hash_buckets 列. Transform* 对一批行的一个输入列做一次顺序遍历,
+// 写入行主序输出 (行距为 Width()), 调用前输出需清零
+class Preprocessor {
+public:
+    // 未指定变换的非数值列, 类别数不超过此值时使用 one-hot, 否则哈希
+    static constexpr int64_t ONEHOT_LIMIT = 32;
+
+    Preprocessor() = default;
+    // 按列变换和输出宽度计算各列偏移与哈希区大小, 宽度不匹配时抛出异常
+    Preprocessor(std::vector<ColumnTransform> columns, std::string label, int64_t width);
+
+    static Preprocessor FromJson(const nlohmann::json& json);
+    nlohmann::json ToJson() const;
+
+    int64_t Width() const { return width_; }
+    const std::vector<ColumnTransform>& Columns() const { return columns_; }
+    const std::string& Label() const { return label_; }
+
+    // valid 为 nullptr 表示全部有效, NULL 输出 0
+    void TransformNumeric(int64_t column, const float* values, const uint8_t* valid, int64_t rows, float* out) const;
+    void TransformCategorical(int64_t column, const std::string_view* values, const uint8_t* valid, int64_t rows,
+                              float* out) const;
+
+private:
+    void BuildIndex();
+
+    std::vector<ColumnTransform> columns_;
+    std::string label_;
+    int64_t width_ = 0;
+    int64_t hash_offset_ = 0;
+    int64_t hash_buckets_ = 0;
+    std::vector<std::unordered_map<std::string, int64_t>> index_;   // ONEHOT 列的类别 -> 输出列
+};
+
+} // namespace regdb
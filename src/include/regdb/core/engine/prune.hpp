@@ -0,0 +1,85 @@
+#pragma once
+
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/quantize.hpp"
+#include "regdb/core/engine/weights.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+enum class PruneMethod : uint8_t {
+    MAGNITUDE,      // 隐藏层权重按 1 x SPARSE_BLOCK 块的范数剪枝, 以块稀疏格式推理
+    NEURON          // 按重要性去掉隐藏层神经元, hidden_features 变小, 仍以稠密格式推理
+};
+
+std::string PruneMethodToString(PruneMethod method);
+PruneMethod PruneMethodFromString(const std::string& name);
+
+bool IsSparseKind(const std::string& kind);
+
+// pruned 与 spec 的隐藏层数相同且每层不比 spec 宽, 即 pruned 可能是 spec 的模型经 PruneNeurons 得到的 (包括未剪枝)
+bool IsPrunedFrom(const ModelSpec& pruned, const ModelSpec& spec);
+
+// 把每个隐藏层权重中范数最小的 sparsity 比例的块置零 (BN 按折叠后的尺度计入范数), 输出层不剪;
+// 返回的权重结构不变, 不含 Adam 状态
+ModelWeights PruneBlocks(const ModelWeights& weights, double sparsity);
+
+// 每个隐藏层去掉 sparsity 比例的神经元, 重要性为输入权重范数 (LN 时为 LN 的缩放) 与输出权重范数之积.
+// 残差连接的各层共用一组神经元; 调整宽度时保证原来有残差的层仍有、没有的层仍没有.
+// 返回 hidden_features 变小的权重, 不含 Adam 状态
+ModelWeights PruneNeurons(const ModelWeights& weights, double sparsity);
+
+class SparseMlp;
+
+// SparseMlp::Forward 的线程局部工作区, 从 ArenaPool 借一块对齐的 arena 切分
+class SparseWorkspace {
+private:
+    friend class SparseMlp;
+    void Reserve(const SparseMlp& model, int64_t batch);
+    void Bind(const SparseMlp& model, int64_t batch, Arena& arena);
+
+    int64_t capacity_ = 0;
+    ArenaPool::Handle arena_;
+    Span<float> z;
+    Span<float> act[2];
+    Span<float> out[2];
+    Span<float> ln_istd;
+    Span<float> logits;
+};
+
+// 块稀疏推理的 MLP, 只用于评估前向. 各线性层 (BN 折叠之后) 只保存非零的块, 以 kernels::LinearBlockSparse 计算;
+// LN、ReLU 和残差仍由 fp32 的融合内核完成. 引用构造时的 Mlp
+class SparseMlp {
+public:
+    // 由剪枝后的模型构造, 全零的块不保存
+    explicit SparseMlp(const Mlp& model);
+    // 从张量表恢复, 张量与结构不一致时报错
+    SparseMlp(const Mlp& model, const std::vector<QuantizedTensor>& tensors);
+
+    const Mlp& Model() const { return model_; }
+    // 保存的块占全部块的比例
+    double Density() const;
+    // 非零块和索引占用的字节数, 不含 LN 参数和偏置
+    int64_t WeightBytes() const;
+    std::vector<QuantizedTensor> Tensors() const;
+
+    // 返回 [rows, out_features] 的 logits, 指向工作区
+    const float* Forward(const float* x, int64_t rows, SparseWorkspace& ws) const;
+
+private:
+    struct Layer {
+        std::vector<float> bias;            // 折叠 BN 之后的偏置, 由 fp32 参数重新计算, 不保存
+        std::vector<int32_t> row_start;     // [in + 1]
+        std::vector<int32_t> block_col;     // 每块的起始列 / SPARSE_BLOCK
+        std::vector<float> values;          // 每块 SPARSE_BLOCK 个
+    };
+
+    const Mlp& model_;
+    std::vector<Layer> layers_;
+};
+
+} // namespace regdb
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "regdb/core/engine/arena.hpp"
+#include "regdb/core/engine/mlp.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+enum class Precision : uint8_t {
+    FP32,
+    BF16,       // 权重截为 bf16, 激活和累加保持 fp32
+    INT8        // 权重按输出通道对称量化, 激活按校准得到的每层尺度量化, int32 累加
+};
+
+std::string PrecisionToString(Precision precision);
+Precision PrecisionFromString(const std::string& name);
+
+// 与 fp32 张量一起保存在张量表中的量化张量, data 为原始字节; kind 由 IsQuantizedKind 识别
+struct QuantizedTensor {
+    std::string name;
+    std::string kind;
+    std::vector<uint8_t> data;
+};
+
+bool IsQuantizedKind(const std::string& kind);
+
+class QuantizedMlp;
+
+// QuantizedMlp::Forward 的线程局部工作区, 与 MlpWorkspace 一样从 ArenaPool 借一块 64 字节对齐的 arena 切分
+class QuantizedWorkspace {
+private:
+    friend class QuantizedMlp;
+    void Reserve(const QuantizedMlp& model, int64_t batch);
+    void Bind(const QuantizedMlp& model, int64_t batch, Arena& arena);
+
+    int64_t capacity_ = 0;
+    ArenaPool::Handle arena_;
+    Span<float> z;
+    Span<float> act[2];
+    Span<float> out[2];
+    Span<float> ln_istd;
+    Span<uint8_t> q;
+    Span<float> logits;
+};
+
+// 训练后量化的 MLP, 只用于评估前向. 各线性层的权重换成 bf16 或 int8, BN 在量化之前折叠进线性层,
+// LN、ReLU 和残差仍由 fp32 的融合内核完成. 模型引用构造时的 Mlp, 读取其中的 LN 参数和层结构
+class QuantizedMlp {
+public:
+    // 量化 model; INT8 时在 calibration 的 rows 行上做一次 fp32 前向, 每层输入的最大绝对值 / 127 作为激活尺度
+    QuantizedMlp(const Mlp& model, Precision precision, const float* calibration, int64_t rows);
+    // 从张量表恢复, 张量与结构不一致时报错
+    QuantizedMlp(const Mlp& model, const std::vector<QuantizedTensor>& tensors);
+
+    Precision GetPrecision() const { return precision_; }
+    const Mlp& Model() const { return model_; }
+    // 量化权重占用的字节数, 不含 LN 参数和偏置
+    int64_t WeightBytes() const;
+    std::vector<QuantizedTensor> Tensors() const;
+
+    // 返回 [rows, out_features] 的 logits, 指向工作区
+    const float* Forward(const float* x, int64_t rows, QuantizedWorkspace& ws) const;
+
+private:
+    struct Layer {
+        std::vector<float> bias;            // 折叠 BN 之后的偏置, 由 fp32 参数重新计算, 不保存
+        std::vector<uint16_t> bf16;         // [in, out]
+        std::vector<int8_t> int8;           // [out, in], 每行一个输出通道
+        std::vector<float> scale;           // 每个输出通道的权重尺度
+        std::vector<int32_t> sum;           // 每个输出通道的量化权重之和
+        float input_scale = 0.0f;
+    };
+
+    // 折叠 BN 得到每层的 fp32 权重和偏置
+    std::vector<std::vector<float>> Fold();
+    void Quantize(const std::vector<std::vector<float>>& weights);
+    void Linear(size_t l, const float* input, int64_t rows, QuantizedWorkspace& ws, float* z) const;
+    const float* Run(const float* x, int64_t rows, QuantizedWorkspace& ws,
+                     const std::vector<std::vector<float>>* fp32, float* input_max) const;
+
+    const Mlp& model_;
+    Precision precision_;
+    std::vector<Layer> layers_;
+};
+
+// 同一批行上原模型与压缩 (量化或剪枝) 之后推理的对比, 用于逐个模型决定是否使用压缩的权重
+struct CompressionReport {
+    double fp32_loss = 0.0;             // 平均损失
+    double compressed_loss = 0.0;
+    double prediction_delta = 0.0;      // 回归: 预测值的平均绝对差; 分类: argmax 不一致的行所占比例
+    double fp32_rows_per_second = 0.0;
+    double compressed_rows_per_second = 0.0;
+    int64_t fp32_bytes = 0;             // 线性层权重的字节数
+    int64_t compressed_bytes = 0;
+
+    double Speedup() const {
+        return fp32_rows_per_second > 0.0 ? compressed_rows_per_second / fp32_rows_per_second : 0.0;
+    }
+};
+
+// forward 在 rows 行上前向并返回 [rows, out_features] 的 logits; compressed_bytes 为压缩后权重的字节数
+CompressionReport CompareCompressed(Mlp& model, const std::function<const float*(const float*, int64_t)>& forward,
+                                    int64_t compressed_bytes, const float* x, const float* y, int64_t rows);
+
+} // namespace regdb
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace regdb {
+
+// Philox4x32-10 计数器随机数: 输出只由 (key, counter) 决定, 任意位置都可以独立生成或重算,
+// 不需要保存生成器状态, 也不需要在线程之间同步
+class Philox {
+public:
+    static constexpr int64_t BLOCK = 64;    // Block 一次生成的随机数个数 (16 个计数器, 每个 4 个)
+
+    // 生成 counter .. counter + 15 的 64 个随机数, 16 个计数器按 SoA 排列同时做 10 轮, 编译器可以直接向量化
+    static void Block(uint64_t key, uint64_t counter, uint32_t* out);
+    // 生成 count 个随机数所需的计数器个数
+    static int64_t Counters(int64_t count) { return (count + BLOCK - 1) / BLOCK * (BLOCK / 4); }
+    // 随机数映射到 [0, 1)
+    static float Uniform(uint32_t value) { return static_cast<float>(value >> 8) * (1.0f / 16777216.0f); }
+};
+
+} // namespace regdb
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+// trial 的提前停止策略, 默认关闭; 搜索使用 model_args.early_stopping, 为 true 时取 DefaultForSearch.
+// 外推依赖所有 trial 共享的当前最优, 结果与 trial 的调度顺序有关, 只在显式设置 extrapolate 时开启
+struct EarlyStopSpec {
+    int64_t patience = 0;       // 验证损失连续 patience 个 epoch 没有改善超过 min_delta 时停止, 0 表示关闭
+    double min_delta = 0.0;
+    bool extrapolate = false;   // 学习曲线外推到最后一个 epoch 仍不能超过当前最优时停止
+
+    bool Enabled() const { return patience > 0 || extrapolate; }
+    static EarlyStopSpec DefaultForSearch() { return {5, 1e-4, false}; }
+};
+
+// 模型结构, 对应 REGDB_MODEL_ARCH_TABLE.model_args
+struct ModelSpec {
+    std::string model_type;
+    int64_t in_features = 0;
+    int64_t out_features = 0;
+    std::vector<int64_t> hidden_features;
+    bool hogwild = false;               // model_args.hogwild, 多线程训练时使用异步 Hogwild 更新
+    int64_t folds = 1;                  // model_args.folds, 大于 1 时搜索用 k 折交叉验证评估每个 trial
+    EarlyStopSpec early_stopping;       // model_args.early_stopping, 未设置时关闭
+    nlohmann::json preprocess;          // model_args.preprocess, 列名 -> 变换 (zscore/minmax/onehot/hash), null 表示不预处理
+    bool residual = false;              // 由 model_type 决定, 为真时 in == out 的隐藏层不论 use_skip 都有残差连接
+
+    // 按 ModelTypeRegistry 中 model_type 注册的参数表校验 model_args, 类型未注册时报错
+    static ModelSpec FromJson(const std::string& model_type, const nlohmann::json& model_args);
+    nlohmann::json ToJson() const;
+};
+
+// use_data_augment 的 minibatch 内增强方式
+enum class AugmentOp : uint8_t {
+    MIXUP,      // 两行按 Beta(a, a) 系数线性混合, 强度为 a
+    CUTMIX,     // 每个特征以强度给出的概率换成配对行的值
+    NOISE       // 加高斯噪声, 强度为标准差
+};
+
+AugmentOp AugmentOpFromString(const std::string& name);
+std::string AugmentOpToString(AugmentOp op);
+float DefaultAugmentStrength(AugmentOp op);
+
+// 单个 trial 的正则化配置, 对应 REGDB_REG_SPACE_TABLE.reg_args 中的八个开关
+struct RegConfig {
+    bool use_weight_decay = false;
+    bool use_dropout = false;
+    bool use_bn = false;
+    bool use_ln = false;
+    bool use_skip = false;
+    bool use_data_augment = false;
+    bool use_swa = false;
+    bool use_lookahead = false;
+
+    float weight_decay = 1e-2f;
+    float dropout_rate = 0.1f;
+    AugmentOp augment = AugmentOp::MIXUP;   // use_data_augment 时生效, 与强度一起参与搜索
+    float augment_strength = 0.2f;
+
+    static RegConfig FromJson(const nlohmann::json& reg_args);
+    nlohmann::json ToJson() const;
+};
+
+// 正则化空间: 取值为 true 的开关参与搜索 (开/关), false 的开关固定关闭.
+// use_data_augment 还可以是 {"ops": [...], "strength": [...]}, 开启时在增强方式和强度的组合上继续展开,
+// 为 true 时展开三种方式的默认强度
+class RegSpace {
+public:
+    static RegSpace FromJson(const nlohmann::json& reg_args);
+
+    // 把布尔开关固定为 value, 不再参与搜索; 用于由模型结构决定的开关
+    void Fix(const std::string& name, bool value);
+    // 枚举全部配置, 第一个为除固定开关外全关闭的基线
+    std::vector<RegConfig> Enumerate() const;
+
+private:
+    std::vector<std::string> searchable_;
+    std::vector<std::pair<std::string, bool>> fixed_;
+    std::vector<std::pair<AugmentOp, float>> augments_;
+};
+
+} // namespace regdb
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "regdb/core/engine/mlp.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+// 堆叠张量, 逻辑形状为 [rows, K * width], trial k 占据每行的第 k 个列块
+struct StackedSlot {
+    std::string name;
+    int64_t offset;
+    int64_t rows;
+    int64_t width;
+    bool decay;
+};
+
+class StackedMlp;
+
+// 堆叠的多 trial 工作区, 激活为 [batch, K * width]
+class StackedWorkspace {
+public:
+    void Reserve(const StackedMlp& model, int64_t batch);
+    void Bind(const StackedMlp& model, int64_t batch, Arena& arena);
+    int64_t Capacity() const { return capacity_; }
+    // 把使用 BN 的 trial 的 BN 折叠进前一层写入 folded, 其余 trial 的列块原样复制
+    void FoldBatchNorm(const StackedMlp& model);
+
+    Span<LayerCache> layers;
+    Span<float> logits;
+    Span<float> dlogits;
+    Span<float> grad_a;
+    Span<float> grad_b;
+    Span<float> x;
+    Span<float> y;
+    Span<double> losses;        // EvaluateLoss 中一个 batch 的各 trial 损失
+    Span<float> folded;         // 有 trial 使用 BN 时分配, 与参数存储同布局
+
+private:
+    int64_t capacity_ = 0;
+    ArenaPool::Handle arena_;
+};
+
+// 同一结构、不同正则化配置的 K 个 MLP 一起训练
+// 所有 trial 共享同一个 minibatch, 第一层合并为一次 [batch, in] x [in, K * out] 的 GEMM,
+// 之后各层按列块做同形状的批量 GEMM; Linear 之后的 BN/LN/ReLU/dropout/skip 按 trial 的列块调用融合内核,
+// 评估时使用 BN 的 trial 把 BN 折叠进 Linear
+class StackedMlp {
+public:
+    StackedMlp(const ModelSpec& spec, const std::vector<RegConfig>& configs, const std::vector<uint64_t>& seeds);
+
+    int64_t Trials() const { return static_cast<int64_t>(configs_.size()); }
+    const ModelSpec& Spec() const { return spec_; }
+    const std::vector<RegConfig>& Configs() const { return configs_; }
+    const std::vector<LayerShape>& Layers() const { return layers_; }
+    const std::vector<StackedSlot>& Slots() const { return slots_; }
+    Buffer<float>& Parameters() { return params_; }
+    const Buffer<float>& Parameters() const { return params_; }
+    Buffer<float>& Gradients() { return grads_; }
+    Buffer<float>& Buffers() { return buffers_; }
+    const Buffer<float>& Buffers() const { return buffers_; }
+    int64_t MaxWidth() const { return max_width_; }
+    bool IsRegression() const { return spec_.out_features == 1; }
+    bool AnyBatchNorm() const { return any_bn_; }
+    bool AnyLayerNorm() const { return any_ln_; }
+    bool AnyDropout() const { return any_dropout_; }
+    bool AnySkip(size_t layer) const;
+
+    // update_stats 为假时不更新 BN 滑动统计量
+    void Forward(const float* x, int64_t batch, bool training, StackedWorkspace& ws, std::mt19937& rng,
+                 bool update_stats = true);
+    void Backward(const float* x, int64_t batch, StackedWorkspace& ws);
+    // 每个 trial 的损失总和写入 losses[k], gradient 为真时写入 ws.dlogits
+    void Loss(const float* y, int64_t batch, StackedWorkspace& ws, bool gradient, double* losses) const;
+
+    // 一次训练步, losses[k] 为 trial k 的 batch 平均损失
+    void TrainStep(const float* x, const float* y, int64_t batch, StackedWorkspace& ws, std::mt19937& rng,
+                   double* losses);
+    // 评估模式, 损失总和累加到 losses[k]
+    void EvaluateLoss(const float* x, const float* y, int64_t batch, StackedWorkspace& ws, double* losses);
+
+    // 在 x 上做一次训练模式前向, 用这一批的统计量覆盖 trials[k] 为真的 trial 的 BN 滑动统计量
+    void RecomputeBatchNorm(const float* x, int64_t batch, StackedWorkspace& ws, const std::vector<bool>& trials);
+
+    // 取出单个 trial 的独立模型
+    Mlp Extract(int64_t trial) const;
+    // Extract 的逆操作: 把结构相同的独立模型写入 trial 的列块
+    void Insert(int64_t trial, const Mlp& model);
+
+private:
+    int64_t AddSlot(const std::string& name, int64_t rows, int64_t width, bool decay);
+    const float* LayerOutput(size_t l, const StackedWorkspace& ws) const;
+
+    ModelSpec spec_;
+    std::vector<RegConfig> configs_;
+    std::vector<uint64_t> seeds_;
+    std::vector<LayerShape> layers_;        // 偏移指向堆叠存储, skip 不使用
+    std::vector<std::vector<bool>> skip_;   // [layer][trial]
+    std::vector<StackedSlot> slots_;
+    Buffer<float> params_{MemoryCategory::WEIGHTS};
+    Buffer<float> grads_{MemoryCategory::WEIGHTS};
+    Buffer<float> buffers_{MemoryCategory::WEIGHTS};
+    int64_t max_width_ = 0;
+    bool any_bn_ = false;
+    bool any_ln_ = false;
+    bool any_dropout_ = false;
+};
+
+} // namespace regdb
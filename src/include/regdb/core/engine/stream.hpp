@@ -0,0 +1,134 @@
+#pragma once
+
+#include "regdb/core/engine/augment.hpp"
+#include "regdb/core/engine/dataset.hpp"
+#include "regdb/core/engine/deadline.hpp"
+#include "regdb/core/engine/memory.hpp"
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/trainer.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace regdb {
+
+// 按行位置区间顺序读取训练数据的数据源, 读取时转换为 float32; 实现需保证 Read 线程安全.
+// Rows() 为行位置空间的大小, 有删除的表中某些区间实际读到的行数可能少于 count
+class BlockSource {
+public:
+    virtual ~BlockSource() = default;
+    virtual int64_t Rows() const = 0;
+    virtual int64_t Cols() const = 0;
+    // 读取位置 [begin, begin + count) 的行, 返回实际行数
+    virtual int64_t Read(int64_t begin, int64_t count, float* x, float* y) = 0;
+};
+
+// 内存中的 Dataset 作为数据源
+class DatasetSource : public BlockSource {
+public:
+    explicit DatasetSource(const Dataset& data) : data_(data) {}
+
+    int64_t Rows() const override { return data_.rows; }
+    int64_t Cols() const override { return data_.cols; }
+    int64_t Read(int64_t begin, int64_t count, float* x, float* y) override;
+
+private:
+    const Dataset& data_;
+};
+
+struct StreamOptions {
+    int64_t block_rows = 65536;     // 一次顺序读取的行数
+    int64_t window_blocks = 4;      // 同时驻留内存并在其中打乱行顺序的块数
+};
+
+// 按块划分训练/验证集, 只保存块号
+struct BlockSplit {
+    int64_t block_rows = 0;
+    std::vector<int64_t> train;
+    std::vector<int64_t> validation;
+};
+
+BlockSplit SplitBlocks(int64_t rows, int64_t block_rows, double validation_fraction, uint64_t seed);
+
+// 两级块打乱的 minibatch 流: 每轮先打乱块顺序, 再把连续 window_blocks 个块读入内存并打乱其中的行,
+// I/O 始终是整块顺序读. 两个窗口缓冲区轮换, 预取线程读取并转换下一个窗口时, 训练在当前窗口上进行;
+// 没有预取线程时在 Next 中同步读取
+class MinibatchStream {
+public:
+    // augmenter 非空时在读入窗口后就地增强, 增强和读取一样在预取线程上完成
+    MinibatchStream(BlockSource& source, const std::vector<int64_t>& blocks, int64_t block_rows,
+                    const StreamOptions& options, bool shuffle, uint64_t seed,
+                    const Augmenter* augmenter = nullptr);
+
+    // 开始新的一轮遍历, 只能在上一轮读完或尚未开始时调用
+    void Reset();
+    // 取下一个 minibatch 写入 x/y, 返回行数, 本轮结束时返回 0
+    int64_t Next(int64_t batch, float* x, float* y);
+
+    // 在借来的线程上运行预取循环, 直到 Close
+    void RunPrefetcher();
+    void Close();
+
+private:
+    struct Window {
+        Buffer<float> x{MemoryCategory::DATASET};
+        Buffer<float> y{MemoryCategory::DATASET};
+        int64_t index = -1;         // 本轮中的窗口序号, -1 表示空闲
+        int64_t rows = 0;
+    };
+
+    int64_t WindowCount() const;
+    void Load(Window& window, int64_t epoch, int64_t index);
+    // 等待 (或同步读取) 序号为 index 的窗口
+    Window& Acquire(int64_t index);
+
+    BlockSource& source_;
+    std::vector<int64_t> blocks_;
+    int64_t block_rows_;
+    StreamOptions options_;
+    bool shuffle_;
+    uint64_t seed_;
+    std::mt19937 rng_;
+    const Augmenter* augmenter_;
+
+    std::mutex lock_;
+    std::condition_variable changed_;
+    Window windows_[2];
+    int64_t epoch_ = -1;
+    int64_t next_load_ = 0;         // 预取线程下一个要读的窗口序号
+    bool prefetching_ = false;
+    bool closed_ = false;
+    std::exception_ptr error_;      // 预取线程读取失败时由训练线程重新抛出
+
+    // 消费端状态, 只由训练线程访问
+    Window* current_ = nullptr;
+    int64_t current_index_ = -1;
+    int64_t cursor_ = 0;
+    std::vector<int64_t> permutation_;
+};
+
+// 流式训练: 数据不整体载入内存, 训练集按两级块打乱流式读取, 验证集按块顺序读取
+class StreamTrainer {
+public:
+    StreamTrainer(BlockSource& source, const BlockSplit& split, const TrainOptions& options,
+                  const StreamOptions& stream)
+        : source_(source), split_(split), options_(options), stream_(stream) {}
+
+    TrainResult Train(Mlp& model, StopToken& token) const;
+    // 顺序读完验证流, 返回平均损失
+    double Validate(Mlp& model, MlpWorkspace& ws, MinibatchStream& validation) const;
+
+private:
+    TrainResult TrainLoop(Mlp& model, StopToken& token, MinibatchStream& train, MinibatchStream& validation) const;
+
+    BlockSource& source_;
+    const BlockSplit& split_;
+    TrainOptions options_;
+    StreamOptions stream_;
+};
+
+} // namespace regdb
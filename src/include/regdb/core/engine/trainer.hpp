@@ -0,0 +1,75 @@
+#pragma once
+
+#include "regdb/core/engine/augment.hpp"
+#include "regdb/core/engine/checkpoint.hpp"
+#include "regdb/core/engine/dataset.hpp"
+#include "regdb/core/engine/deadline.hpp"
+#include "regdb/core/engine/early_stop.hpp"
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/optimizer.hpp"
+#include "regdb/core/engine/parallel.hpp"
+#include "regdb/core/engine/stacked_mlp.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace regdb {
+
+struct TrainOptions {
+    int64_t max_epochs = 20;
+    int64_t batch_size = 128;
+    int64_t eval_batch_size = 1024;
+    float learning_rate = 1e-3f;
+    int64_t preempt_interval = 1;   // 每 N 个 minibatch 检查一次抢占点
+    uint64_t seed = 42;
+    int64_t threads = 1;            // 单个 trial 内数据并行的线程数, 1 表示不切分 minibatch, 实际线程从 ThreadPool 借用
+    bool hogwild = false;           // 多线程时使用异步 Hogwild 更新代替同步归约, 也可由 model_args.hogwild 开启
+    EarlyStopSpec early_stop;       // 默认关闭, 搜索时取自 model_args.early_stopping
+    Incumbent* incumbent = nullptr; // 搜索中共享的当前最优, 学习曲线外推与之比较
+    Checkpointer* checkpointer = nullptr;   // 非空时在 epoch 边界按间隔异步保存检查点, 被抢占时保存一次
+    const Checkpoint* resume = nullptr;     // 非空时从检查点的下一个 epoch 继续; 堆叠训练不支持
+};
+
+// 训练结果, 被抢占时保留已完成部分的学习曲线
+struct TrainResult {
+    std::vector<double> train_curve;    // 每个完整 epoch 的平均训练损失, 与 val_curve 等长
+    std::vector<double> val_curve;      // 每个完整 epoch 结束时的验证损失
+    double partial_train_loss = 0.0;    // 被抢占时未完成的 epoch 已训练部分的平均训练损失, 不计入 train_curve
+    int64_t partial_rows = 0;           // 未完成的 epoch 已训练的行数, 0 表示在 epoch 边界停止
+    double best_val_loss = std::numeric_limits<double>::infinity();
+    int64_t best_epoch = -1;
+    int64_t steps = 0;
+    bool preempted = false;
+    bool stopped_early = false;         // 验证损失停滞或外推不能超过当前最优, 在 max_epochs 之前结束
+};
+
+class Trainer {
+public:
+    Trainer(const Dataset& data, const DataSplit& split, const TrainOptions& options)
+        : data_(data), split_(split), options_(options) {}
+
+    TrainResult Train(Mlp& model, StopToken& token) const;
+    // 堆叠训练 K 个 trial, 共享 minibatch 顺序, 返回每个 trial 的结果
+    std::vector<TrainResult> TrainStacked(StackedMlp& model, StopToken& token) const;
+    // 验证集平均损失
+    double Validate(Mlp& model, MlpWorkspace& ws) const;
+    // SWA 已有平均时换入平均权重验证, BN 统计量在训练集开头的一批行上重新计算
+    double Validate(Mlp& model, MlpWorkspace& ws, WeightAveraging& averaging) const;
+    void ValidateStacked(StackedMlp& model, StackedWorkspace& ws, double* losses) const;
+
+private:
+    // 单线程训练, prefetcher 非空时从中取已增强的 minibatch, 否则在训练线程上 gather
+    TrainResult TrainLoop(Mlp& model, StopToken& token, std::vector<int64_t>& order,
+                          BatchPrefetcher* prefetcher) const;
+    // 数据并行: 每个线程计算 minibatch 一个分片的梯度, 树形归约后各自更新一段参数
+    TrainResult TrainDataParallel(Mlp& model, StopToken& token, ThreadPool::Lease& lease) const;
+    // Hogwild: 每个线程独立取 minibatch, 不加锁地直接更新共享参数, 只在 epoch 边界同步
+    TrainResult TrainHogwild(Mlp& model, StopToken& token, ThreadPool::Lease& lease) const;
+
+    const Dataset& data_;
+    const DataSplit& split_;
+    TrainOptions options_;
+};
+
+} // namespace regdb
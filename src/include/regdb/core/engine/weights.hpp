@@ -0,0 +1,55 @@
+#pragma once
+
+#include "regdb/core/engine/mlp.hpp"
+#include "regdb/core/engine/quantize.hpp"
+#include "regdb/core/engine/spec.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+// 权重中的一个张量, kind 为 param/buffer/adam_m/adam_v, 持久化时每个张量一行
+struct WeightTensor {
+    std::string name;
+    std::string kind;
+    const float* data;
+    int64_t size;
+};
+
+// 训练好的模型权重, 对应 REGDB_MODEL_WEIGHTS_TABLE 的一行; 按 (model_name, key) 区分, 分组训练时 key 为分组值
+struct ModelWeights {
+    std::string model_name;
+    std::string key;
+    ModelSpec spec;
+    RegConfig config;
+    int64_t rows = 0;                   // 参与训练的行数
+    double train_loss = 0.0;
+    std::vector<float> params;          // 与 Mlp::Parameters() 同布局
+    std::vector<float> buffers;         // BN 滑动统计量, 与 Mlp::Buffers() 同布局
+    std::vector<float> adam_m;          // Adam 一阶/二阶矩, 与 params 同布局; 为空表示没有保存优化器状态
+    std::vector<float> adam_v;
+    int64_t adam_steps = 0;
+    int64_t last_rowid = -1;            // PARTIAL FIT 已经训练到的源表 rowid, -1 表示还没有
+    nlohmann::json preprocess;          // 拟合好的预处理状态, null 表示不预处理
+    std::vector<TensorSlot> slots;      // params 的切分, 由 FromModel 或 Allocate 填入
+    std::vector<QuantizedTensor> quantized;     // 量化推理用的权重, 为空表示以 fp32 推理; 参数变化后失效
+    std::vector<QuantizedTensor> sparse;        // 剪枝后块稀疏推理用的权重, 格式见 SparseMlp; 同样在参数变化后失效
+
+    static ModelWeights FromModel(const std::string& model_name, const std::string& key, const Mlp& model,
+                                  int64_t rows, double train_loss);
+    // 按 spec/config 的结构分配 params/buffers, with_optimizer 时同时分配 Adam 矩, 之后用 LoadTensor 填入
+    void Allocate(bool with_optimizer);
+    // 按 Slots 切分参数和 Adam 矩, BN 统计量整体为一个张量
+    std::vector<WeightTensor> Tensors() const;
+    // 把一个张量的内容复制到对应位置, 名字或大小不匹配时报错
+    void LoadTensor(const std::string& name, const std::string& kind, const float* data, int64_t size);
+    // 把参数和 BN 统计量写回结构相同的模型, 大小不一致时报错
+    void Restore(Mlp& model) const;
+    // 不含参数本身的摘要
+    nlohmann::json Summary() const;
+};
+
+} // namespace regdb
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/core/engine/memory.hpp"
+
+namespace regdb {
+
+// 把引擎内存 (训练数据、权重、工作区 arena、缓存) 交给 DuckDB 的 BufferManager 管理,
+// 使其计入 memory_limit, 空闲的 arena 在内存压力下可以换出到临时文件.
+// 实例关闭时清空数据集缓存和 arena 池, 仍存活的块搬到进程堆, 后端恢复为进程堆
+class BufferManagerMemory {
+public:
+	static void Install(duckdb::DatabaseInstance& db);											// 将引擎内存后端切换到 db 的 BufferManager
+
+}; // class BufferManagerMemory
+
+} // namespace regdb
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "regdb/core/engine/dataset.hpp"
+#include "regdb/core/engine/deadline.hpp"
+#include "regdb/core/engine/spec.hpp"
+#include "regdb/core/engine/stream.hpp"
+#include "regdb/core/engine/trainer.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace regdb {
+
+struct SearchOptions {
+    TrainOptions train;
+    double validation_fraction = 0.2;
+    int64_t folds = 1;                  // 大于 1 时用 k 折交叉验证代替留出验证集, 只支持内存中的数据
+    int64_t max_threads = 0;            // 0 表示使用 ThreadPool 的全部线程
+    int64_t stack_size = 1;             // 每个 worker 一次堆叠训练的 trial 数, 1 表示逐个训练
+    StreamOptions stream;               // 流式数据源的块大小和打乱窗口
+    std::string checkpoint_dir;         // 非空时每个 trial 在其下的子目录保存检查点和完成后的结果
+    int64_t checkpoint_interval_ms = 60000;
+    bool resume = false;                // 复用 checkpoint_dir 中已完成的 trial, 未完成的从检查点继续; 否则先清空目录
+};
+
+struct TrialResult {
+    int64_t trial_id = 0;
+    RegConfig config;
+    TrainResult train;                  // k 折时为各折的汇总: 曲线按 epoch 取平均, 最优 epoch 在平均曲线上选取
+    std::vector<double> fold_losses;    // k 折时每一折在汇总最优 epoch 的验证损失
+};
+
+struct SearchResult {
+    std::vector<TrialResult> trials;    // 按完成顺序
+    int64_t best = -1;                  // trials 中最优 trial 的下标, 没有任何完整 epoch 时为 -1
+    int64_t trials_total = 0;
+    StopReason stop_reason = StopReason::NONE;
+    int64_t elapsed_ms = 0;
+
+    nlohmann::json ToJson() const;
+};
+
+// 在正则化空间上搜索, 到达截止时间或被中断时返回当前最优结果
+class RegSearch {
+public:
+    RegSearch(const ModelSpec& spec, const RegSpace& space, const Dataset& data, const SearchOptions& options)
+        : spec_(spec), space_(space), data_(&data), options_(options) {}
+    // 数据不能整体载入内存时从数据源流式读取, 每个 trial 独立读取, 不堆叠
+    RegSearch(const ModelSpec& spec, const RegSpace& space, BlockSource& source, const SearchOptions& options)
+        : spec_(spec), space_(space), source_(&source), options_(options) {}
+
+    SearchResult Run(StopToken& token) const;
+
+    // 窄模型的逐层开销占比高, 堆叠更多 trial; 同时保证每个线程至少分到一组
+    static int64_t AutoStackSize(const ModelSpec& spec, int64_t trials, int64_t threads);
+
+private:
+    const ModelSpec& spec_;
+    const RegSpace& space_;
+    const Dataset* data_ = nullptr;
+    BlockSource* source_ = nullptr;
+    SearchOptions options_;
+};
+
+} // namespace regdb
@@ -45,6 +45,15 @@ public:
     nlohmann::json new_model_args;
 };
 
+// 增量训练语句, 只在新增的行上继续训练已保存的权重
+class PartialFitModelStatement : public QueryStatement {
+public:
+    PartialFitModelStatement() { type = StatementType::PARTIAL_FIT_MODEL; }
+    std::string model_name;
+    std::string table_name;
+    std::string since;      // 新增行的过滤条件, 为空时使用上次 PARTIAL FIT 记录的 rowid
+};
+
 class GetModelStatement : public QueryStatement {
 public:
     GetModelStatement() { type = StatementType::GET_MODEL; }
@@ -66,6 +75,7 @@ private:
     void ParseCreateModel(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
     void ParseDeleteModel(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
     void ParseUpdateModel(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
+    void ParsePartialFit(Tokenizer& tokenizer, const std::string& model_name, std::unique_ptr<QueryStatement>& statement);
     void ParseGetModel(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
 };
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/custom_parser/query_statements.hpp"
+#include "regdb/custom_parser/tokenizer.hpp"
+
+#include "fmt/format.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace regdb {
+
+// PREDICT USING MODEL 'model' | ENSEMBLE 'model', ... FROM <表名或查询> [INTO 表名]
+class PredictStatement : public QueryStatement {
+public:
+    PredictStatement() { type = StatementType::PREDICT; };
+    bool ensemble = false;
+    std::vector<std::string> model_names;
+    std::string source;         // 表名或 SELECT 查询的原始文本
+    bool table = false;         // source 是单个表名
+    std::vector<std::string> into;  // INTO 的表名, 按 '.' 拆开; 为空时直接返回结果
+};
+
+class PredictParser {
+public:
+    void Parse(const std::string& query, std::unique_ptr<QueryStatement>& query_statement);
+    std::string ToSQL(const QueryStatement& statement) const;
+};
+
+} // namespace regdb
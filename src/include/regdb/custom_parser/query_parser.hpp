@@ -2,6 +2,7 @@
 
 #include "regdb/core/common.hpp"
 #include "regdb/custom_parser/query/model_parser.hpp"
+#include "regdb/custom_parser/query/predict_parser.hpp"
 #include "regdb/custom_parser/query/regspace_parser.hpp"
 #include "regdb/custom_parser/query_statements.hpp"
 #include "regdb/custom_parser/tokenizer.hpp"
@@ -14,6 +14,7 @@ enum class StatementType {
     DELETE_MODEL,
     UPDATE_MODEL,
     UPDATE_MODEL_SCOPE,
+    PARTIAL_FIT_MODEL,
     GET_MODEL,
     GET_ALL_MODEL,
     CREATE_REGSPACE,
@@ -22,6 +23,7 @@ enum class StatementType {
     UPDATE_REGSPACE_SCOPE,
     GET_REGSPACE,
     GET_ALL_REGSPACE,
+    PREDICT,
 };
 
 // 语句抽象基类
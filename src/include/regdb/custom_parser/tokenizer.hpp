@@ -28,6 +28,7 @@ public:
     Tokenizer(const std::string &query);
     Token NextToken();
     std::string GetQuery();
+    std::string Remaining();
 
 private:
     std::string query_;
@@ -46,4 +47,7 @@ private:
 // 工具函数：转化 token 类型到字符串
 std::string TokenTypeToString(TokenType type);
 
+// 工具函数：单引号加倍, 解析出的名字放回翻译后 SQL 的字符串字面量时使用
+std::string EscapeQuotes(const std::string& text);
+
 } // namespace regdb
\ No newline at end of file
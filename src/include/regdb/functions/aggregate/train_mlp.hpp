@@ -0,0 +1,74 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/core/engine/incremental.hpp"
+#include "regdb/core/engine/spec.hpp"
+#include "regdb/core/engine/trainer.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/main/client_context_state.hpp"
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace regdb {
+
+// 一个连接上 train_mlp 训练出、尚未写入的权重. Finalize 只在这里暂存, 所在事务提交时在一个事务中写入权重表,
+// 回滚时丢弃; 一次查询 (或一个显式事务) 训练的全部分组要么都写入, 要么都不写入
+class PendingWeights : public duckdb::ClientContextState {
+public:
+    static constexpr const char* NAME = "regdb_pending_weights";
+
+    // 同一事务中先后几次查询训练同一 (model, key) 时只保留最后一次的结果; 同一次查询中两个分组得到同一 (model, key)
+    // 时报错, 否则只有一个分组的模型被保存
+    void Add(ModelWeights weights);
+    void QueryBegin(duckdb::ClientContext& context) override;
+    void TransactionCommit(duckdb::MetaTransaction& transaction, duckdb::ClientContext& context) override;
+    void TransactionRollback(duckdb::MetaTransaction& transaction, duckdb::ClientContext& context) override;
+
+private:
+    std::mutex lock_;
+    std::vector<ModelWeights> weights_;
+    std::vector<std::pair<std::string, std::string>> query_keys_;     // 当前查询已经暂存的 (model, key)
+};
+
+// train_mlp(model, features, label [, key]): 聚合函数, 每个分组训练一个模型, 权重在查询所在事务提交时写入权重表.
+// 省略 key 时 key 为空, 只能有一个分组; GROUP BY 时把分组列作为 key 传入.
+// 每个线程的局部状态在自己读到的行上增量训练, Combine 按训练行数加权平均参数, 返回权重摘要 (JSON)
+class TrainMlp {
+public:
+    TrainMlp() = delete;
+
+    struct BindData : public duckdb::FunctionData {
+        std::string model;
+        ModelSpec spec;
+        RegConfig config;
+        TrainOptions options;
+        duckdb::shared_ptr<PendingWeights> pending;
+
+        duckdb::unique_ptr<duckdb::FunctionData> Copy() const override;
+        bool Equals(const duckdb::FunctionData& other) const override;
+    };
+
+    // DuckDB 管理的状态内存只存指针, 训练状态在堆上, 由 Destroy 释放
+    struct State {
+        IncrementalTrainer* trainer;
+        std::string* key;
+    };
+
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(duckdb::ClientContext& context,
+                                                         duckdb::AggregateFunction& function,
+                                                         duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
+    static duckdb::idx_t StateSize(const duckdb::AggregateFunction& function);
+    static void Initialize(const duckdb::AggregateFunction& function, duckdb::data_ptr_t state);
+    static void Update(duckdb::Vector inputs[], duckdb::AggregateInputData& aggr_input_data, duckdb::idx_t input_count,
+                       duckdb::Vector& state_vector, duckdb::idx_t count);
+    static void Combine(duckdb::Vector& source, duckdb::Vector& target, duckdb::AggregateInputData& aggr_input_data,
+                        duckdb::idx_t count);
+    static void Finalize(duckdb::Vector& state_vector, duckdb::AggregateInputData& aggr_input_data,
+                         duckdb::Vector& result, duckdb::idx_t count, duckdb::idx_t offset);
+    static void Destroy(duckdb::Vector& state_vector, duckdb::AggregateInputData& aggr_input_data, duckdb::idx_t count);
+};
+
+} // namespace regdb
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "regdb/functions/scalar/scalar.hpp"
+
+namespace regdb {
+
+// UPDATE MODEL ... PARTIAL FIT ON ... 的执行入口: 载入已保存的权重和 Adam 状态, 只在新增的行上训练几个 epoch
+class PartialFitModel : public ScalarFunctionBase {
+public:
+    static constexpr int64_t EPOCHS = 3;
+
+    static void ValidateArguments(duckdb::DataChunk& args);
+    static std::vector<std::string> Operation(duckdb::DataChunk& args, duckdb::ClientContext& context);
+    static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
+};
+
+} // namespace regdb
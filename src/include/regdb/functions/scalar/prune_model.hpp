@@ -0,0 +1,19 @@
+#pragma once
+
+#include "regdb/functions/scalar/scalar.hpp"
+
+namespace regdb {
+
+// 搜索之后的可选剪枝: magnitude 把隐藏层权重中范数小的块置零并写入块稀疏张量, PREDICT 以稀疏内核推理;
+// neuron 去掉不重要的神经元, 写回 hidden_features 变小的稠密权重. 同时在训练表的样本上比较剪枝前后的损失和速度
+class PruneModel : public ScalarFunctionBase {
+public:
+    // 用于对比的样本行数
+    static constexpr int64_t SAMPLE_ROWS = 4096;
+
+    static void ValidateArguments(duckdb::DataChunk& args);
+    static std::vector<std::string> Operation(duckdb::DataChunk& args, duckdb::ClientContext& context);
+    static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
+};
+
+} // namespace regdb
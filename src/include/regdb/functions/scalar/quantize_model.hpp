@@ -0,0 +1,19 @@
+#pragma once
+
+#include "regdb/functions/scalar/scalar.hpp"
+
+namespace regdb {
+
+// 训练后量化: 在训练表的一个样本上校准, 把量化张量写入张量表, 之后 PREDICT 用量化权重推理;
+// 同时在另一半样本上比较 fp32 与量化推理的损失和速度, 用于逐个模型决定是否保留量化
+class QuantizeModel : public ScalarFunctionBase {
+public:
+    // 样本行数, 一半用于校准, 一半用于对比
+    static constexpr int64_t SAMPLE_ROWS = 8192;
+
+    static void ValidateArguments(duckdb::DataChunk& args);
+    static std::vector<std::string> Operation(duckdb::DataChunk& args, duckdb::ClientContext& context);
+    static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
+};
+
+} // namespace regdb
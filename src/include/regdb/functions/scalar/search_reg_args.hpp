@@ -7,7 +7,7 @@ namespace regdb {
 class SearchRegArgs : public ScalarFunctionBase {
 public:
     static void ValidateArguments(duckdb::DataChunk& args);
-    static std::vector<std::string> Operation(duckdb::DataChunk& args);
+    static std::vector<std::string> Operation(duckdb::DataChunk& args, duckdb::ClientContext& context);
     static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
 };
 
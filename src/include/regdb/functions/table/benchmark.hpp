@@ -0,0 +1,35 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/core/engine/benchmark.hpp"
+#include "duckdb/function/table_function.hpp"
+
+namespace regdb {
+
+// regdb_benchmark(name [, model]): 运行训练引擎基准测试, 每行一个测量值
+class RegdbBenchmark {
+public:
+    RegdbBenchmark() = delete;
+
+    struct BindData : public duckdb::TableFunctionData {
+        std::string name;
+        std::string model;
+    };
+
+    struct State : public duckdb::GlobalTableFunctionState {
+        std::vector<BenchmarkRow> rows;
+        duckdb::idx_t offset = 0;
+    };
+
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(duckdb::ClientContext& context,
+                                                         duckdb::TableFunctionBindInput& input,
+                                                         duckdb::vector<duckdb::LogicalType>& return_types,
+                                                         duckdb::vector<std::string>& names);
+    static duckdb::unique_ptr<duckdb::GlobalTableFunctionState> Init(duckdb::ClientContext& context,
+                                                                     duckdb::TableFunctionInitInput& input);
+    static std::vector<BenchmarkRow> Operation(const std::string& name, const std::string& model, int64_t threads);
+    static void Execute(duckdb::ClientContext& context, duckdb::TableFunctionInput& input,
+                        duckdb::DataChunk& output);
+};
+
+} // namespace regdb
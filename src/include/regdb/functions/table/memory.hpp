@@ -0,0 +1,37 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/core/engine/memory.hpp"
+#include "duckdb/function/table_function.hpp"
+
+namespace regdb {
+
+// regdb_memory(): 按分类报告引擎内存, 以及 DuckDB BufferManager 的总用量和上限
+class RegdbMemory {
+public:
+    RegdbMemory() = delete;
+
+    struct Row {
+        std::string category;
+        int64_t bytes = 0;
+        int64_t peak_bytes = 0;
+        int64_t blocks = 0;
+    };
+
+    struct State : public duckdb::GlobalTableFunctionState {
+        std::vector<Row> rows;
+        duckdb::idx_t offset = 0;
+    };
+
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(duckdb::ClientContext& context,
+                                                         duckdb::TableFunctionBindInput& input,
+                                                         duckdb::vector<duckdb::LogicalType>& return_types,
+                                                         duckdb::vector<std::string>& names);
+    static duckdb::unique_ptr<duckdb::GlobalTableFunctionState> Init(duckdb::ClientContext& context,
+                                                                     duckdb::TableFunctionInitInput& input);
+    static std::vector<Row> Operation(duckdb::ClientContext& context);
+    static void Execute(duckdb::ClientContext& context, duckdb::TableFunctionInput& input,
+                        duckdb::DataChunk& output);
+};
+
+} // namespace regdb
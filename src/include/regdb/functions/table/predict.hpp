@@ -0,0 +1,55 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+#include "regdb/core/engine/predictor.hpp"
+#include "regdb/core/engine/preprocess.hpp"
+#include "duckdb/function/table_function.hpp"
+
+namespace regdb {
+
+// regdb_predict((query), model) / regdb_predict((query), [model, ...]): 对输入的每一行打分, 输出输入列加 prediction 列.
+// 给出模型列表时为集成, 所有成员在同一次扫描中打分.
+// 作为表 in-out 函数规划在输入管道中, 每个管道线程各自积攒 Predictor::BATCH_ROWS 行再做一次前向.
+// 模型在绑定时读取一次, 所有线程共享; 工作区和缓冲区属于线程局部状态
+class RegdbPredict {
+public:
+    RegdbPredict() = delete;
+
+    struct BindData : public duckdb::TableFunctionData {
+        std::string model;                                  // 错误信息中的模型名, 集成时为逗号分隔的列表
+        std::shared_ptr<const Predictor> predictor;
+        std::shared_ptr<const Preprocessor> preprocessor;  // 为空时取输入的前 in_features 列作为特征
+        std::vector<duckdb::idx_t> features;                // 每个特征 (或预处理列) 对应的输入列
+    };
+
+    struct LocalState : public duckdb::LocalTableFunctionState {
+        PredictWorkspace ws;
+        std::vector<float> x;
+        std::vector<float> predictions;
+        std::vector<duckdb::unique_ptr<duckdb::DataChunk>> chunks;  // 已转换特征、等待打分的输入
+        int64_t rows = 0;
+        duckdb::idx_t emitted = 0;                          // 打分后已输出的 chunk 数
+        bool scored = false;
+    };
+
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(duckdb::ClientContext& context,
+                                                         duckdb::TableFunctionBindInput& input,
+                                                         duckdb::vector<duckdb::LogicalType>& return_types,
+                                                         duckdb::vector<std::string>& names);
+    static duckdb::unique_ptr<duckdb::LocalTableFunctionState> InitLocal(duckdb::ExecutionContext& context,
+                                                                         duckdb::TableFunctionInitInput& input,
+                                                                         duckdb::GlobalTableFunctionState* global);
+    static duckdb::OperatorResultType Execute(duckdb::ExecutionContext& context, duckdb::TableFunctionInput& data,
+                                              duckdb::DataChunk& input, duckdb::DataChunk& output);
+    static duckdb::OperatorFinalizeResultType Finalize(duckdb::ExecutionContext& context,
+                                                       duckdb::TableFunctionInput& data, duckdb::DataChunk& output);
+
+private:
+    // 复制输入 chunk 并把特征写入 x 的末尾
+    static void Absorb(duckdb::ClientContext& context, const BindData& bind, LocalState& state,
+                       duckdb::DataChunk& input);
+    // 输出一个已打分的 chunk, 全部输出后清空缓冲区, 返回是否还有剩余
+    static bool Emit(const BindData& bind, LocalState& state, duckdb::DataChunk& output);
+};
+
+} // namespace regdb
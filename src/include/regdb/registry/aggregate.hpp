@@ -0,0 +1,16 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+
+namespace regdb {
+
+// 聚合函数统一注册入口
+class AggregateRegistry {
+public:
+    static void Register(duckdb::ExtensionLoader& loader);
+
+private:
+    static void RegisterTrainMlp(duckdb::ExtensionLoader& loader);
+};
+
+} // namesapce regdb
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "regdb/core/common.hpp"
+#include "regdb/registry/aggregate.hpp"
 #include "regdb/registry/scalar.hpp"
+#include "regdb/registry/table.hpp"
 
 namespace regdb {
 
@@ -11,7 +13,9 @@ public:
     static void Register(duckdb::ExtensionLoader& loader);
 
 private:
+    static void RegisterAggregateFunctions(duckdb::ExtensionLoader& loader);
     static void RegisterScalarFunctions(duckdb::ExtensionLoader& loader);
+    static void RegisterTableFunctions(duckdb::ExtensionLoader& loader);
 };
 
 } // namesapce regdb
@@ -13,6 +13,9 @@ public:
 private:
     static void RegisterQuack(duckdb::ExtensionLoader& loader);
     static void RegisterSearchRegArgs(duckdb::ExtensionLoader& loader);
+    static void RegisterPartialFitModel(duckdb::ExtensionLoader& loader);
+    static void RegisterQuantizeModel(duckdb::ExtensionLoader& loader);
+    static void RegisterPruneModel(duckdb::ExtensionLoader& loader);
 };
 
 } // namesapce regdb
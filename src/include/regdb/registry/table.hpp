@@ -0,0 +1,18 @@
+#pragma once
+
+#include "regdb/core/common.hpp"
+
+namespace regdb {
+
+// 表函数统一注册入口
+class TableRegistry {
+public:
+    static void Register(duckdb::ExtensionLoader& loader);
+
+private:
+    static void RegisterBenchmark(duckdb::ExtensionLoader& loader);
+    static void RegisterMemory(duckdb::ExtensionLoader& loader);
+    static void RegisterPredict(duckdb::ExtensionLoader& loader);
+};
+
+} // namesapce regdb
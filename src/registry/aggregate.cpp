@@ -0,0 +1,10 @@
+#include "regdb/registry/aggregate.hpp"
+
+namespace regdb {
+
+// Register 方法实现，注册所有的聚合函数
+void AggregateRegistry::Register(duckdb::ExtensionLoader& loader) {
+    RegisterTrainMlp(loader);
+}
+
+} // namespace regdb
@@ -3,11 +3,21 @@
 namespace regdb {
 
 void Registry::Register(duckdb::ExtensionLoader& loader) {
+    RegisterAggregateFunctions(loader);
     RegisterScalarFunctions(loader);
+    RegisterTableFunctions(loader);
+}
+
+void Registry::RegisterAggregateFunctions(duckdb::ExtensionLoader& loader) {
+    AggregateRegistry::Register(loader);
 }
 
 void Registry::RegisterScalarFunctions(duckdb::ExtensionLoader& loader) {
     ScalarRegistry::Register(loader);
 }
 
+void Registry::RegisterTableFunctions(duckdb::ExtensionLoader& loader) {
+    TableRegistry::Register(loader);
+}
+
 } // namespace regdb
\ No newline at end of file
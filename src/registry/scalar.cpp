@@ -6,6 +6,9 @@ namespace regdb {
 void ScalarRegistry::Register(duckdb::ExtensionLoader& loader) {
     RegisterQuack(loader);
     RegisterSearchRegArgs(loader);
+    RegisterPartialFitModel(loader);
+    RegisterQuantizeModel(loader);
+    RegisterPruneModel(loader);
 }
 
 } // namespace regdb
\ No newline at end of file
@@ -0,0 +1,12 @@
+#include "regdb/registry/table.hpp"
+
+namespace regdb {
+
+// Register 方法实现，注册所有的表函数
+void TableRegistry::Register(duckdb::ExtensionLoader& loader) {
+    RegisterBenchmark(loader);
+    RegisterMemory(loader);
+    RegisterPredict(loader);
+}
+
+} // namespace regdb